@@ -0,0 +1,977 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Corpus-driven end-to-end typing benchmark (host build).
+ *
+ *   corpus_bench [-i interval_ms] [-H hold_ms] [-j jitter_ms] [-s seed] [-r repeat]
+ *                [-g gap_ms] [-c|-C] [-m mode] corpus.txt...
+ *
+ * コーパス（UTF-8、かな主体）を各方式の辞書で逆引きしてキー列にし、打鍵間隔・押下時間・
+ * ばらつきを付けたトレースとしてエンジンに流す。出力モードごとに
+ *   - kana/s     : エンジンの CPU 時間あたりのかな数（と、トレース上の打鍵速度）
+ *   - HID/kana   : かな 1 文字あたりの HID レポート数（押下と離上で 2）
+ *   - latency    : ストロークの最初の押下 → 出力が確定するまで（p50 / p99）。
+ *                  推測送信は「最初に見えるまで」も出す
+ *   - mismatch   : 出てきたローマ字がコーパスと食い違ったストローク数
+ *   - wakeups    : かな 1 文字あたりに起きる回数（キーと出力キュー、chord_power.h）。
+ *                  -g で inter-key-gap-ms を付けると出力キューの分が出る。電池の profile は
+ *                  -DCONFIG_ZMK_CHORD_POWER_BATTERY=1 でビルドして比べる
+ *   - companion  : -c で出力を companion に送る（companion_loopback.c）。USB の
+ *                  フレーム数を HID レポート数の代わりに出す。-C は TEXT を取りこぼす
+ *                  companion（返事待ちが切れ、CANCEL で確かめて keycode に戻るのを見る）
+ * を出す。逆引きできない文字（漢字など）は飛ばし、coverage に出す。
+ *
+ * モード:
+ *   mejiro-commit : 離上で確定（behavior_mejiro.c の既定）
+ *   mejiro-spec   : 推測送信（CONFIG_ZMK_MEJIRO_SPECULATIVE 相当）
+ *   mejiro-split  : split キーボード。右手を peripheral の chord_seg（mejiro_half.c）で
+ *                   半分のストロークにまとめ、central で mejiro_merge する。split の
+ *                   メッセージ数を 1 キーずつ送る場合と比べる
+ *   naginata-shift: 薙刀式の親指先行シフト面（ng SPACE、naginata_shift.c）。連続シフトで打つ。
+ *                   同時押しの表（naginata_dict.c）は通さず、シフト面にある文字だけを
+ *                   逆引きする。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <zephyr/kernel.h>
+
+#include <chord/chord_companion.h>
+#include <chord/chord_power.h>
+#include <chord/chord_engine.h>
+#include <chord/chord_seg.h>
+#include <chord/kana_out.h>
+#include <dt-bindings/zmk/keys.h>
+#include <mejiro/mejiro_core.h>
+#include <mejiro/mejiro_key_ids.h>
+#include <mejiro/mejiro_send_roman.h>
+#include <mejiro/mejiro_spec.h>
+#include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_keys.h>
+#include <zmk_naginata/naginata_shift.h>
+
+#include "host_shim.h"
+
+#define ROMAN_MAX 24
+#define MATCH_MAX_CP 10 /* 1 ストロークで出せるかなの最大（MEJIRO_OUTPUT_MAX / 3） */
+
+enum mode {
+    MODE_MEJIRO_COMMIT,
+    MODE_MEJIRO_SPEC,
+    MODE_MEJIRO_SPLIT,
+    MODE_NAGINATA_SHIFT,
+    MODE_COUNT
+};
+
+static const char *const mode_names[MODE_COUNT] = {"mejiro-commit", "mejiro-spec",
+                                                   "mejiro-split", "naginata-shift"};
+
+/* mejiro-split で peripheral 側にある右手のキー */
+#define SPLIT_REMOTE_KEYS (MJ_ID_CODE_BIT(MJ_R_0) * 0x1ffu)
+
+static struct {
+    int interval_ms;
+    int hold_ms;
+    int jitter_ms;
+    int repeat;
+    int gap_ms;
+    int companion; /* 0: 無し、1: 返事をする、2: 取りこぼす */
+} opt = {.interval_ms = 140, .hold_ms = 110, .jitter_ms = 20, .repeat = 1};
+
+/* ---- utf-8 ------------------------------------------------------------- */
+
+static uint32_t rng_state = 0x4d454a49;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* -j..+j */
+static int jitter(int j) { return j ? (int)(rng() % (2 * (uint32_t)j + 1)) - j : 0; }
+
+static size_t utf8_len(uint8_t c) {
+    if (c < 0x80) return 1;
+    if ((c & 0xE0) == 0xC0) return 2;
+    if ((c & 0xF0) == 0xE0) return 3;
+    if ((c & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+/* ---- reverse dictionary: romaji -> recipe ------------------------------- */
+
+/*
+ * 出力を kana_roman_encode したローマ字で引く（カタカナ・ひらがなの差や 2 通りの
+ * 表記を気にせず、ホストに届く文字列が同じなら同じストロークとみなす）。
+ */
+struct recipe {
+    char roman[ROMAN_MAX];
+    uint32_t a; /* mejiro: stroke code / naginata: shift keycode */
+    uint32_t b; /* naginata: keycode */
+    uint8_t cost;
+    bool used;
+};
+
+/* open addressing。mejiro は全ストローク（約 32 万通りの出力）が入る大きさ */
+struct dict {
+    struct recipe *slots;
+    uint32_t mask;
+    size_t count;
+};
+
+static struct dict mejiro_dict, naginata_dict;
+
+static void dict_init(struct dict *d, unsigned bits) {
+    d->slots = calloc(1u << bits, sizeof(*d->slots));
+    d->mask = (1u << bits) - 1;
+    d->count = 0;
+}
+
+static uint32_t hash_str(const char *s) {
+    uint32_t h = 2166136261u;
+    for (; *s; s++) {
+        h = (h ^ (uint8_t)*s) * 16777619u;
+    }
+    return h;
+}
+
+static struct recipe *dict_slot(const struct dict *d, const char *roman) {
+    uint32_t i = hash_str(roman) & d->mask;
+    while (d->slots[i].used && strcmp(d->slots[i].roman, roman) != 0) {
+        i = (i + 1) & d->mask;
+    }
+    return &d->slots[i];
+}
+
+static void dict_put(struct dict *d, const char *roman, uint32_t a, uint32_t b, uint8_t cost) {
+    struct recipe *r = dict_slot(d, roman);
+    if (r->used && r->cost <= cost) {
+        return;
+    }
+    if (!r->used) {
+        if (d->count + 1 >= d->mask / 4 * 3) {
+            return; /* 満杯（引けないだけ） */
+        }
+        d->count++;
+    }
+    strcpy(r->roman, roman);
+    r->a = a;
+    r->b = b;
+    r->cost = cost;
+    r->used = true;
+}
+
+static const struct recipe *dict_get(const struct dict *d, const char *roman) {
+    const struct recipe *r = dict_slot(d, roman);
+    return r->used ? r : NULL;
+}
+
+static const struct dict *dict_of(int mode) {
+    return mode == MODE_NAGINATA_SHIFT ? &naginata_dict : &mejiro_dict;
+}
+
+/* 全ストロークを引いて、同じ出力ならキー数の少ないものを残す */
+static void build_mejiro_map(void) {
+    static const uint32_t mods[] = {0, MJ_MOD_BIT_X, MJ_MOD_BIT_H, MJ_MOD_BIT_H | MJ_MOD_BIT_X};
+    char out[MEJIRO_OUTPUT_MAX];
+    char roman[ROMAN_MAX];
+
+    dict_init(&mejiro_dict, 19);
+    for (size_t m = 0; m < ARRAY_SIZE(mods); m++) {
+        for (uint32_t l = 0; l < (1u << MEJIRO_KEYS_PER_HAND); l++) {
+            for (uint32_t r = 0; r < (1u << MEJIRO_KEYS_PER_HAND); r++) {
+                struct mejiro_state s = {.left_mask = l, .right_mask = r, .mod_mask = mods[m]};
+                if (!mejiro_lookup(&s, out, sizeof(out)) ||
+                    kana_roman_encode(out, roman, sizeof(roman)) == 0) {
+                    continue;
+                }
+                uint32_t code = mejiro_stroke_code(&s);
+                dict_put(&mejiro_dict, roman, code, 0, (uint8_t)__builtin_popcount(code));
+            }
+        }
+    }
+}
+
+/* keycode -> 打たれた ASCII（kana_out の逆）。文字でなければ 0 */
+static char keycode_to_ascii(uint32_t kc) {
+    static const struct {
+        uint32_t kc;
+        char c;
+    } syms[] = {
+        {N0, '0'},    {MINUS, '-'}, {SPACE, ' '}, {COMMA, ','}, {DOT, '.'},     {SLASH, '/'},
+        {LBKT, '['},  {RBKT, ']'},  {SQT, '\''},  {ENTER, '\n'}, {BSPC, '\b'},
+    };
+    uint32_t base = STRIP_MODS(kc);
+    bool shift = SELECT_MODS(kc) & MOD_LSFT;
+
+    if (base >= A && base <= Z) {
+        return (char)((shift ? 'A' : 'a') + (base - A));
+    }
+    if (base >= N1 && base <= N9 && !shift) {
+        return (char)('1' + (base - N1));
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(syms); i++) {
+        if (syms[i].kc == kc) {
+            return syms[i].c;
+        }
+    }
+    return 0;
+}
+
+/* ---- HID capture -------------------------------------------------------- */
+
+static struct {
+    char text[256];
+    size_t len;
+    bool other; /* 文字以外のキーが出た */
+} cap;
+
+static void capture_hook(uint32_t encoded, bool pressed, int64_t timestamp, void *user) {
+    ARG_UNUSED(timestamp);
+    ARG_UNUSED(user);
+    if (!pressed) {
+        return;
+    }
+    char c = keycode_to_ascii(encoded);
+    if (!c) {
+        cap.other = true;
+        return;
+    }
+    if (cap.len + 1 < sizeof(cap.text)) {
+        cap.text[cap.len++] = c;
+        cap.text[cap.len] = '\0';
+    }
+}
+
+/* companion の TEXT: HID と同じく、ローマ字にして突き合わせる */
+static void companion_hook(const char *utf8, size_t len, void *user) {
+    ARG_UNUSED(user);
+    char text[256], roman[256];
+
+    len = MIN(len, sizeof(text) - 1);
+    memcpy(text, utf8, len);
+    text[len] = '\0';
+    size_t n = kana_roman_encode(text, roman, sizeof(roman));
+    if (cap.len + n < sizeof(cap.text)) {
+        memcpy(&cap.text[cap.len], roman, n + 1);
+        cap.len += n;
+    }
+}
+
+static void capture_reset(void) {
+    cap.len = 0;
+    cap.text[0] = '\0';
+    cap.other = false;
+}
+
+static uint32_t ng_keycode[NG_KEY_COUNT];
+
+/* シフト面に無いキー: 何も出ないので記録されない */
+static void ng_probe_fallback(const uint32_t *keys, uint8_t count, int64_t ts) {
+    ARG_UNUSED(keys);
+    ARG_UNUSED(count);
+    ARG_UNUSED(ts);
+}
+
+/* シフト面は naginata_shift.c の中にあるので、実際に打って出たものを記録する */
+static void build_naginata_map(void) {
+    for (uint32_t u = 0x04; u <= 0x38; u++) {
+        uint32_t kc = ZMK_HID_USAGE(0x07, u);
+        uint8_t idx = naginata_key_index(kc);
+        if (idx != NG_K_NONE) {
+            ng_keycode[idx] = kc;
+        }
+    }
+
+    dict_init(&naginata_dict, 8);
+    naginata_shift_init(ng_probe_fallback);
+    host_hid_set_hook(capture_hook, NULL);
+    const uint8_t shift = NG_K_SPACE; /* 先行シフトは ng SPACE だけ（B_SHIFTS） */
+    for (uint8_t k = 0; k < NG_K_SPACE; k++) {
+        capture_reset();
+        naginata_shift_press(ng_keycode[shift], false, 0);
+        naginata_shift_press(ng_keycode[k], false, 0);
+        naginata_shift_release(ng_keycode[k], 0);
+        naginata_shift_release(ng_keycode[shift], 0);
+        if (cap.len > 0 && !cap.other && !strpbrk(cap.text, "\n\b")) {
+            dict_put(&naginata_dict, cap.text, ng_keycode[shift], ng_keycode[k], 2);
+        }
+    }
+    host_hid_set_hook(NULL, NULL);
+}
+
+/* ---- corpus -> strokes -------------------------------------------------- */
+
+struct stroke_plan {
+    const struct recipe *r;
+    uint32_t kana; /* このストロークで出るかなの数 */
+};
+
+struct plan {
+    struct stroke_plan *strokes;
+    size_t count, cap;
+    size_t kana;     /* 逆引きできたかな */
+    size_t skipped;  /* できなかった文字（空白を除く） */
+};
+
+static void plan_push(struct plan *p, const struct recipe *r, uint32_t kana) {
+    if (p->count == p->cap) {
+        p->cap = p->cap ? p->cap * 2 : 4096;
+        p->strokes = realloc(p->strokes, p->cap * sizeof(*p->strokes));
+    }
+    p->strokes[p->count++] = (struct stroke_plan){r, kana};
+    p->kana += kana;
+}
+
+/* 最長一致で区切る */
+static void plan_text(int mode, const char *text, struct plan *p) {
+    const char *s = text;
+    char sub[MATCH_MAX_CP * 4 + 1];
+    char roman[ROMAN_MAX];
+
+    while (*s) {
+        if (*s == ' ' || *s == '\n' || *s == '\r' || *s == '\t') {
+            s++;
+            continue;
+        }
+
+        /* 先頭から MATCH_MAX_CP 文字までの境界 */
+        size_t ends[MATCH_MAX_CP];
+        size_t n = 0, off = 0;
+        while (n < MATCH_MAX_CP && s[off] && s[off] != '\n' && s[off] != ' ') {
+            off += utf8_len((uint8_t)s[off]);
+            ends[n++] = off;
+        }
+
+        const struct recipe *hit = NULL;
+        size_t used = 0;
+        for (size_t k = n; k > 0 && !hit; k--) {
+            memcpy(sub, s, ends[k - 1]);
+            sub[ends[k - 1]] = '\0';
+            if (kana_roman_encode(sub, roman, sizeof(roman)) == 0) {
+                continue;
+            }
+            hit = dict_get(dict_of(mode), roman);
+            used = k;
+        }
+
+        if (hit) {
+            plan_push(p, hit, (uint32_t)used);
+            s += ends[used - 1];
+        } else {
+            p->skipped++;
+            s += utf8_len((uint8_t)*s);
+        }
+    }
+}
+
+/* ---- trace -------------------------------------------------------------- */
+
+struct event {
+    int64_t ts;
+    uint32_t key;
+    uint32_t stroke;
+    bool pressed;
+};
+
+struct trace {
+    struct event *ev;
+    size_t count, cap;
+};
+
+static void trace_push(struct trace *t, int64_t ts, uint32_t key, bool pressed, uint32_t stroke) {
+    if (t->count == t->cap) {
+        t->cap = t->cap ? t->cap * 2 : 16384;
+        t->ev = realloc(t->ev, t->cap * sizeof(*t->ev));
+    }
+    t->ev[t->count++] = (struct event){ts, key, stroke, pressed};
+}
+
+static int cmp_event(const void *a, const void *b) {
+    const struct event *x = a, *y = b;
+    if (x->ts != y->ts) {
+        return x->ts < y->ts ? -1 : 1;
+    }
+    /* 同時刻は離上を先に（同じキーの再押下を正しく並べる） */
+    if (x->pressed != y->pressed) {
+        return x->pressed ? 1 : -1;
+    }
+    return x->stroke < y->stroke ? -1 : x->stroke > y->stroke;
+}
+
+/* behavior_mejiro と同じく、chord_seg のキーは stroke code の 1 bit */
+static size_t code_to_keys(uint32_t code, uint32_t *keys) {
+    size_t n = 0;
+    for (int b = 0; b < MEJIRO_KEYS_PER_HAND; b++) {
+        if (code & MJ_ID_CODE_BIT(MJ_L_0 + b)) {
+            keys[n++] = MJ_ID_CODE_BIT(MJ_L_0 + b);
+        }
+        if (code & MJ_ID_CODE_BIT(MJ_R_0 + b)) {
+            keys[n++] = MJ_ID_CODE_BIT(MJ_R_0 + b);
+        }
+    }
+    if (code & MJ_ID_CODE_BIT(MJ_MOD_H)) {
+        keys[n++] = MJ_ID_CODE_BIT(MJ_MOD_H);
+    }
+    if (code & MJ_ID_CODE_BIT(MJ_MOD_X)) {
+        keys[n++] = MJ_ID_CODE_BIT(MJ_MOD_X);
+    }
+    return n;
+}
+
+static uint32_t keys_to_code(const struct chord_stroke *stroke) {
+    uint32_t code = 0;
+    for (uint8_t i = 0; i < stroke->count; i++) {
+        code |= stroke->keys[i];
+    }
+    return code;
+}
+
+/*
+ * Mejiro: ストロークごとに全キーを数 ms ずらして押し、hold 後にばらばらに離す。
+ * 次のストロークは interval 後（hold > interval なら自然にロールオーバーになる）。
+ * 同じキーが続く時は、前の離上より後に押す。
+ */
+static void trace_mejiro(const struct plan *p, struct trace *t) {
+    int64_t start = 0;
+    int64_t last_release[32] = {0}; /* code の bit 番号ごと */
+
+    for (size_t i = 0; i < p->count; i++) {
+        uint32_t keys[2 * MEJIRO_KEYS_PER_HAND + 2];
+        size_t n = code_to_keys(p->strokes[i].r->a, keys);
+        int64_t first = start;
+
+        for (size_t k = 0; k < n; k++) {
+            if (last_release[__builtin_ctz(keys[k])] >= first) {
+                first = last_release[__builtin_ctz(keys[k])] + 1;
+            }
+        }
+        for (size_t k = 0; k < n; k++) {
+            int64_t press = first + (int64_t)(rng() % (uint32_t)(opt.jitter_ms / 2 + 1));
+            int64_t release = first + opt.hold_ms + jitter(opt.jitter_ms);
+            if (release <= press) {
+                release = press + 1;
+            }
+            trace_push(t, press, keys[k], true, (uint32_t)i);
+            trace_push(t, release, keys[k], false, (uint32_t)i);
+            last_release[__builtin_ctz(keys[k])] = release;
+        }
+        start = first + opt.interval_ms + jitter(opt.jitter_ms);
+    }
+    qsort(t->ev, t->count, sizeof(*t->ev), cmp_event);
+}
+
+/*
+ * Naginata: 同じシフトキーの文字が続く間はシフトを押したまま（連続シフト）、
+ * 文字キーは 1 つずつ押して離す。
+ */
+static void trace_naginata(const struct plan *p, struct trace *t) {
+    int64_t ts = 0;
+    uint32_t held = 0;
+
+    for (size_t i = 0; i < p->count; i++) {
+        const struct recipe *r = p->strokes[i].r;
+        if (held != r->a) {
+            if (held) {
+                trace_push(t, ts, held, false, (uint32_t)i);
+                ts += opt.interval_ms / 4;
+            }
+            held = r->a;
+            trace_push(t, ts, held, true, (uint32_t)i);
+            ts += opt.interval_ms / 4 + jitter(opt.jitter_ms / 2);
+        }
+        int64_t hold = opt.hold_ms / 2 + jitter(opt.jitter_ms);
+        trace_push(t, ts, r->b, true, (uint32_t)i);
+        trace_push(t, ts + (hold > 1 ? hold : 1), r->b, false, (uint32_t)i);
+        ts += opt.interval_ms + jitter(opt.jitter_ms);
+    }
+    if (held) {
+        trace_push(t, ts, held, false, (uint32_t)p->count);
+    }
+    /* hold が間隔より長いと次の押下が前の離上より先になる */
+    qsort(t->ev, t->count, sizeof(*t->ev), cmp_event);
+}
+
+/* ---- replay ------------------------------------------------------------- */
+
+struct samples {
+    uint32_t *us;
+    size_t count, cap;
+};
+
+static void sample_push(struct samples *s, int64_t us) {
+    if (s->count == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 16384;
+        s->us = realloc(s->us, s->cap * sizeof(*s->us));
+    }
+    s->us[s->count++] = us < 0 ? 0 : (uint32_t)us;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(struct samples *s, double q) {
+    if (!s->count) {
+        return 0;
+    }
+    qsort(s->us, s->count, sizeof(*s->us), cmp_u32);
+    size_t i = (size_t)(q * (double)(s->count - 1) + 0.5);
+    return s->us[i] / 1000.0;
+}
+
+static struct {
+    int mode;
+    const struct plan *plan;
+    struct chord_engine engine;
+    uint64_t cpu_ns;
+    struct samples final, first;
+    int64_t spec_visible_us; /* 推測で最初に見えた時刻（-1: まだ） */
+    uint32_t next_stroke;    /* 次に確定するはずのストローク（plan の添字） */
+    uint32_t mismatch;
+    uint32_t unresolved;
+    /* mejiro-split: peer は peripheral（mejiro_half.c）の chord_seg の代わり */
+    struct chord_engine peer;
+    struct mejiro_merge merge;
+    int64_t *first_press; /* plan のストロークごとの最初の押下 */
+    uint32_t link_msgs;   /* peripheral -> central（START + STROKE） */
+    uint32_t link_keys;   /* 1 キーずつ送った時（押下 + 離上） */
+} rp;
+
+/* 処理時間込みの「いま」(µs)。k_sleep の分は仮想時間に入っている */
+static int64_t now_us(uint64_t t0) {
+    return k_uptime_get() * 1000 + (int64_t)((host_now_ns() - t0) / 1000);
+}
+
+/* 確定したストロークの出力をコーパス側のローマ字と比べる */
+static void check_output(void) {
+    if (rp.next_stroke < rp.plan->count &&
+        strcmp(cap.text, rp.plan->strokes[rp.next_stroke].r->roman) != 0) {
+        rp.mismatch++;
+    }
+    rp.next_stroke++;
+    capture_reset();
+}
+
+/* ---- chord_engine ops（behavior_mejiro.c / behavior_naginata.c と同じ形） ---- */
+
+static void mejiro_commit(struct chord_engine *engine, const struct chord_stroke *stroke) {
+    ARG_UNUSED(engine);
+    uint64_t t0 = host_now_ns();
+    struct mejiro_state latched;
+
+    mejiro_state_reset(&latched);
+    mejiro_state_from_code(&latched, keys_to_code(stroke));
+
+    bool spec = rp.mode == MODE_MEJIRO_SPEC && mejiro_spec_commit(&latched, stroke->last_release);
+    if (!spec && !mejiro_try_emit(&latched, stroke->last_release)) {
+        rp.unresolved++;
+    }
+
+    int64_t done = now_us(t0);
+    sample_push(&rp.final, done - stroke->first_press * 1000);
+    if (rp.mode == MODE_MEJIRO_SPEC) {
+        int64_t seen = rp.spec_visible_us >= 0 ? rp.spec_visible_us : done;
+        sample_push(&rp.first, seen - stroke->first_press * 1000);
+        rp.spec_visible_us = -1;
+    }
+    if (rp.mode == MODE_MEJIRO_COMMIT) {
+        check_output();
+    }
+}
+
+static void mejiro_pressed(struct chord_engine *engine, const struct chord_stroke *stroke,
+                           int64_t timestamp) {
+    if (rp.mode != MODE_MEJIRO_SPEC || chord_engine_pending(engine) != 1 || stroke->count > 2) {
+        return;
+    }
+
+    uint64_t t0 = host_now_ns();
+    struct host_hid_stats before, after;
+    struct mejiro_state partial;
+
+    host_hid_get_stats(&before);
+    mejiro_state_reset(&partial);
+    mejiro_state_from_code(&partial, keys_to_code(stroke));
+    mejiro_spec_update(&partial, stroke->first_press, timestamp);
+    host_hid_get_stats(&after);
+    if (after.events != before.events && rp.spec_visible_us < 0) {
+        rp.spec_visible_us = now_us(t0);
+    }
+}
+
+static const struct chord_engine_ops mejiro_ops = {
+    .name = "mejiro",
+    .pressed = mejiro_pressed,
+    .commit = mejiro_commit,
+};
+
+/* mejiro-split: central が合わせたストローク */
+static void split_emit(uint32_t code, int64_t timestamp, void *user_data) {
+    ARG_UNUSED(user_data);
+    uint64_t t0 = host_now_ns();
+    struct mejiro_state latched;
+
+    mejiro_state_reset(&latched);
+    mejiro_state_from_code(&latched, code);
+    if (!mejiro_try_emit(&latched, timestamp)) {
+        rp.unresolved++;
+    }
+    if (rp.next_stroke < rp.plan->count) {
+        sample_push(&rp.final, now_us(t0) - rp.first_press[rp.next_stroke] * 1000);
+    }
+    check_output();
+}
+
+static enum mejiro_half_src split_src(const struct chord_engine *engine) {
+    return engine == &rp.peer ? MEJIRO_HALF_REMOTE : MEJIRO_HALF_LOCAL;
+}
+
+/* behavior_mejiro.c / mejiro_half.c と同じく、離上時に切り出されたストロークの始まりも渡す */
+static void split_start(struct chord_engine *engine, const struct chord_stroke *stroke) {
+    rp.link_msgs += engine == &rp.peer;
+    mejiro_merge_start(&rp.merge, split_src(engine), stroke->first_press);
+}
+
+/* peripheral の確定。split の遅延は入れない（同じ時刻に central に届く） */
+static void split_commit(struct chord_engine *engine, const struct chord_stroke *stroke) {
+    rp.link_msgs += engine == &rp.peer;
+    mejiro_merge_done(&rp.merge, split_src(engine), keys_to_code(stroke), stroke->last_release);
+}
+
+static const struct chord_engine_ops split_local_ops = {
+    .name = "mejiro",
+    .stroke_start = split_start,
+    .commit = split_commit,
+};
+
+static const struct chord_engine_ops split_remote_ops = {
+    .name = "mejiro-peer",
+    .stroke_start = split_start,
+    .commit = split_commit,
+};
+
+static void naginata_fallback(const uint32_t *keys, uint8_t count, int64_t ts) {
+    ARG_UNUSED(keys);
+    ARG_UNUSED(count);
+    ARG_UNUSED(ts);
+    rp.unresolved++;
+}
+
+/* 先行シフトでその場で確定したかなを数える（シフトキー自身は出力が無い） */
+static bool naginata_intercept_press(struct chord_engine *engine, uint32_t key,
+                                     int64_t timestamp) {
+    uint64_t t0 = host_now_ns();
+
+    if (!naginata_shift_press(key, chord_engine_pending(engine) > 0, timestamp)) {
+        return false;
+    }
+    if (!((1UL << naginata_key_index(key)) & B_SHIFTS)) {
+        sample_push(&rp.final, now_us(t0) - timestamp * 1000);
+        check_output();
+    }
+    return true;
+}
+
+static bool naginata_intercept_release(struct chord_engine *engine, uint32_t key,
+                                       int64_t timestamp) {
+    ARG_UNUSED(engine);
+    return naginata_shift_release(key, timestamp);
+}
+
+static void naginata_commit(struct chord_engine *engine, const struct chord_stroke *stroke) {
+    ARG_UNUSED(engine);
+    naginata_fallback(stroke->keys, stroke->count, stroke->first_press);
+}
+
+static const struct chord_engine_ops naginata_ops = {
+    .name = "naginata",
+    .intercept_press = naginata_intercept_press,
+    .intercept_release = naginata_intercept_release,
+    .commit = naginata_commit,
+};
+
+static void replay(int mode, const struct plan *p, const struct trace *t) {
+    const struct chord_engine_config cfg = {
+        .window_ms = CONFIG_ZMK_CHORD_ROLLOVER_SPLIT_MS,
+        .gap_ms = (uint16_t)opt.gap_ms,
+        .commit_mode = CHORD_COMMIT_ROLLOVER,
+    };
+
+    memset(&rp, 0, sizeof(rp));
+    rp.mode = mode;
+    rp.plan = p;
+    rp.spec_visible_us = -1;
+
+    if (mode == MODE_NAGINATA_SHIFT) {
+        chord_engine_init(&rp.engine, &naginata_ops, &cfg);
+        naginata_shift_init(naginata_fallback);
+    } else if (mode == MODE_MEJIRO_SPLIT) {
+        chord_engine_init(&rp.engine, &split_local_ops, &cfg);
+        chord_engine_init(&rp.peer, &split_remote_ops, &cfg);
+        mejiro_merge_init(&rp.merge, CONFIG_ZMK_MEJIRO_SPLIT_MERGE_WINDOW_MS,
+                          CONFIG_ZMK_MEJIRO_SPLIT_MERGE_TIMEOUT_MS, split_emit, NULL);
+        rp.first_press = malloc(p->count * sizeof(*rp.first_press));
+        for (size_t i = 0; i < p->count; i++) {
+            rp.first_press[i] = INT64_MAX;
+        }
+        for (size_t i = 0; i < t->count; i++) {
+            const struct event *e = &t->ev[i];
+            if (e->pressed && e->ts < rp.first_press[e->stroke]) {
+                rp.first_press[e->stroke] = e->ts;
+            }
+        }
+    } else {
+        chord_engine_init(&rp.engine, &mejiro_ops, &cfg);
+    }
+    host_hid_reset();
+    chord_power_reset_stats();
+    capture_reset();
+    host_hid_set_hook(capture_hook, NULL);
+    if (opt.companion) {
+        host_time_set_ms(0);
+        host_companion_attach(opt.companion == 1 ? HOST_COMPANION_ANSWER : HOST_COMPANION_LOST,
+                              companion_hook, NULL);
+    }
+
+    int64_t vt = 0;
+    for (size_t i = 0; i < t->count; i++) {
+        const struct event *e = &t->ev[i];
+        struct chord_engine *engine = &rp.engine;
+        /* k_sleep で仮想時間が先に進んでいれば、そのまま（キー入力は後ろにずれる） */
+        vt = e->ts > vt ? e->ts : vt;
+        host_time_set_ms(vt);
+
+        uint64_t t0 = host_now_ns();
+        if (mode == MODE_MEJIRO_SPLIT) {
+            mejiro_merge_expire(&rp.merge, e->ts);
+            if (e->key & SPLIT_REMOTE_KEYS) {
+                engine = &rp.peer;
+                rp.link_keys++;
+            }
+        }
+        if (e->pressed) {
+            chord_engine_press(engine, e->key, e->ts);
+        } else {
+            chord_engine_release(engine, e->key, e->ts);
+        }
+        rp.cpu_ns += host_now_ns() - t0;
+        vt = k_uptime_get();
+    }
+    uint64_t t0 = host_now_ns();
+    chord_engine_flush(&rp.engine);
+    if (mode == MODE_MEJIRO_SPLIT) {
+        chord_engine_flush(&rp.peer);
+        mejiro_merge_expire(&rp.merge, INT64_MAX);
+    }
+    rp.cpu_ns += host_now_ns() - t0;
+
+    if (opt.companion) {
+        host_companion_detach();
+    }
+    host_hid_set_hook(NULL, NULL);
+    host_time_set_ms(-1);
+}
+
+/* ---- main --------------------------------------------------------------- */
+
+static char *read_corpus(char **paths, int count) {
+    char *buf = NULL;
+    size_t len = 0;
+
+    for (int i = 0; i < count; i++) {
+        FILE *f = fopen(paths[i], "rb");
+        if (!f) {
+            perror(paths[i]);
+            free(buf);
+            return NULL;
+        }
+        char chunk[65536];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+            buf = realloc(buf, len + n + 2);
+            memcpy(buf + len, chunk, n);
+            len += n;
+        }
+        fclose(f);
+        buf = realloc(buf, len + 2);
+        buf[len++] = '\n';
+    }
+    if (buf) {
+        buf[len] = '\0';
+    }
+    return buf;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-i interval_ms] [-H hold_ms] [-j jitter_ms] [-s seed] [-r repeat]\n"
+            "          [-g gap_ms] [-c|-C]\n"
+            "          [-m mejiro-commit|mejiro-spec|mejiro-split|naginata-shift]\n"
+            "          corpus.txt...\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    bool enabled[MODE_COUNT] = {false};
+    bool any = false;
+    int c;
+
+    while ((c = getopt(argc, argv, "i:H:j:s:r:g:cCm:h")) != -1) {
+        switch (c) {
+        case 'i':
+            opt.interval_ms = atoi(optarg);
+            break;
+        case 'H':
+            opt.hold_ms = atoi(optarg);
+            break;
+        case 'j':
+            opt.jitter_ms = atoi(optarg);
+            break;
+        case 's':
+            rng_state = (uint32_t)strtoul(optarg, NULL, 0) | 1;
+            break;
+        case 'r':
+            opt.repeat = atoi(optarg);
+            break;
+        case 'g':
+            opt.gap_ms = atoi(optarg);
+            break;
+        case 'c':
+            opt.companion = 1;
+            break;
+        case 'C':
+            opt.companion = 2;
+            break;
+        case 'm':
+            for (int m = 0; m < MODE_COUNT; m++) {
+                if (strcmp(optarg, mode_names[m]) == 0) {
+                    enabled[m] = any = true;
+                }
+            }
+            if (!any) {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc || opt.interval_ms <= 0 || opt.hold_ms <= 0 || opt.jitter_ms < 0 ||
+        opt.repeat <= 0 || opt.gap_ms < 0 || opt.gap_ms > UINT16_MAX) {
+        usage(argv[0]);
+        return 2;
+    }
+    for (int m = 0; m < MODE_COUNT; m++) {
+        enabled[m] |= !any;
+    }
+
+    char *corpus = read_corpus(&argv[optind], argc - optind);
+    if (!corpus) {
+        return 1;
+    }
+
+    /* 出力の間隔（behavior の inter-key-gap-ms） */
+    struct naginata_timing ng_timing = *naginata_get_timing();
+    ng_timing.inter_key_gap_ms = (uint16_t)opt.gap_ms;
+    naginata_update_timing(&ng_timing);
+    mejiro_send_set_tap_gap((uint16_t)opt.gap_ms);
+
+    uint64_t t0 = host_now_ns();
+    build_mejiro_map();
+    build_naginata_map();
+    printf("reverse map: mejiro %zu outputs, naginata-shift %zu (%.0f ms)\n",
+           mejiro_dict.count, naginata_dict.count,
+           (host_now_ns() - t0) / 1e6);
+    printf("timing: interval %d ms, hold %d ms, jitter +-%d ms, split %d ms, gap %d ms (%s)%s\n\n",
+           opt.interval_ms, opt.hold_ms, opt.jitter_ms, CONFIG_ZMK_CHORD_ROLLOVER_SPLIT_MS,
+           opt.gap_ms, chord_power_on_battery() ? "battery" : "latency",
+           opt.companion == 1 ? ", companion" : opt.companion ? ", lossy companion" : "");
+
+    printf("%-15s %8s %7s %9s %7s %8s %9s %9s %9s %9s\n", "mode", "kana", "cover", "kana/s",
+           "typed/s", "HID/kana", "p50 ms", "p99 ms", "mismatch", "unresolv");
+
+    for (int m = 0; m < MODE_COUNT; m++) {
+        if (!enabled[m]) {
+            continue;
+        }
+
+        struct plan p = {0};
+        for (int r = 0; r < opt.repeat; r++) {
+            plan_text(m, corpus, &p);
+        }
+        if (p.count == 0) {
+            printf("%-15s (nothing in the corpus maps to this mode)\n", mode_names[m]);
+            continue;
+        }
+
+        struct chord_companion_stats cs0, cs1;
+        chord_companion_get_stats(&cs0);
+
+        struct trace t = {0};
+        if (m == MODE_NAGINATA_SHIFT) {
+            trace_naginata(&p, &t);
+        } else {
+            trace_mejiro(&p, &t);
+        }
+        replay(m, &p, &t);
+
+        struct host_hid_stats hid;
+        host_hid_get_stats(&hid);
+        double typed_s = (t.ev[t.count - 1].ts - t.ev[0].ts) / 1000.0;
+        /* 推測送信は BS で巻き戻すので、出力との突き合わせはしない */
+        char mismatch[16] = "-";
+        if (m != MODE_MEJIRO_SPEC) {
+            snprintf(mismatch, sizeof(mismatch), "%u", rp.mismatch);
+        }
+        printf("%-15s %8zu %6.1f%% %9.0f %7.1f %8.2f %9.2f %9.2f %9s %9u\n", mode_names[m], p.kana,
+               100.0 * p.kana / (double)(p.kana + p.skipped), p.kana * 1e9 / (double)rp.cpu_ns,
+               typed_s > 0 ? p.kana / typed_s : 0, (double)hid.events / (double)p.kana,
+               percentile(&rp.final, 0.50), percentile(&rp.final, 0.99), mismatch,
+               rp.unresolved);
+        if (m == MODE_MEJIRO_SPEC) {
+            struct mejiro_spec_stats ss;
+            mejiro_spec_get_stats(&ss);
+            printf("%-15s first visible p50 %.1f ms / p99 %.1f ms, %u rollbacks (%u BS)\n", "",
+                   percentile(&rp.first, 0.50), percentile(&rp.first, 0.99), ss.rollbacks,
+                   ss.rollback_chars);
+        }
+        if (m == MODE_MEJIRO_SPLIT) {
+            printf("%-15s split link %u msgs (per-key %u), %u merged, %u single (%u timeouts)\n",
+                   "", rp.link_msgs, rp.link_keys, rp.merge.stats.merged, rp.merge.stats.single,
+                   rp.merge.stats.timeouts);
+        }
+
+        chord_companion_get_stats(&cs1);
+        if (opt.companion) {
+            const uint32_t frames = cs1.frames - cs0.frames;
+            printf("%-15s companion %.2f frames/kana, %.1f bytes/frame, %u fallbacks\n", "",
+                   frames / (double)p.kana,
+                   frames ? (cs1.bytes - cs0.bytes) / (double)frames : 0.0,
+                   cs1.fallbacks - cs0.fallbacks);
+        }
+
+        struct chord_power_stats ps;
+        chord_power_get_stats(&ps);
+        printf("%-15s wakeups/kana %.2f (key %.2f, output %.2f)\n", "",
+               (ps.wakeups[CHORD_WAKE_KEY] + ps.wakeups[CHORD_WAKE_OUTPUT]) / (double)p.kana,
+               ps.wakeups[CHORD_WAKE_KEY] / (double)p.kana,
+               ps.wakeups[CHORD_WAKE_OUTPUT] / (double)p.kana);
+
+        free(rp.final.us);
+        free(rp.first.us);
+        free(rp.first_press);
+        free(t.ev);
+        free(p.strokes);
+    }
+
+    free(corpus);
+    return 0;
+}
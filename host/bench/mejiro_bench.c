@@ -0,0 +1,341 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Microbenchmark for the engine cores (host build).
+ *
+ *   mejiro_bench [-n strokes] [-r rounds] [-s seed] [-f strokes.txt]
+ *
+ * -f は 1 行 1 ストローク（"tk-a" など、mejiro_build_stroke_string と同じ表記）。
+ * 無ければ seed から乱数でストロークを作る。各項目を rounds 回まわして最速の回を出す。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chord/chord_seg.h>
+#include <chord/kana_out.h>
+#include <mejiro/mejiro_core.h>
+#include <mejiro/mejiro_key_ids.h>
+#include <zmk_naginata/nglist.h>
+#include <zmk_naginata/nglistarray.h>
+
+#include "host_shim.h"
+
+static struct mejiro_state *strokes;
+static size_t stroke_count;
+
+/* 最適化で消されないように */
+static volatile size_t sink;
+
+/* ---- input ------------------------------------------------------------- */
+
+static uint32_t rng_state;
+
+static uint32_t rng(void) {
+    /* xorshift32 */
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* 片手 = 子音 4 bit + 撥音 + 母音 4 bit。1/4 は空、撥音は 1/8 */
+static uint32_t random_hand(void) {
+    if (rng() % 4 == 0) {
+        return 0;
+    }
+    return (rng() & 0xFu) | ((rng() % 8 == 0) ? (1u << 4) : 0) | ((rng() & 0xFu) << 5);
+}
+
+static void make_synthetic(size_t n) {
+    strokes = calloc(n, sizeof(*strokes));
+    for (size_t i = 0; i < n; i++) {
+        struct mejiro_state *s = &strokes[i];
+        do {
+            s->left_mask = random_hand();
+            s->right_mask = random_hand();
+            s->mod_mask = (rng() % 16 == 0) ? (rng() & (MJ_MOD_BIT_H | MJ_MOD_BIT_X)) : 0;
+        } while (!s->left_mask && !s->right_mask && !s->mod_mask);
+    }
+    stroke_count = n;
+}
+
+static int load_recorded(const char *path, size_t n) {
+    FILE *f = fopen(path, "r");
+    char line[64];
+    struct mejiro_state *rec = NULL;
+    size_t count = 0, cap = 0;
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || (line[0] == '#' && line[1] == ' ')) {
+            continue;
+        }
+        if (count == cap) {
+            cap = cap ? cap * 2 : 1024;
+            rec = realloc(rec, cap * sizeof(*rec));
+        }
+        if (!mejiro_parse_stroke_string(line, &rec[count])) {
+            fprintf(stderr, "%s: skip '%s'\n", path, line);
+            continue;
+        }
+        count++;
+    }
+    fclose(f);
+    if (count == 0) {
+        fprintf(stderr, "%s: no strokes\n", path);
+        return -1;
+    }
+
+    /* 記録を n まで繰り返して並べる */
+    strokes = calloc(n, sizeof(*strokes));
+    for (size_t i = 0; i < n; i++) {
+        strokes[i] = rec[i % count];
+    }
+    stroke_count = n;
+    free(rec);
+    return 0;
+}
+
+/* ---- benches ----------------------------------------------------------- */
+
+typedef size_t (*bench_fn)(void);
+
+static size_t bench_build(void) {
+    char buf[32];
+    size_t total = 0;
+    for (size_t i = 0; i < stroke_count; i++) {
+        total += mejiro_build_stroke_string(&strokes[i], buf, sizeof(buf));
+    }
+    return total;
+}
+
+static char (*stroke_strings)[32];
+
+static size_t bench_parse(void) {
+    struct mejiro_state s;
+    size_t total = 0;
+    for (size_t i = 0; i < stroke_count; i++) {
+        total += mejiro_parse_stroke_string(stroke_strings[i], &s);
+    }
+    return total;
+}
+
+static size_t bench_code(void) {
+    size_t total = 0;
+    for (size_t i = 0; i < stroke_count; i++) {
+        total += mejiro_stroke_code(&strokes[i]);
+    }
+    return total;
+}
+
+static size_t bench_lookup(void) {
+    char out[MEJIRO_OUTPUT_MAX];
+    size_t total = 0;
+    for (size_t i = 0; i < stroke_count; i++) {
+        total += mejiro_lookup(&strokes[i], out, sizeof(out));
+    }
+    return total;
+}
+
+static char (*kana)[MEJIRO_OUTPUT_MAX];
+
+static size_t bench_encode(void) {
+    char out[128];
+    size_t total = 0;
+    for (size_t i = 0; i < stroke_count; i++) {
+        total += kana_roman_encode(kana[i], out, sizeof(out));
+    }
+    return total;
+}
+
+static size_t bench_emit(void) {
+    size_t total = 0;
+    for (size_t i = 0; i < stroke_count; i++) {
+        total += mejiro_try_emit(&strokes[i], (int64_t)i);
+    }
+    return total;
+}
+
+static void seg_commit(const struct chord_stroke *stroke, void *user_data) {
+    *(size_t *)user_data += stroke->count;
+}
+
+/* 1 ストローク = 全キー押下 → 全キー離上。次のストロークの押下を少し重ねる（ロールオーバー） */
+static size_t bench_seg(void) {
+    static struct chord_seg seg;
+    size_t committed = 0;
+    int64_t ts = 0;
+    uint32_t prev[CHORD_STROKE_MAX_KEYS];
+    size_t prev_n = 0;
+
+    chord_seg_init(&seg, CONFIG_ZMK_CHORD_ROLLOVER_SPLIT_MS, seg_commit, &committed);
+    for (size_t i = 0; i < stroke_count; i++) {
+        const struct mejiro_state *s = &strokes[i];
+        uint32_t keys[CHORD_STROKE_MAX_KEYS];
+        size_t n = 0;
+
+        for (int b = 0; b < MEJIRO_KEYS_PER_HAND && n < CHORD_STROKE_MAX_KEYS; b++) {
+            if (s->left_mask & (1u << b)) {
+                keys[n++] = MJ_ID_CODE_BIT(MJ_L_0 + b);
+            }
+            if (s->right_mask & (1u << b) && n < CHORD_STROKE_MAX_KEYS) {
+                keys[n++] = MJ_ID_CODE_BIT(MJ_R_0 + b);
+            }
+        }
+        for (size_t k = 0; k < n; k++) {
+            chord_seg_press(&seg, keys[k], ts + (int64_t)k * 3);
+        }
+        /* 前のストロークの最後のキーをここで離す */
+        for (size_t k = 0; k < prev_n; k++) {
+            chord_seg_release(&seg, prev[k], ts + 10);
+        }
+        memcpy(prev, keys, n * sizeof(keys[0]));
+        prev_n = n;
+        ts += 120;
+    }
+    for (size_t k = 0; k < prev_n; k++) {
+        chord_seg_release(&seg, prev[k], ts);
+    }
+    chord_seg_flush(&seg);
+    return committed;
+}
+
+/* naginata の押下中キー集合の使い方（追加・検索・削除、配列へのコピー） */
+static size_t bench_nglist(void) {
+    NGList list;
+    NGListArray arr;
+    size_t total = 0;
+
+    initializeList(&list);
+    initializeListArray(&arr);
+    for (size_t i = 0; i < stroke_count; i++) {
+        uint32_t key = strokes[i].left_mask ^ (strokes[i].right_mask << 9);
+        if (list.size == NG_LIST_SIZE) {
+            removeFromListAt(&list, 0);
+        }
+        addToList(&list, key);
+        total += includeList(&list, key ^ 1) >= 0;
+        total += compareList01(&list, key, key);
+        if (i % 4 == 3) {
+            if (arr.size == NG_LIST_ARRAY_SIZE) {
+                removeFromListArrayAt(&arr, 0);
+            }
+            addToListArray(&arr, &list);
+            removeFromList(&list, key);
+        }
+    }
+    return total + (size_t)arr.size;
+}
+
+struct bench {
+    const char *name;
+    bench_fn fn;
+};
+
+static const struct bench benches[] = {
+    {"build_stroke_string", bench_build},
+    {"parse_stroke_string", bench_parse},
+    {"stroke_code", bench_code},
+    {"lookup", bench_lookup},
+    {"roman_encode", bench_encode},
+    {"try_emit", bench_emit},
+    {"chord_seg", bench_seg},
+    {"nglist", bench_nglist},
+};
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n strokes] [-r rounds] [-s seed] [-f strokes.txt] [bench...]\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    size_t n = 1000000;
+    int rounds = 5;
+    const char *recorded = NULL;
+    int opt;
+
+    rng_state = 0x4d454a49; /* "MEJI" */
+    while ((opt = getopt(argc, argv, "n:r:s:f:h")) != -1) {
+        switch (opt) {
+        case 'n':
+            n = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        case 's':
+            rng_state = (uint32_t)strtoul(optarg, NULL, 0) | 1;
+            break;
+        case 'f':
+            recorded = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (n == 0 || rounds <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (recorded) {
+        if (load_recorded(recorded, n)) {
+            return 1;
+        }
+    } else {
+        make_synthetic(n);
+    }
+
+    /* parse / encode の入力を先に作っておく */
+    stroke_strings = calloc(stroke_count, sizeof(*stroke_strings));
+    kana = calloc(stroke_count, sizeof(*kana));
+    size_t found = 0;
+    for (size_t i = 0; i < stroke_count; i++) {
+        mejiro_build_stroke_string(&strokes[i], stroke_strings[i], sizeof(stroke_strings[i]));
+        found += mejiro_lookup(&strokes[i], kana[i], sizeof(kana[i]));
+    }
+
+    printf("%zu strokes (%s), %zu resolve to kana, best of %d\n", stroke_count,
+           recorded ? recorded : "synthetic", found, rounds);
+    printf("%-22s %10s %14s\n", "bench", "ns/stroke", "strokes/s");
+
+    for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        bool selected = optind >= argc;
+        for (int i = optind; i < argc; i++) {
+            selected |= strcmp(argv[i], benches[b].name) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+
+        uint64_t best = UINT64_MAX;
+        host_hid_reset();
+        for (int r = 0; r < rounds; r++) {
+            uint64_t t0 = host_now_ns();
+            sink += benches[b].fn();
+            uint64_t dt = host_now_ns() - t0;
+            best = dt < best ? dt : best;
+        }
+        printf("%-22s %10.1f %14.0f", benches[b].name, (double)best / stroke_count,
+               stroke_count * 1e9 / (double)(best ? best : 1));
+
+        struct host_hid_stats hid;
+        host_hid_get_stats(&hid);
+        if (hid.events) {
+            printf("   (%.2f HID events/stroke)", (double)hid.events / rounds / stroke_count);
+        }
+        printf("\n");
+    }
+
+    free(kana);
+    free(stroke_strings);
+    free(strokes);
+    return 0;
+}
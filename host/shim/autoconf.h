@@ -0,0 +1,75 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Host build: Kconfig の既定値（cmake -DCMAKE_C_FLAGS=-DCONFIG_...=... で上書き可）
+ */
+#pragma once
+
+#define CONFIG_ZMK_MEJIRO 1
+
+/* 機能グループ（naginata_func.c）。-DCONFIG_ZMK_NAGINATA_EDIT=0 などで外せる */
+#ifndef CONFIG_ZMK_NAGINATA_DICT
+#define CONFIG_ZMK_NAGINATA_DICT 1
+#endif
+#ifndef CONFIG_ZMK_NAGINATA_EDIT
+#define CONFIG_ZMK_NAGINATA_EDIT 1
+#endif
+#ifndef CONFIG_ZMK_NAGINATA_UNICODE_HEX
+#define CONFIG_ZMK_NAGINATA_UNICODE_HEX 1
+#endif
+
+#ifndef CONFIG_ZMK_LOG_LEVEL
+#define CONFIG_ZMK_LOG_LEVEL 0
+#endif
+#ifndef CONFIG_ZMK_CHORD_ROLLOVER_SPLIT_MS
+#define CONFIG_ZMK_CHORD_ROLLOVER_SPLIT_MS 30
+#endif
+#ifndef CONFIG_ZMK_CHORD_MAX_STROKE_KEYS
+#define CONFIG_ZMK_CHORD_MAX_STROKE_KEYS 10
+#endif
+#ifndef CONFIG_ZMK_CHORD_MAX_PENDING_STROKES
+#define CONFIG_ZMK_CHORD_MAX_PENDING_STROKES 4
+#endif
+
+/* 出力の起きた回数をベンチで見る（chord_power.h） */
+#ifndef CONFIG_ZMK_CHORD_POWER_STATS
+#define CONFIG_ZMK_CHORD_POWER_STATS 1
+#endif
+
+/* kana_out -> chord_companion（相手は companion_loopback.c、corpus_bench -c） */
+#define CONFIG_ZMK_CHORD_COMPANION 1
+
+/* mejiro_spec.c（host では CONFIG_ZMK_MEJIRO_SPECULATIVE は立てず、ベンチから直接呼ぶ） */
+#ifndef CONFIG_ZMK_MEJIRO_SPECULATIVE_WINDOW_MS
+#define CONFIG_ZMK_MEJIRO_SPECULATIVE_WINDOW_MS 50
+#endif
+#ifndef CONFIG_ZMK_MEJIRO_SPECULATIVE_JOURNAL_LEN
+#define CONFIG_ZMK_MEJIRO_SPECULATIVE_JOURNAL_LEN 32
+#endif
+
+/* mejiro_flash_dict.c（test_flash_dict） */
+#ifndef CONFIG_ZMK_MEJIRO_FLASH_DICT_PAGE_MAX
+#define CONFIG_ZMK_MEJIRO_FLASH_DICT_PAGE_MAX 256
+#endif
+#ifndef CONFIG_ZMK_MEJIRO_FLASH_DICT_CACHE_SLOTS
+#define CONFIG_ZMK_MEJIRO_FLASH_DICT_CACHE_SLOTS 64
+#endif
+#ifndef CONFIG_ZMK_MEJIRO_FLASH_DICT_TEXT_LEN
+#define CONFIG_ZMK_MEJIRO_FLASH_DICT_TEXT_LEN 24
+#endif
+
+/* mejiro_dict_update.c（test_dict_update） */
+#ifndef CONFIG_ZMK_MEJIRO_DICT_UPDATE_CHUNK_MAX
+#define CONFIG_ZMK_MEJIRO_DICT_UPDATE_CHUNK_MAX 256
+#endif
+#ifndef CONFIG_ZMK_MEJIRO_DICT_UPDATE_WRITE_BLOCK
+#define CONFIG_ZMK_MEJIRO_DICT_UPDATE_WRITE_BLOCK 256
+#endif
+
+/* mejiro_merge（corpus_bench の mejiro-split） */
+#ifndef CONFIG_ZMK_MEJIRO_SPLIT_MERGE_WINDOW_MS
+#define CONFIG_ZMK_MEJIRO_SPLIT_MERGE_WINDOW_MS 50
+#endif
+#ifndef CONFIG_ZMK_MEJIRO_SPLIT_MERGE_TIMEOUT_MS
+#define CONFIG_ZMK_MEJIRO_SPLIT_MERGE_TIMEOUT_MS 300
+#endif
@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Loopback companion: scripts/chord_companion.py の代わりに、送られたフレームを
+ * その場で解いて hook に渡し、返事を chord_companion_receive() で返す。
+ * 解く側は chord_companion.c とは別に書いてある（フレームの形の確認を兼ねる）。
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+
+#include <chord/chord_companion.h>
+
+#include "host_shim.h"
+
+static struct {
+    enum host_companion_mode mode;
+    host_companion_hook_t hook;
+    void *user;
+    int typed;     /* 最後に入力した seq（-1: まだ） */
+    int cancelled; /* 取り消した seq。後から届いても入力しない */
+    uint32_t bad;
+} lb;
+
+static void reply(uint8_t type, const uint8_t *payload, uint16_t len) {
+    uint8_t frame[5 + 8 + 2];
+
+    frame[0] = CHORD_COMP_SYNC0;
+    frame[1] = CHORD_COMP_SYNC1;
+    frame[2] = type;
+    frame[3] = (uint8_t)len;
+    frame[4] = (uint8_t)(len >> 8);
+    memcpy(&frame[5], payload, len);
+    uint16_t crc = crc16_itu_t(0, &frame[2], 3 + len);
+    frame[5 + len] = (uint8_t)crc;
+    frame[6 + len] = (uint8_t)(crc >> 8);
+    chord_companion_receive(frame, 7 + len);
+}
+
+/* write は 1 フレームずつ来る */
+static int loopback_write(const uint8_t *data, size_t len, void *ctx) {
+    (void)ctx;
+    if (len < 7 || data[0] != CHORD_COMP_SYNC0 || data[1] != CHORD_COMP_SYNC1) {
+        lb.bad++;
+        return -EINVAL;
+    }
+    const uint16_t plen = (uint16_t)(data[3] | data[4] << 8);
+    const uint16_t crc = (uint16_t)(data[5 + plen] | data[6 + plen] << 8);
+    if ((size_t)plen + 7 != len || crc16_itu_t(0, &data[2], 3 + plen) != crc) {
+        lb.bad++;
+        return -EINVAL;
+    }
+    if (plen < 1 || lb.mode == HOST_COMPANION_SILENT) {
+        return 0;
+    }
+
+    const uint8_t *payload = &data[5];
+    const uint8_t seq = payload[0];
+
+    if (data[2] == CHORD_COMP_CANCEL) {
+        const uint8_t resp[2] = {seq, seq == lb.typed};
+
+        if (lb.mode == HOST_COMPANION_LATE && seq == lb.typed) {
+            /* 止まっていた返事が CANCEL より先に届く */
+            reply(CHORD_COMP_TEXT | CHORD_COMP_RESP, &seq, 1);
+        }
+        if (seq != lb.typed) {
+            lb.cancelled = seq;
+        }
+        reply(CHORD_COMP_CANCEL | CHORD_COMP_RESP, resp, sizeof(resp));
+        return 0;
+    }
+    if (data[2] != CHORD_COMP_TEXT || lb.mode == HOST_COMPANION_LOST || seq == lb.cancelled) {
+        return 0;
+    }
+    if (lb.hook) {
+        lb.hook((const char *)&payload[1], plen - 1u, lb.user);
+    }
+    lb.typed = seq;
+    if (lb.mode == HOST_COMPANION_ANSWER) {
+        reply(CHORD_COMP_TEXT | CHORD_COMP_RESP, &seq, 1);
+    }
+    return 0;
+}
+
+static const struct chord_companion_transport loopback = {.write = loopback_write};
+
+void host_companion_attach(enum host_companion_mode mode, host_companion_hook_t hook,
+                           void *user) {
+    const uint8_t version = CHORD_COMP_VERSION;
+
+    lb.mode = mode;
+    lb.typed = lb.cancelled = -1;
+    lb.hook = hook;
+    lb.user = user;
+    chord_companion_set_transport(&loopback);
+    reply(CHORD_COMP_HELLO, &version, 1);
+}
+
+void host_companion_detach(void) {
+    reply(CHORD_COMP_BYE, NULL, 0);
+    chord_companion_set_transport(NULL);
+    if (lb.bad) {
+        fprintf(stderr, "companion loopback: %u bad frames\n", lb.bad);
+        lb.bad = 0;
+    }
+}
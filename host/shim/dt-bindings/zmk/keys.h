@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+#include <dt-bindings/zmk/modifiers.h>
+
+/* zmk/app/include/dt-bindings/zmk/keys.h の一部（usage page 0x07） */
+#define ZMK_HID_USAGE(page, id) (((page) << 16) | (id))
+
+#define A ZMK_HID_USAGE(0x07, 0x04)
+#define B ZMK_HID_USAGE(0x07, 0x05)
+#define C ZMK_HID_USAGE(0x07, 0x06)
+#define D ZMK_HID_USAGE(0x07, 0x07)
+#define E ZMK_HID_USAGE(0x07, 0x08)
+#define F ZMK_HID_USAGE(0x07, 0x09)
+#define G ZMK_HID_USAGE(0x07, 0x0A)
+#define H ZMK_HID_USAGE(0x07, 0x0B)
+#define I ZMK_HID_USAGE(0x07, 0x0C)
+#define J ZMK_HID_USAGE(0x07, 0x0D)
+#define K ZMK_HID_USAGE(0x07, 0x0E)
+#define L ZMK_HID_USAGE(0x07, 0x0F)
+#define M ZMK_HID_USAGE(0x07, 0x10)
+#define N ZMK_HID_USAGE(0x07, 0x11)
+#define O ZMK_HID_USAGE(0x07, 0x12)
+#define P ZMK_HID_USAGE(0x07, 0x13)
+#define Q ZMK_HID_USAGE(0x07, 0x14)
+#define R ZMK_HID_USAGE(0x07, 0x15)
+#define S ZMK_HID_USAGE(0x07, 0x16)
+#define T ZMK_HID_USAGE(0x07, 0x17)
+#define U ZMK_HID_USAGE(0x07, 0x18)
+#define V ZMK_HID_USAGE(0x07, 0x19)
+#define W ZMK_HID_USAGE(0x07, 0x1A)
+#define X ZMK_HID_USAGE(0x07, 0x1B)
+#define Y ZMK_HID_USAGE(0x07, 0x1C)
+#define Z ZMK_HID_USAGE(0x07, 0x1D)
+#define N1 ZMK_HID_USAGE(0x07, 0x1E)
+#define N2 ZMK_HID_USAGE(0x07, 0x1F)
+#define N3 ZMK_HID_USAGE(0x07, 0x20)
+#define N4 ZMK_HID_USAGE(0x07, 0x21)
+#define N5 ZMK_HID_USAGE(0x07, 0x22)
+#define N6 ZMK_HID_USAGE(0x07, 0x23)
+#define N7 ZMK_HID_USAGE(0x07, 0x24)
+#define N8 ZMK_HID_USAGE(0x07, 0x25)
+#define N9 ZMK_HID_USAGE(0x07, 0x26)
+#define N0 ZMK_HID_USAGE(0x07, 0x27)
+#define ENTER ZMK_HID_USAGE(0x07, 0x28)
+#define ESCAPE ZMK_HID_USAGE(0x07, 0x29)
+#define BSPC ZMK_HID_USAGE(0x07, 0x2A)
+#define TAB ZMK_HID_USAGE(0x07, 0x2B)
+#define SPACE ZMK_HID_USAGE(0x07, 0x2C)
+#define MINUS ZMK_HID_USAGE(0x07, 0x2D)
+#define EQUAL ZMK_HID_USAGE(0x07, 0x2E)
+#define LBKT ZMK_HID_USAGE(0x07, 0x2F)
+#define RBKT ZMK_HID_USAGE(0x07, 0x30)
+#define BSLH ZMK_HID_USAGE(0x07, 0x31)
+#define SEMI ZMK_HID_USAGE(0x07, 0x33)
+#define SQT ZMK_HID_USAGE(0x07, 0x34)
+#define GRAVE ZMK_HID_USAGE(0x07, 0x35)
+#define COMMA ZMK_HID_USAGE(0x07, 0x36)
+#define DOT ZMK_HID_USAGE(0x07, 0x37)
+#define SLASH ZMK_HID_USAGE(0x07, 0x38)
+#define F1 ZMK_HID_USAGE(0x07, 0x3A)
+#define F2 ZMK_HID_USAGE(0x07, 0x3B)
+#define F3 ZMK_HID_USAGE(0x07, 0x3C)
+#define F4 ZMK_HID_USAGE(0x07, 0x3D)
+#define F5 ZMK_HID_USAGE(0x07, 0x3E)
+#define F6 ZMK_HID_USAGE(0x07, 0x3F)
+#define F7 ZMK_HID_USAGE(0x07, 0x40)
+#define F8 ZMK_HID_USAGE(0x07, 0x41)
+#define F9 ZMK_HID_USAGE(0x07, 0x42)
+#define F10 ZMK_HID_USAGE(0x07, 0x43)
+#define F11 ZMK_HID_USAGE(0x07, 0x44)
+#define F12 ZMK_HID_USAGE(0x07, 0x45)
+#define HOME ZMK_HID_USAGE(0x07, 0x4A)
+#define DELETE ZMK_HID_USAGE(0x07, 0x4C)
+#define END ZMK_HID_USAGE(0x07, 0x4D)
+#define RIGHT ZMK_HID_USAGE(0x07, 0x4F)
+#define LEFT ZMK_HID_USAGE(0x07, 0x50)
+#define DOWN ZMK_HID_USAGE(0x07, 0x51)
+#define UP ZMK_HID_USAGE(0x07, 0x52)
+#define F13 ZMK_HID_USAGE(0x07, 0x68)
+#define F14 ZMK_HID_USAGE(0x07, 0x69)
+#define F15 ZMK_HID_USAGE(0x07, 0x6A)
+#define F16 ZMK_HID_USAGE(0x07, 0x6B)
+#define F17 ZMK_HID_USAGE(0x07, 0x6C)
+#define F18 ZMK_HID_USAGE(0x07, 0x6D)
+#define F19 ZMK_HID_USAGE(0x07, 0x6E)
+#define F20 ZMK_HID_USAGE(0x07, 0x6F)
+#define F21 ZMK_HID_USAGE(0x07, 0x70)
+#define F22 ZMK_HID_USAGE(0x07, 0x71)
+#define F23 ZMK_HID_USAGE(0x07, 0x72)
+#define F24 ZMK_HID_USAGE(0x07, 0x73)
+#define INT1 ZMK_HID_USAGE(0x07, 0x87)
+#define INT2 ZMK_HID_USAGE(0x07, 0x88)
+#define INT3 ZMK_HID_USAGE(0x07, 0x89)
+#define INT4 ZMK_HID_USAGE(0x07, 0x8A)
+#define INT5 ZMK_HID_USAGE(0x07, 0x8B)
+#define LANG1 ZMK_HID_USAGE(0x07, 0x90)
+#define LANG2 ZMK_HID_USAGE(0x07, 0x91)
+#define LEFT_CONTROL ZMK_HID_USAGE(0x07, 0xE0)
+#define LEFT_SHIFT ZMK_HID_USAGE(0x07, 0xE1)
+#define LEFT_ALT ZMK_HID_USAGE(0x07, 0xE2)
+#define LEFT_GUI ZMK_HID_USAGE(0x07, 0xE3)
+#define RIGHT_CONTROL ZMK_HID_USAGE(0x07, 0xE4)
+#define RIGHT_SHIFT ZMK_HID_USAGE(0x07, 0xE5)
+#define RIGHT_ALT ZMK_HID_USAGE(0x07, 0xE6)
+#define RIGHT_GUI ZMK_HID_USAGE(0x07, 0xE7)
+
+#define ESC ESCAPE
+#define LSHIFT LEFT_SHIFT
+#define LEFT_WIN LEFT_GUI
+#define LCTRL LEFT_CONTROL
@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+/* zmk/app/include/dt-bindings/zmk/modifiers.h と同じ符号化 */
+#define MOD_LCTL 0x01
+#define MOD_LSFT 0x02
+#define MOD_LALT 0x04
+#define MOD_LGUI 0x08
+
+#define APPLY_MODS(mods, keycode) (((mods) << 24) | (keycode))
+#define SELECT_MODS(keycode) ((keycode) >> 24)
+#define STRIP_MODS(keycode) ((keycode) & ~(0xFF << 24))
+
+#define LC(keycode) APPLY_MODS(MOD_LCTL, keycode)
+#define LS(keycode) APPLY_MODS(MOD_LSFT, keycode)
+#define LA(keycode) APPLY_MODS(MOD_LALT, keycode)
+#define LG(keycode) APPLY_MODS(MOD_LGUI, keycode)
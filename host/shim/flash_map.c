@@ -0,0 +1,94 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * zephyr/storage/flash_map.h の RAM 版（host/test 用）。
+ */
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/storage/flash_map.h>
+
+#include "host_shim.h"
+
+#define AREA_SIZE 8192
+#define WRITE_ALIGN 4
+
+static uint8_t mem[HOST_PARTITION_COUNT][AREA_SIZE];
+static uint32_t erases[HOST_PARTITION_COUNT];
+static bool erased_once[HOST_PARTITION_COUNT];
+static bool fail_reads;
+
+static const struct flash_area areas[HOST_PARTITION_COUNT] = {
+    {.fa_id = 0, .fa_off = 0, .fa_size = AREA_SIZE},
+    {.fa_id = 1, .fa_off = AREA_SIZE, .fa_size = AREA_SIZE},
+};
+
+static bool in_range(const struct flash_area *fa, off_t off, size_t len) {
+    return fa && off >= 0 && (size_t)off <= fa->fa_size && len <= fa->fa_size - (size_t)off;
+}
+
+int flash_area_open(uint8_t id, const struct flash_area **fa) {
+    if (id >= HOST_PARTITION_COUNT) {
+        return -ENOENT;
+    }
+    /* 買ったばかりの flash は消えている */
+    if (!erased_once[id]) {
+        memset(mem[id], 0xFF, AREA_SIZE);
+        erased_once[id] = true;
+    }
+    *fa = &areas[id];
+    return 0;
+}
+
+void flash_area_close(const struct flash_area *fa) { (void)fa; }
+
+int flash_area_read(const struct flash_area *fa, off_t off, void *dst, size_t len) {
+    if (!in_range(fa, off, len)) {
+        return -EINVAL;
+    }
+    if (fail_reads) {
+        return -EIO;
+    }
+    memcpy(dst, &mem[fa->fa_id][off], len);
+    return 0;
+}
+
+int flash_area_write(const struct flash_area *fa, off_t off, const void *src, size_t len) {
+    const uint8_t *p = src;
+
+    if (!in_range(fa, off, len) || off % WRITE_ALIGN || len % WRITE_ALIGN) {
+        return -EINVAL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        mem[fa->fa_id][off + i] &= p[i];
+    }
+    return 0;
+}
+
+int flash_area_erase(const struct flash_area *fa, off_t off, size_t len) {
+    if (!in_range(fa, off, len)) {
+        return -EINVAL;
+    }
+    memset(&mem[fa->fa_id][off], 0xFF, len);
+    erases[fa->fa_id]++;
+    return 0;
+}
+
+uint32_t flash_area_align(const struct flash_area *fa) {
+    (void)fa;
+    return WRITE_ALIGN;
+}
+
+const uint8_t *host_flash_data(uint8_t id, size_t *size) {
+    const struct flash_area *fa;
+
+    if (flash_area_open(id, &fa)) {
+        return NULL;
+    }
+    *size = fa->fa_size;
+    return mem[id];
+}
+
+uint32_t host_flash_erases(uint8_t id) { return id < HOST_PARTITION_COUNT ? erases[id] : 0; }
+
+void host_flash_fail_reads(bool fail) { fail_reads = fail; }
@@ -0,0 +1,107 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <time.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zmk/events/keycode_state_changed.h>
+
+#include "host_shim.h"
+
+static struct host_hid_stats hid_stats;
+static host_hid_hook_t hid_hook;
+static void *hid_hook_user;
+static int64_t virtual_ms = -1;
+static int64_t slept_ms;
+
+uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+int64_t k_uptime_get(void) {
+    if (virtual_ms >= 0) {
+        return virtual_ms;
+    }
+    return (int64_t)(host_now_ns() / 1000000u);
+}
+
+void host_time_set_ms(int64_t ms) { virtual_ms = ms; }
+
+int32_t k_sleep(k_timeout_t timeout) {
+    slept_ms += timeout.ms;
+    if (virtual_ms >= 0) {
+        virtual_ms += timeout.ms;
+    }
+    return 0;
+}
+
+int64_t host_sleep_ms(void) { return slept_ms; }
+
+int k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    if (delay.ms > 0) {
+        (void)k_sleep(delay);
+    }
+    dwork->work.handler(&dwork->work);
+    return 1;
+}
+
+int k_work_cancel_delayable(struct k_work_delayable *dwork) {
+    (void)dwork;
+    return 0;
+}
+
+int raise_zmk_keycode_state_changed_from_encoded(uint32_t encoded, bool pressed,
+                                                 int64_t timestamp) {
+    hid_stats.events++;
+    if (pressed) {
+        hid_stats.presses++;
+    }
+    if (hid_hook) {
+        hid_hook(encoded, pressed, timestamp, hid_hook_user);
+    }
+    return 0;
+}
+
+void host_hid_set_hook(host_hid_hook_t hook, void *user) {
+    hid_hook = hook;
+    hid_hook_user = user;
+}
+
+void host_hid_get_stats(struct host_hid_stats *out) { *out = hid_stats; }
+
+void host_hid_reset(void) { hid_stats = (struct host_hid_stats){0}; }
+
+static struct {
+    char name[32];
+    uint8_t value[16];
+    size_t len;
+} saved[8];
+
+int settings_save_one(const char *name, const void *value, size_t val_len) {
+    for (size_t i = 0; i < ARRAY_SIZE(saved); i++) {
+        if (!saved[i].name[0] || strcmp(saved[i].name, name) == 0) {
+            if (strlen(name) >= sizeof(saved[i].name) || val_len > sizeof(saved[i].value)) {
+                return -ENOMEM;
+            }
+            strcpy(saved[i].name, name);
+            memcpy(saved[i].value, value, val_len);
+            saved[i].len = val_len;
+            return 0;
+        }
+    }
+    return -ENOMEM;
+}
+
+bool host_settings_get(const char *name, void *value, size_t len) {
+    for (size_t i = 0; i < ARRAY_SIZE(saved) && saved[i].name[0]; i++) {
+        if (strcmp(saved[i].name, name) == 0 && saved[i].len == len) {
+            memcpy(value, saved[i].value, len);
+            return true;
+        }
+    }
+    return false;
+}
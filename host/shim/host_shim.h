@@ -0,0 +1,64 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Host shim: Zephyr/ZMK の代わりに時刻と HID 出力を持つ（host/ 専用）。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct host_hid_stats {
+    uint64_t events;  /* raise_zmk_keycode_state_changed の回数 = HID レポート数 */
+    uint64_t presses;
+};
+
+/* 送られた keycode を受け取る（NULL で外す） */
+typedef void (*host_hid_hook_t)(uint32_t encoded, bool pressed, int64_t timestamp, void *user);
+
+void host_hid_set_hook(host_hid_hook_t hook, void *user);
+void host_hid_get_stats(struct host_hid_stats *out);
+void host_hid_reset(void);
+
+/* k_uptime_get() を仮想時刻に固定する（記録の再生用）。負の値で実時間に戻す */
+void host_time_set_ms(int64_t ms);
+
+/* k_sleep() で「眠った」合計（ms）。host では実際には眠らない */
+int64_t host_sleep_ms(void);
+
+/* CLOCK_MONOTONIC (ns) */
+uint64_t host_now_ns(void);
+
+/*
+ * companion_loopback.c: chord_companion の相手（scripts/chord_companion.py の代わり）。
+ * hook は入力した TEXT の中身（UTF-8、'\b' は Backspace）を受け取る。
+ */
+enum host_companion_mode {
+    HOST_COMPANION_ANSWER, /* 入力してすぐ返事 */
+    HOST_COMPANION_LATE,   /* 入力するが、返事は CANCEL が来てから（返事が遅れた） */
+    HOST_COMPANION_LOST,   /* TEXT を取りこぼし、CANCEL には入力していないと答える */
+    HOST_COMPANION_SILENT, /* 何も答えない（抜かれた） */
+};
+
+typedef void (*host_companion_hook_t)(const char *utf8, size_t len, void *user);
+
+void host_companion_attach(enum host_companion_mode mode, host_companion_hook_t hook,
+                           void *user);
+void host_companion_detach(void);
+
+/* flash_map.c: パーティションの中身と消去の回数。fail_reads なら読み出しを -EIO にする */
+const uint8_t *host_flash_data(uint8_t id, size_t *size);
+uint32_t host_flash_erases(uint8_t id);
+void host_flash_fail_reads(bool fail);
+
+/* settings_save_one() で最後に保存した値。無いか長さが違えば false */
+bool host_settings_get(const char *name, void *value, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
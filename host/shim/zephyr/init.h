@@ -0,0 +1,6 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+/* host には起動処理が無い。テストが自分で呼ぶ */
+#define SYS_INIT(_fn, _level, _prio)                                                              \
+    static int (*const sys_init_##_fn)(void) __attribute__((unused)) = _fn
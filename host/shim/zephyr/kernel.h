@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+typedef struct {
+    int64_t ms;
+} k_timeout_t;
+
+#define K_MSEC(ms) ((k_timeout_t){(ms)})
+#define K_SECONDS(s) K_MSEC((s) * 1000)
+#define K_NO_WAIT K_MSEC(0)
+
+/* host_shim.c: 既定は実時間、host_time_set_ms() 後は仮想時間 */
+int64_t k_uptime_get(void);
+
+/* 実際には眠らない。仮想時間なら進め、眠った時間を数える（host_sleep_ms） */
+int32_t k_sleep(k_timeout_t timeout);
+
+static inline int32_t k_msleep(int32_t ms) { return k_sleep(K_MSEC(ms)); }
+
+/*
+ * k_work_delayable: host では予約した時点で delay だけ眠り（仮想時間なら進め）、
+ * その場で handler を呼ぶ。handler からの再予約は入れ子で動く。
+ */
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+
+struct k_work {
+    k_work_handler_t handler;
+};
+
+struct k_work_delayable {
+    struct k_work work;
+};
+
+#define K_WORK_DELAYABLE_DEFINE(_name, _handler)                                                   \
+    struct k_work_delayable _name = {.work = {.handler = (_handler)}}
+
+static inline void k_work_init_delayable(struct k_work_delayable *dwork,
+                                         k_work_handler_t handler) {
+    dwork->work.handler = handler;
+}
+
+static inline struct k_work_delayable *k_work_delayable_from_work(struct k_work *work) {
+    return (struct k_work_delayable *)work;
+}
+
+int k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay);
+int k_work_cancel_delayable(struct k_work_delayable *dwork);
+
+static inline int k_work_reschedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    return k_work_schedule(dwork, delay);
+}
+
+/* handler はその場で終わるので、予約が残っていることは無い */
+static inline bool k_work_delayable_is_pending(const struct k_work_delayable *dwork) {
+    (void)dwork;
+    return false;
+}
+
+/* スレッドは 1 つだけなので lock は何もしない。sem は数えるだけで待たない */
+struct k_mutex {
+    int unused;
+};
+
+#define K_MUTEX_DEFINE(_name) struct k_mutex _name
+
+static inline int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout) {
+    (void)mutex;
+    (void)timeout;
+    return 0;
+}
+
+static inline int k_mutex_unlock(struct k_mutex *mutex) {
+    (void)mutex;
+    return 0;
+}
+
+struct k_sem {
+    unsigned int count;
+    unsigned int limit;
+};
+
+#define K_FOREVER K_MSEC(-1)
+#define K_SEM_DEFINE(_name, _initial, _limit) struct k_sem _name = {(_initial), (_limit)}
+
+static inline int k_sem_take(struct k_sem *sem, k_timeout_t timeout) {
+    (void)timeout;
+    if (!sem->count) {
+        return -EAGAIN;
+    }
+    sem->count--;
+    return 0;
+}
+
+static inline void k_sem_give(struct k_sem *sem) {
+    if (sem->count < sem->limit) {
+        sem->count++;
+    }
+}
@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+#include <stddef.h>
+#include <sys/types.h>
+
+typedef ssize_t (*settings_read_cb)(void *cb_arg, void *data, size_t len);
+
+/* host_shim.c: 最後に保存した値を覚えるだけ（host_settings_get） */
+int settings_save_one(const char *name, const void *value, size_t val_len);
+
+/* 起動時の読み込みは無い。handler は置くだけ */
+#define SETTINGS_STATIC_HANDLER_DEFINE(_hname, _tree, _get, _set, _commit, _export)               \
+    static const struct {                                                                          \
+        const char *tree;                                                                          \
+        int (*set)(const char *, size_t, settings_read_cb, void *);                                \
+    } settings_handler_##_hname __attribute__((unused)) = {(_tree), (_set)}
@@ -0,0 +1,4 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+/* host では CONFIG_SHELL を立てない（コマンドは #if IS_ENABLED(CONFIG_SHELL) の中） */
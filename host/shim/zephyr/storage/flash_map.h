@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * flash_map.c: RAM の上の NOR flash。書き込みは 1 -> 0 にしかできず（消していない所に
+ * 書くと AND になる）、消去で 0xFF に戻る。パーティションは下の 2 つだけ。
+ */
+enum {
+    HOST_PARTITION_mejiro_dict_partition,
+    HOST_PARTITION_mejiro_dict_alt_partition,
+    HOST_PARTITION_COUNT,
+};
+
+#define FIXED_PARTITION_EXISTS(label) 1
+#define FIXED_PARTITION_ID(label) HOST_PARTITION_##label
+
+struct flash_area {
+    uint8_t fa_id;
+    off_t fa_off;
+    size_t fa_size;
+};
+
+int flash_area_open(uint8_t id, const struct flash_area **fa);
+void flash_area_close(const struct flash_area *fa);
+int flash_area_read(const struct flash_area *fa, off_t off, void *dst, size_t len);
+int flash_area_write(const struct flash_area *fa, off_t off, const void *src, size_t len);
+int flash_area_erase(const struct flash_area *fa, off_t off, size_t len);
+uint32_t flash_area_align(const struct flash_area *fa);
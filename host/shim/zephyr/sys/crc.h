@@ -0,0 +1,33 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* CRC-16/XMODEM（Zephyr の crc16_itu_t と同じ） */
+static inline uint16_t crc16_itu_t(uint16_t seed, const uint8_t *src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        seed = (uint16_t)((seed >> 8) | (seed << 8));
+        seed ^= src[i];
+        seed ^= (seed & 0xffu) >> 4;
+        seed ^= seed << 12;
+        seed ^= (seed & 0xffu) << 5;
+    }
+    return seed;
+}
+
+/* CRC-32/ISO-HDLC（zlib.crc32、Zephyr の crc32_ieee_update と同じ） */
+static inline uint32_t crc32_ieee_update(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static inline uint32_t crc32_ieee(const uint8_t *data, size_t len) {
+    return crc32_ieee_update(0, data, len);
+}
@@ -0,0 +1,6 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+#include <stdint.h>
+
+static inline int u32_count_trailing_zeros(uint32_t x) { return x ? __builtin_ctz(x) : 32; }
@@ -0,0 +1,4 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+#define BUILD_ASSERT(cond, ...) _Static_assert(cond, "" __VA_ARGS__)
@@ -0,0 +1,12 @@
+/* SPDX-License-Identifier: MIT */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ZMK でも zmk/keys.h 経由でキー名が見える */
+#include <dt-bindings/zmk/keys.h>
+
+/* host_shim.c: HID レポート 1 回として数え、フックがあれば渡す */
+int raise_zmk_keycode_state_changed_from_encoded(uint32_t encoded, bool pressed,
+                                                 int64_t timestamp);
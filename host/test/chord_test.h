@@ -0,0 +1,51 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * host/test の小さな assert。ctest から 1 ファイル 1 実行ファイルで走らせる。
+ * 失敗は stderr に出して数え、test_result() が 0 / 1 を返す（main の戻り値）。
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+
+static int test_failures;
+
+#define CHECK(cond)                                                                               \
+    do {                                                                                          \
+        if (!(cond)) {                                                                            \
+            fprintf(stderr, "%s:%d: CHECK(%s)\n", __FILE__, __LINE__, #cond);                     \
+            test_failures++;                                                                      \
+        }                                                                                         \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                \
+    do {                                                                                          \
+        const long long a_ = (long long)(actual);                                                 \
+        const long long e_ = (long long)(expected);                                               \
+        if (a_ != e_) {                                                                           \
+            fprintf(stderr, "%s:%d: %s = %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, \
+                    e_);                                                                          \
+            test_failures++;                                                                      \
+        }                                                                                         \
+    } while (0)
+
+#define CHECK_STR(actual, expected)                                                               \
+    do {                                                                                          \
+        const char *a_ = (actual);                                                                \
+        const char *e_ = (expected);                                                              \
+        if (strcmp(a_, e_) != 0) {                                                                \
+            fprintf(stderr, "%s:%d: %s = \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, \
+                    a_, e_);                                                                      \
+            test_failures++;                                                                      \
+        }                                                                                         \
+    } while (0)
+
+static inline int test_result(const char *name) {
+    if (test_failures) {
+        fprintf(stderr, "%s: %d failed\n", name, test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
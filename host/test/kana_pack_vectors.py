@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+test_kana_pack の入力: scripts/mejiro_dictc.py の pack_text で詰めた行を書く。
+
+    python3 host/test/kana_pack_vectors.py -o vectors.txt corpus.txt...
+
+1 行 "<hex>\\t<text>"。corpus の行と、符号表の端（カタカナ、エスケープ、ASCII、
+2 かな）を通る文字列。
+"""
+
+import argparse
+import os
+import sys
+
+sys.dont_write_bytecode = True
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "..", "scripts"))
+
+from mejiro_dictc import BIGRAMS, pack_text  # noqa: E402
+
+EXTRA = [
+    "ぁゖ",
+    "ァヶヴ",
+    "ー、。「」・",
+    "漢字かな交じり",
+    "Mejiro 2.0!",
+    "".join(BIGRAMS),
+]
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("corpus", nargs="*")
+    ap.add_argument("-o", "--output", required=True)
+    args = ap.parse_args(argv)
+
+    texts = list(EXTRA)
+    for path in args.corpus:
+        with open(path, encoding="utf-8") as f:
+            texts += [line.strip() for line in f if line.strip()]
+    with open(args.output, "w", encoding="utf-8") as out:
+        for text in texts:
+            out.write("%s\t%s\n" % (pack_text(text).hex(), text))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,258 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * chord_engine: Mejiro と Naginata の adapter（behavior_mejiro.c / behavior_naginata.c と
+ * 同じ形の ops）に同じ打鍵を入れ、同じストロークが同じ時刻で確定することを見る。
+ * Naginata は確定したストロークを表で引いて、出た keycode と時刻も見る。engine の timer と統計も。
+ */
+#include <dt-bindings/zmk/keys.h>
+
+#include <chord/chord_engine.h>
+#include <chord/kana_out.h>
+#include <host_shim.h>
+#include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_shift.h>
+
+#include "chord_test.h"
+
+#define WINDOW_MS 30
+
+/* 打鍵は 'a' 以降の 1 文字のキーで書く。Mejiro は stroke code の bit、Naginata は keycode */
+static const uint32_t ng_keys[] = {J, F, K, T};
+
+static uint32_t mejiro_key(char k) { return 1UL << (k - 'a'); }
+static uint32_t naginata_key(char k) { return ng_keys[k - 'a']; }
+
+/* 確定したストロークを "ab@0-65|c@70-120" の形で並べる（押下順のキー @ 最初の押下 - 最後の離上） */
+struct record {
+    char text[128];
+};
+
+static struct record mejiro_rec, naginata_rec;
+
+static void record(struct record *r, const struct chord_stroke *stroke, char (*name)(uint32_t)) {
+    size_t n = strlen(r->text);
+
+    if (n) {
+        r->text[n++] = '|';
+    }
+    for (uint8_t i = 0; i < stroke->count; i++) {
+        r->text[n++] = name(stroke->keys[i]);
+    }
+    snprintf(&r->text[n], sizeof(r->text) - n, "@%lld-%lld", (long long)stroke->first_press,
+             (long long)stroke->last_release);
+}
+
+static char mejiro_name(uint32_t key) {
+    for (char k = 'a'; k < 'a' + 32; k++) {
+        if (mejiro_key(k) == key) {
+            return k;
+        }
+    }
+    return '?';
+}
+
+static char naginata_name(uint32_t key) {
+    for (size_t i = 0; i < sizeof(ng_keys) / sizeof(ng_keys[0]); i++) {
+        if (ng_keys[i] == key) {
+            return (char)('a' + i);
+        }
+    }
+    return '?';
+}
+
+/* ---- adapters ---- */
+
+static void mejiro_commit(struct chord_engine *e, const struct chord_stroke *stroke) {
+    (void)e;
+    record(&mejiro_rec, stroke, mejiro_name);
+}
+
+static int64_t expired_at = -1;
+
+static void mejiro_expire(struct chord_engine *e, int64_t now) {
+    (void)e;
+    expired_at = now;
+}
+
+static const struct chord_engine_ops mejiro_ops = {
+    .name = "mejiro",
+    .commit = mejiro_commit,
+    .expire = mejiro_expire,
+};
+
+static NGListArray nginput;
+
+static void type_keys(const uint32_t *keys, uint8_t count, int64_t ts) {
+    NGList one;
+
+    initializeList(&one);
+    for (uint8_t i = 0; i < count; i++) {
+        (void)addToList(&one, keys[i]);
+    }
+    (void)addToListArray(&nginput, &one);
+    (void)naginata_type_from_nglistarray(&nginput, ts);
+}
+
+static bool naginata_intercept_press(struct chord_engine *e, uint32_t key, int64_t ts) {
+    return naginata_shift_press(key, chord_engine_pending(e) > 0, ts);
+}
+
+static bool naginata_intercept_release(struct chord_engine *e, uint32_t key, int64_t ts) {
+    (void)e;
+    return naginata_shift_release(key, ts);
+}
+
+static void naginata_commit(struct chord_engine *e, const struct chord_stroke *stroke) {
+    (void)e;
+    record(&naginata_rec, stroke, naginata_name);
+    kana_out_call(type_keys, stroke->keys, stroke->count, stroke->first_press);
+}
+
+static const struct chord_engine_ops naginata_ops = {
+    .name = "naginata",
+    .intercept_press = naginata_intercept_press,
+    .intercept_release = naginata_intercept_release,
+    .commit = naginata_commit,
+};
+
+/* ---- HID ---- */
+
+static char typed[64];
+static int64_t typed_at[64];
+static size_t typed_len;
+
+static void hid_hook(uint32_t encoded, bool pressed, int64_t timestamp, void *user) {
+    (void)user;
+    if (!pressed || typed_len + 1 >= sizeof(typed)) {
+        return;
+    }
+    typed_at[typed_len] = timestamp;
+    typed[typed_len++] = encoded >= A && encoded <= Z ? (char)('a' + (encoded - A))
+                         : encoded == LEFT            ? '<'
+                                                      : '?';
+    typed[typed_len] = '\0';
+}
+
+/* ---- scenarios ---- */
+
+/* op '+' は押下、'-' は離上。at はキーを読んだ時刻 */
+struct step {
+    char op;
+    char key;
+    int64_t at;
+};
+
+static struct chord_engine mejiro, naginata;
+
+static void run(enum chord_commit_mode mode, const struct step *steps, size_t n) {
+    const struct chord_engine_config cfg = {
+        .window_ms = WINDOW_MS,
+        .gap_ms = 0,
+        .commit_mode = mode,
+    };
+
+    chord_engine_init(&mejiro, &mejiro_ops, &cfg);
+    chord_engine_init(&naginata, &naginata_ops, &cfg);
+    naginata_shift_init(type_keys);
+    initializeListArray(&nginput);
+    mejiro_rec.text[0] = '\0';
+    naginata_rec.text[0] = '\0';
+    typed_len = 0;
+    typed[0] = '\0';
+
+    for (size_t i = 0; i < n; i++) {
+        if (steps[i].op == '+') {
+            chord_engine_press(&mejiro, mejiro_key(steps[i].key), steps[i].at);
+            chord_engine_press(&naginata, naginata_key(steps[i].key), steps[i].at);
+        } else {
+            chord_engine_release(&mejiro, mejiro_key(steps[i].key), steps[i].at);
+            chord_engine_release(&naginata, naginata_key(steps[i].key), steps[i].at);
+        }
+    }
+    chord_engine_flush(&mejiro);
+    chord_engine_flush(&naginata);
+
+    CHECK_STR(naginata_rec.text, mejiro_rec.text);
+    CHECK_EQ(naginata.stats.strokes, mejiro.stats.strokes);
+    CHECK_EQ(naginata.stats.presses, mejiro.stats.presses);
+    CHECK_EQ(naginata.stats.releases, mejiro.stats.releases);
+}
+
+#define RUN(mode, ...)                                                                            \
+    run(mode, (const struct step[]){__VA_ARGS__},                                                 \
+        sizeof((const struct step[]){__VA_ARGS__}) / sizeof(struct step))
+
+static void test_chord(void) {
+    for (int mode = CHORD_COMMIT_ROLLOVER; mode <= CHORD_COMMIT_ALL_RELEASED; mode++) {
+        RUN(mode, {'+', 'a', 1000}, {'+', 'b', 1005}, {'-', 'a', 1060}, {'-', 'b', 1065});
+        CHECK_STR(mejiro_rec.text, "ab@1000-1065");
+        /* J+F -> が。出力の時刻はストロークの最初の押下 */
+        CHECK_STR(typed, "ga");
+        CHECK_EQ(typed_at[0], 1000);
+        CHECK_EQ(typed_at[1], 1000);
+    }
+}
+
+static void test_rollover(void) {
+    RUN(CHORD_COMMIT_ROLLOVER, {'+', 'a', 0}, {'+', 'b', 5}, {'-', 'a', 60}, {'+', 'c', 70},
+        {'-', 'b', 80}, {'-', 'c', 120});
+    CHECK_STR(mejiro_rec.text, "ab@0-80|c@70-120");
+    CHECK_STR(typed, "gai");
+
+    /* 窓より後の押下は、離上の時に別のストロークに切り出す */
+    RUN(CHORD_COMMIT_ROLLOVER, {'+', 'a', 0}, {'+', 'b', 5}, {'+', 'c', 60}, {'-', 'a', 70},
+        {'-', 'b', 75}, {'-', 'c', 120});
+    CHECK_STR(mejiro_rec.text, "ab@0-75|c@60-120");
+    CHECK_STR(typed, "gai");
+}
+
+/* 編集キーの関数にもストロークの時刻が渡る（naginata_func.c に時刻の状態は無い） */
+static void test_func_timestamp(void) {
+    RUN(CHORD_COMMIT_ROLLOVER, {'+', 'd', 2000}, {'-', 'd', 2040}, {'+', 'a', 2100},
+        {'-', 'a', 2140});
+    CHECK_STR(mejiro_rec.text, "d@2000-2040|a@2100-2140");
+    CHECK_STR(typed, "<a");
+    CHECK_EQ(typed_at[0], 2000);
+    CHECK_EQ(typed_at[1], 2100);
+}
+
+/* 期限の timer（split の合わせ待ちなど）も engine が持つ。host の work はその場で走る */
+static void test_timer(void) {
+    host_time_set_ms(500);
+    chord_engine_arm(&mejiro, 520);
+    CHECK_EQ(expired_at, 520);
+    expired_at = -1;
+    chord_engine_arm(&mejiro, -1);
+    CHECK_EQ(expired_at, -1);
+    host_time_set_ms(-1);
+}
+
+/*
+ * engine の統計は commit が返るまで、HID に出るまでは kana_out が tap ごとに数える。
+ * 読んだのが 3000、処理したのが 3012 なら、どちらも 12 ms
+ */
+static void test_stats(void) {
+    struct kana_out_stats before, after;
+
+    kana_out_get_stats(&before);
+    host_time_set_ms(3012);
+    RUN(CHORD_COMMIT_ROLLOVER, {'+', 'a', 3000}, {'-', 'a', 3005});
+    host_time_set_ms(-1);
+    CHECK_STR(typed, "a");
+    kana_out_get_stats(&after);
+    CHECK_EQ(after.taps - before.taps, 1);
+    CHECK_EQ(after.hid_ms_sum - before.hid_ms_sum, 12);
+    CHECK_EQ(naginata.stats.commit_ms_sum, 12);
+    CHECK_EQ(naginata.stats.commit_ms_max, 12);
+}
+
+int main(void) {
+    host_hid_set_hook(hid_hook, NULL);
+    test_chord();
+    test_rollover();
+    test_func_timestamp();
+    test_timer();
+    test_stats();
+    return test_result("chord_engine");
+}
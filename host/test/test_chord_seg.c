@@ -0,0 +1,165 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * chord_seg: 離上順とタイミングでのストロークの切り分け（chord_seg.h の規則）。
+ */
+#include <chord/chord_seg.h>
+
+#include "chord_test.h"
+
+#define SPLIT_MS 30
+
+/* 確定したストロークを "AB|C" の形で並べる（キーは 'A' 以降の 1 文字） */
+static char got[64];
+
+static void on_commit(const struct chord_stroke *stroke, void *user_data) {
+    (void)user_data;
+    size_t n = strlen(got);
+
+    if (n) {
+        got[n++] = '|';
+    }
+    for (uint8_t i = 0; i < stroke->count; i++) {
+        got[n++] = (char)stroke->keys[i];
+    }
+    got[n] = '\0';
+}
+
+static void start(struct chord_seg *seg, enum chord_commit_mode mode) {
+    got[0] = '\0';
+    chord_seg_init(seg, SPLIT_MS, on_commit, NULL);
+    chord_seg_set_mode(seg, mode);
+}
+
+static void test_single(void) {
+    struct chord_seg seg;
+
+    start(&seg, CHORD_COMMIT_ROLLOVER);
+    chord_seg_press(&seg, 'A', 0);
+    chord_seg_press(&seg, 'B', 5);
+    chord_seg_release(&seg, 'A', 80);
+    CHECK_STR(got, "");
+    chord_seg_release(&seg, 'B', 85);
+    CHECK_STR(got, "AB");
+    CHECK_EQ(seg.stats.strokes, 1);
+    CHECK_EQ(seg.count, 0);
+}
+
+/* 1 つ離した後の押下は次のストローク */
+static void test_release_order(void) {
+    struct chord_seg seg;
+
+    start(&seg, CHORD_COMMIT_ROLLOVER);
+    chord_seg_press(&seg, 'A', 0);
+    chord_seg_press(&seg, 'B', 5);
+    chord_seg_release(&seg, 'A', 80);
+    chord_seg_press(&seg, 'C', 90);
+    CHECK_EQ(seg.count, 2);
+    chord_seg_release(&seg, 'B', 100);
+    CHECK_STR(got, "AB");
+    chord_seg_release(&seg, 'C', 150);
+    CHECK_STR(got, "AB|C");
+    CHECK_EQ(seg.stats.splits, 0);
+    CHECK_EQ(seg.stats.forced, 0);
+}
+
+/* 最初の離上の直前に、遅れて押されたキーは次のストロークへ */
+static void test_timing_split(void) {
+    struct chord_seg seg;
+
+    start(&seg, CHORD_COMMIT_ROLLOVER);
+    chord_seg_press(&seg, 'A', 0);
+    chord_seg_press(&seg, 'B', 5);
+    chord_seg_press(&seg, 'C', 60);
+    chord_seg_release(&seg, 'A', 70);
+    CHECK_EQ(seg.stats.splits, 1);
+    CHECK_EQ(seg.count, 2);
+    chord_seg_release(&seg, 'B', 75);
+    CHECK_STR(got, "AB");
+    chord_seg_release(&seg, 'C', 120);
+    CHECK_STR(got, "AB|C");
+
+    /* split_ms より前に押したキーは同じストローク */
+    start(&seg, CHORD_COMMIT_ROLLOVER);
+    chord_seg_press(&seg, 'A', 0);
+    chord_seg_press(&seg, 'B', 20);
+    chord_seg_release(&seg, 'A', 40);
+    chord_seg_release(&seg, 'B', 45);
+    CHECK_STR(got, "AB");
+    CHECK_EQ(seg.stats.splits, 0);
+
+    /* 離上の split_ms より前に押したキーも同じストローク */
+    start(&seg, CHORD_COMMIT_ROLLOVER);
+    chord_seg_press(&seg, 'A', 0);
+    chord_seg_press(&seg, 'B', 40);
+    chord_seg_release(&seg, 'A', 100);
+    chord_seg_release(&seg, 'B', 105);
+    CHECK_STR(got, "AB");
+}
+
+/* 新しいストロークが先に全離上: 古い方を強制確定（残りの離上は無視） */
+static void test_forced(void) {
+    struct chord_seg seg;
+
+    start(&seg, CHORD_COMMIT_ROLLOVER);
+    chord_seg_press(&seg, 'A', 0);
+    chord_seg_press(&seg, 'B', 5);
+    chord_seg_release(&seg, 'A', 80);
+    chord_seg_press(&seg, 'C', 90);
+    chord_seg_release(&seg, 'C', 140);
+    CHECK_STR(got, "AB|C");
+    CHECK_EQ(seg.stats.forced, 1);
+    chord_seg_release(&seg, 'B', 150);
+    CHECK_STR(got, "AB|C");
+    CHECK_EQ(seg.stats.strokes, 2);
+}
+
+/* all-released: 全キーを離すまで 1 ストローク */
+static void test_all_released(void) {
+    struct chord_seg seg;
+
+    start(&seg, CHORD_COMMIT_ALL_RELEASED);
+    chord_seg_press(&seg, 'A', 0);
+    chord_seg_press(&seg, 'B', 5);
+    chord_seg_release(&seg, 'A', 80);
+    chord_seg_press(&seg, 'C', 90);
+    chord_seg_release(&seg, 'B', 100);
+    CHECK_STR(got, "");
+    chord_seg_release(&seg, 'C', 150);
+    CHECK_STR(got, "ABC");
+}
+
+/* 保留が溢れたら古い順に確定し、flush で全部出る */
+static void test_overflow_flush(void) {
+    struct chord_seg seg;
+    char expected[64] = "";
+
+    start(&seg, CHORD_COMMIT_ROLLOVER);
+    /* 1 キーを押したまま残したストロークを、保留の数より 1 つ多く作る */
+    for (int i = 0; i <= CHORD_SEG_MAX_PENDING; i++) {
+        const char a = (char)('A' + 2 * i);
+        const char b = (char)(a + 1);
+        const int64_t t = 100 * i;
+
+        chord_seg_press(&seg, (uint32_t)a, t);
+        chord_seg_press(&seg, (uint32_t)b, t + 5);
+        chord_seg_release(&seg, (uint32_t)a, t + 50);
+        snprintf(&expected[strlen(expected)], 4, "%s%c%c", i ? "|" : "", a, b);
+    }
+    CHECK_STR(got, "AB");
+    CHECK_EQ(seg.count, CHORD_SEG_MAX_PENDING);
+    chord_seg_flush(&seg);
+    CHECK_EQ(seg.count, 0);
+    CHECK_STR(got, expected);
+    CHECK_EQ(seg.stats.forced, CHORD_SEG_MAX_PENDING + 1);
+}
+
+int main(void) {
+    test_single();
+    test_release_order();
+    test_timing_split();
+    test_forced();
+    test_all_released();
+    test_overflow_flush();
+    return test_result("chord_seg");
+}
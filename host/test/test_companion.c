@@ -0,0 +1,114 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * chord_companion: companion_loopback.c を相手に、返事が来ない時の CANCEL の往復を見る。
+ * どの場合も、companion が入力した文字と keycode で送った文字を合わせて 1 回だけ出る。
+ */
+#include <zephyr/sys/util.h>
+
+#include <dt-bindings/zmk/keys.h>
+
+#include <chord/chord_companion.h>
+#include <chord/kana_out.h>
+#include <host_shim.h>
+
+#include "chord_test.h"
+
+/* companion が入力した文字と、keycode（ローマ字） */
+static char typed[64];
+static char keys[64];
+
+static void companion_hook(const char *utf8, size_t len, void *user) {
+    (void)user;
+    strncat(typed, utf8, MIN(len, sizeof(typed) - strlen(typed) - 1));
+}
+
+static void hid_hook(uint32_t encoded, bool pressed, int64_t timestamp, void *user) {
+    const size_t n = strlen(keys);
+
+    (void)timestamp;
+    (void)user;
+    if (pressed && n + 1 < sizeof(keys)) {
+        keys[n] = encoded >= A && encoded <= Z ? (char)('a' + (encoded - A)) : '?';
+        keys[n + 1] = '\0';
+    }
+}
+
+static struct chord_companion_stats before;
+
+static void attach(enum host_companion_mode mode) {
+    typed[0] = keys[0] = '\0';
+    host_companion_attach(mode, companion_hook, NULL);
+    chord_companion_get_stats(&before);
+}
+
+static struct chord_companion_stats delta(void) {
+    struct chord_companion_stats now;
+
+    chord_companion_get_stats(&now);
+    return (struct chord_companion_stats){
+        .frames = now.frames - before.frames,
+        .acks = now.acks - before.acks,
+        .dropped = now.dropped - before.dropped,
+        .fallbacks = now.fallbacks - before.fallbacks,
+    };
+}
+
+static void test_answer(void) {
+    attach(HOST_COMPANION_ANSWER);
+    CHECK(kana_out_send("か", 0));
+    CHECK_STR(typed, "か");
+    CHECK_STR(keys, "");
+    CHECK_EQ(delta().acks, 1);
+    CHECK(chord_companion_active());
+}
+
+/* 入力したのに返事が遅れた: CANCEL の後に届いた返事で入力済みとわかり、送り直さない */
+static void test_late_ack(void) {
+    attach(HOST_COMPANION_LATE);
+    CHECK(kana_out_send("か", 0));
+    CHECK(kana_out_send("き", 0));
+    CHECK_STR(typed, "かき");
+    CHECK_STR(keys, "");
+    CHECK_EQ(delta().frames, 2);
+    CHECK_EQ(delta().acks, 2);
+    CHECK_EQ(delta().fallbacks, 0);
+    CHECK(chord_companion_active());
+}
+
+/* companion が取りこぼした: 入力していないと答えたので keycode で送り直し、keycode に戻る */
+static void test_lost(void) {
+    attach(HOST_COMPANION_LOST);
+    CHECK(kana_out_send("か", 0));
+    CHECK_STR(typed, "");
+    CHECK_STR(keys, "ka");
+    CHECK_EQ(delta().fallbacks, 1);
+    CHECK(!chord_companion_active());
+    CHECK(kana_out_send("き", 0));
+    CHECK_STR(keys, "kaki");
+    CHECK_EQ(delta().frames, 1);
+}
+
+/* 何も答えない: 入力されたか分からない文字は送り直さず捨てる */
+static void test_silent(void) {
+    attach(HOST_COMPANION_SILENT);
+    CHECK(kana_out_send("か", 0));
+    CHECK_STR(typed, "");
+    CHECK_STR(keys, "");
+    CHECK_EQ(delta().dropped, 1);
+    CHECK_EQ(delta().fallbacks, 1);
+    CHECK(!chord_companion_active());
+    CHECK(kana_out_send("き", 0));
+    CHECK_STR(keys, "ki");
+}
+
+int main(void) {
+    host_time_set_ms(0);
+    host_hid_set_hook(hid_hook, NULL);
+    test_answer();
+    test_late_ack();
+    test_lost();
+    test_silent();
+    host_companion_detach();
+    return test_result("companion");
+}
@@ -0,0 +1,219 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * mejiro_dict_update.c: BEGIN / DATA / END のフレームを流し、CRC の検査と断る場合、
+ * slot の切り替えを見る。flash は shim/flash_map.c（RAM）、辞書の中身の検査
+ * （mejiro_flash_dict_open）はここで差し替える。
+ */
+#include <errno.h>
+
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#include <host_shim.h>
+#include <mejiro/mejiro_dict_update.h>
+#include <mejiro/mejiro_flash_dict.h>
+
+#include "chord_test.h"
+
+#define SLOT_B HOST_PARTITION_mejiro_dict_alt_partition
+
+/* ---- mejiro_flash_dict_open ---- */
+
+static int open_result;
+static int opened = -1;
+
+int mejiro_flash_dict_open(uint8_t partition_id) {
+    if (open_result) {
+        return open_result;
+    }
+    opened = partition_id;
+    return 0;
+}
+
+/* ---- frames ---- */
+
+struct resp {
+    int count;
+    uint8_t type;
+    int32_t status;
+    uint32_t value;
+};
+
+static struct resp last;
+
+static int capture(const uint8_t *data, size_t len, void *ctx) {
+    (void)ctx;
+    CHECK_EQ(len, 15);
+    CHECK_EQ(data[0], MJ_UPD_SYNC0);
+    CHECK_EQ(data[1], MJ_UPD_SYNC1);
+    CHECK_EQ(crc16_itu_t(0, &data[2], len - 4), sys_get_le16(&data[len - 2]));
+    last.count++;
+    last.type = data[2];
+    last.status = (int32_t)sys_get_le32(&data[5]);
+    last.value = sys_get_le32(&data[9]);
+    return 0;
+}
+
+static const struct mejiro_dict_update_transport transport = {.write = capture};
+
+/* 1 フレーム送って応答を返す（無ければ count は増えない） */
+static struct resp request(uint8_t type, const uint8_t *payload, uint16_t len) {
+    uint8_t frame[5 + 4 + 256 + 2] = {MJ_UPD_SYNC0, MJ_UPD_SYNC1, type, (uint8_t)len,
+                                      (uint8_t)(len >> 8)};
+
+    memcpy(&frame[5], payload, len);
+    sys_put_le16(crc16_itu_t(0, &frame[2], 3 + len), &frame[5 + len]);
+    last.count = 0;
+    mejiro_dict_update_receive(frame, 7 + len);
+    return last;
+}
+
+static struct resp begin(uint32_t size, uint32_t crc) {
+    uint8_t p[8];
+
+    sys_put_le32(size, &p[0]);
+    sys_put_le32(crc, &p[4]);
+    return request(MJ_UPD_BEGIN, p, sizeof(p));
+}
+
+static struct resp data(uint32_t off, const uint8_t *bytes, uint16_t len) {
+    uint8_t p[4 + 256];
+
+    sys_put_le32(off, p);
+    memcpy(&p[4], bytes, len);
+    return request(MJ_UPD_DATA, p, 4 + len);
+}
+
+static struct resp end(void) { return request(MJ_UPD_END, NULL, 0); }
+
+/* 書き込み単位（256）をまたぐ大きさ */
+static uint8_t image[1000];
+
+static void send_all(void) {
+    for (uint32_t off = 0; off < sizeof(image); off += 200) {
+        const struct resp r = data(off, &image[off], MIN(200, sizeof(image) - off));
+        CHECK_EQ(r.status, 0);
+        CHECK_EQ(r.value, MIN(off + 200, sizeof(image)));
+    }
+}
+
+/* ---- tests ---- */
+
+static void test_upload(void) {
+    const uint32_t crc = crc32_ieee(image, sizeof(image));
+    const uint32_t erases = host_flash_erases(SLOT_B);
+    size_t size;
+
+    struct resp r = request(MJ_UPD_INFO, NULL, 0);
+    CHECK_EQ(r.count, 1);
+    CHECK_EQ(r.type, MJ_UPD_INFO | MJ_UPD_RESP);
+    CHECK_EQ(r.value, 0);
+
+    r = begin(sizeof(image), crc);
+    CHECK_EQ(r.type, MJ_UPD_BEGIN | MJ_UPD_RESP);
+    CHECK_EQ(r.status, 0);
+    CHECK_EQ(r.value, 1);
+    CHECK_EQ(host_flash_erases(SLOT_B), erases + 1);
+
+    send_all();
+    r = end();
+    CHECK_EQ(r.status, 0);
+    CHECK_EQ(r.value, 1);
+    CHECK_EQ(mejiro_dict_update_active_slot(), 1);
+    CHECK_EQ(opened, SLOT_B);
+
+    uint8_t saved = 0;
+    CHECK(host_settings_get("mejiro/dict/active", &saved, 1));
+    CHECK_EQ(saved, 1);
+
+    const uint8_t *mem = host_flash_data(SLOT_B, &size);
+    CHECK(memcmp(mem, image, sizeof(image)) == 0);
+    /* 最後の書き込み単位の残りは 0xFF */
+    CHECK_EQ(mem[sizeof(image)], 0xFF);
+}
+
+/* 応答が遅れて送り直した BEGIN は消し直さず、受け取った所から続ける */
+static void test_begin_retry(void) {
+    const uint32_t crc = crc32_ieee(image, sizeof(image));
+    const uint8_t slot = !mejiro_dict_update_active_slot();
+    const uint32_t erases = host_flash_erases(slot);
+
+    CHECK_EQ(begin(sizeof(image), crc).status, 0);
+    CHECK_EQ(data(0, image, 200).value, 200);
+
+    struct resp r = begin(sizeof(image), crc);
+    CHECK_EQ(r.status, 0);
+    CHECK_EQ(r.value, slot);
+    CHECK_EQ(host_flash_erases(slot), erases + 1);
+
+    /* 最初から送り直すと、続きの offset を返す */
+    r = data(0, image, 200);
+    CHECK_EQ(r.status, -EAGAIN);
+    CHECK_EQ(r.value, 200);
+    for (uint32_t off = 200; off < sizeof(image); off += 200) {
+        CHECK_EQ(data(off, &image[off], 200).status, 0);
+    }
+    CHECK_EQ(end().status, 0);
+    CHECK_EQ(mejiro_dict_update_active_slot(), slot);
+
+    /* 違うイメージの BEGIN は消し直す */
+    const uint8_t next = !slot;
+    const uint32_t next_erases = host_flash_erases(next);
+    CHECK_EQ(begin(sizeof(image), crc).status, 0);
+    CHECK_EQ(begin(sizeof(image) - 1, crc).status, 0);
+    CHECK_EQ(host_flash_erases(next), next_erases + 2);
+    CHECK_EQ(request(MJ_UPD_ABORT, NULL, 0).status, 0);
+}
+
+static void test_reject(void) {
+    const uint8_t active = mejiro_dict_update_active_slot();
+    const uint32_t crc = crc32_ieee(image, sizeof(image));
+
+    /* BEGIN の前の DATA / END */
+    CHECK_EQ(data(0, image, 16).status, -EINVAL);
+    CHECK_EQ(end().status, -EINVAL);
+
+    /* 壊れたフレームには答えない */
+    uint8_t frame[7] = {MJ_UPD_SYNC0, MJ_UPD_SYNC1, MJ_UPD_INFO, 0, 0, 0x12, 0x34};
+    last.count = 0;
+    mejiro_dict_update_receive(frame, sizeof(frame));
+    CHECK_EQ(last.count, 0);
+
+    CHECK_EQ(begin(8192 + 1, crc).status, -EFBIG);
+    CHECK_EQ(request(MJ_UPD_BEGIN, image, 4).status, -EINVAL);
+    CHECK_EQ(request(0x7f, NULL, 0).status, -ENOTSUP);
+
+    /* 大きさを超える DATA、足りないままの END */
+    CHECK_EQ(begin(100, crc).status, 0);
+    CHECK_EQ(data(0, image, 101).status, -EFBIG);
+    CHECK_EQ(data(0, image, 50).status, 0);
+    CHECK_EQ(end().status, -EINVAL);
+
+    /* CRC が合わなければ切り替えない */
+    CHECK_EQ(begin(sizeof(image), crc ^ 1).status, 0);
+    send_all();
+    CHECK_EQ(end().status, -EBADMSG);
+    CHECK_EQ(mejiro_dict_update_active_slot(), active);
+
+    /* 辞書として開けなければ元の slot のまま */
+    CHECK_EQ(begin(sizeof(image), crc).status, 0);
+    send_all();
+    open_result = -EILSEQ;
+    CHECK_EQ(end().status, -EILSEQ);
+    open_result = 0;
+    CHECK_EQ(mejiro_dict_update_active_slot(), active);
+}
+
+int main(void) {
+    for (size_t i = 0; i < sizeof(image); i++) {
+        image[i] = (uint8_t)(i * 7 + i / 256);
+    }
+    mejiro_dict_update_set_transport(&transport);
+    test_upload();
+    test_begin_retry();
+    test_reject();
+    return test_result("dict_update");
+}
@@ -0,0 +1,160 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * mejiro_flash_dict.c: 小さな辞書イメージを shim/flash_map.c に書いて開き、hot table /
+ * キャッシュ / ページ読みで引けること、読めなかったページを「無い」と覚えないこと、
+ * 開けないイメージでは今の辞書のままなことを見る。
+ */
+#include <errno.h>
+
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+#include <host_shim.h>
+#include <mejiro/mejiro_flash_dict.h>
+
+#include "chord_test.h"
+
+#define SLOT_A HOST_PARTITION_mejiro_dict_partition
+#define SLOT_B HOST_PARTITION_mejiro_dict_alt_partition
+
+#define PAGE 64
+#define BUCKETS 4
+
+#define HOT_CODE 0x000111
+#define KA_CODE 0x000222 /* か（kana_pack 0x8A） */
+#define MISSING_CODE 0x000333
+
+static uint8_t image[(BUCKETS + 1) * PAGE];
+
+static uint32_t bucket_of(uint32_t code) { return (code * 2654435761U) >> (32 - 2); }
+
+/* { u16 count, { u24 code; u8 len; packed }... } に 1 件足す */
+static void add(uint8_t *table, uint32_t code, const char *packed) {
+    uint16_t count = sys_get_le16(table);
+    size_t p = 2;
+
+    for (uint16_t i = 0; i < count; i++) {
+        p += 4 + table[p + 3];
+    }
+    table[p] = (uint8_t)code;
+    table[p + 1] = (uint8_t)(code >> 8);
+    table[p + 2] = (uint8_t)(code >> 16);
+    table[p + 3] = (uint8_t)strlen(packed);
+    memcpy(&table[p + 4], packed, strlen(packed));
+    sys_put_le16(count + 1, table);
+}
+
+static void build(uint16_t version) {
+    struct mejiro_dict_header h = {
+        .magic = MEJIRO_DICT_MAGIC,
+        .version = version,
+        .page_size = PAGE,
+        .bucket_count = BUCKETS,
+        .entry_count = 3,
+    };
+
+    memset(image, 0xFF, sizeof(image));
+    for (int b = 0; b <= BUCKETS; b++) {
+        sys_put_le16(0, b ? &image[b * PAGE] : &image[sizeof(h)]);
+    }
+    add(&image[sizeof(h)], HOT_CODE, "ka");
+    add(&image[(bucket_of(KA_CODE) + 1) * PAGE], KA_CODE, "\x8a");
+    add(&image[(bucket_of(0x000444) + 1) * PAGE], 0x000444, "ki");
+    h.crc32 = crc32_ieee(&image[sizeof(h)], sizeof(image) - sizeof(h));
+    memcpy(image, &h, sizeof(h));
+}
+
+static void write_image(uint8_t id) {
+    const struct flash_area *fa;
+
+    CHECK_EQ(flash_area_open(id, &fa), 0);
+    CHECK_EQ(flash_area_erase(fa, 0, fa->fa_size), 0);
+    CHECK_EQ(flash_area_write(fa, 0, image, sizeof(image)), 0);
+}
+
+static struct mejiro_flash_dict_stats stats(void) {
+    struct mejiro_flash_dict_stats st;
+
+    mejiro_flash_dict_get_stats(&st);
+    return st;
+}
+
+static void test_lookup(void) {
+    char out[16];
+
+    build(MEJIRO_DICT_VERSION);
+    write_image(SLOT_A);
+    CHECK_EQ(mejiro_flash_dict_open(SLOT_A), 0);
+
+    CHECK(mejiro_flash_dict_lookup(HOT_CODE, out, sizeof(out)));
+    CHECK_STR(out, "ka");
+    CHECK_EQ(stats().hot_hits, 1);
+    CHECK_EQ(stats().page_reads, 0);
+
+    /* 1 回目はページ読み、2 回目はキャッシュから */
+    CHECK(mejiro_flash_dict_lookup(KA_CODE, out, sizeof(out)));
+    CHECK_STR(out, "か");
+    CHECK(mejiro_flash_dict_lookup(KA_CODE, out, sizeof(out)));
+    CHECK_STR(out, "か");
+    CHECK_EQ(stats().page_reads, 1);
+    CHECK_EQ(stats().cache_hits, 1);
+
+    /* 無いことも覚える */
+    CHECK(!mejiro_flash_dict_lookup(MISSING_CODE, out, sizeof(out)));
+    CHECK(!mejiro_flash_dict_lookup(MISSING_CODE, out, sizeof(out)));
+    CHECK_EQ(stats().page_reads, 2);
+    CHECK_EQ(stats().found, 3);
+
+    /* out に入りきらなければ false */
+    CHECK(!mejiro_flash_dict_lookup(KA_CODE, out, 2));
+    CHECK_EQ(stats().found, 3);
+}
+
+/* 読めなかったページは「無い」とキャッシュしない */
+static void test_read_error(void) {
+    char out[16];
+    const uint32_t reads = stats().page_reads;
+
+    host_flash_fail_reads(true);
+    CHECK(!mejiro_flash_dict_lookup(0x000444, out, sizeof(out)));
+    host_flash_fail_reads(false);
+    CHECK(mejiro_flash_dict_lookup(0x000444, out, sizeof(out)));
+    CHECK_STR(out, "ki");
+    CHECK_EQ(stats().page_reads, reads + 2);
+}
+
+/* 開けないイメージでは今の辞書のまま */
+static void test_bad_image(void) {
+    char out[16];
+
+    build(MEJIRO_DICT_VERSION);
+    image[PAGE + 10] ^= 1;
+    write_image(SLOT_B);
+    CHECK_EQ(mejiro_flash_dict_open(SLOT_B), -EBADMSG);
+    CHECK(mejiro_flash_dict_lookup(HOT_CODE, out, sizeof(out)));
+
+    build(MEJIRO_DICT_VERSION + 1);
+    write_image(SLOT_B);
+    CHECK_EQ(mejiro_flash_dict_open(SLOT_B), -ENOENT);
+
+    /* 読めないのは壊れたイメージとは別 */
+    build(MEJIRO_DICT_VERSION);
+    write_image(SLOT_B);
+    host_flash_fail_reads(true);
+    CHECK_EQ(mejiro_flash_dict_open(SLOT_B), -EIO);
+    host_flash_fail_reads(false);
+    CHECK(mejiro_flash_dict_lookup(KA_CODE, out, sizeof(out)));
+
+    CHECK_EQ(mejiro_flash_dict_open(SLOT_B), 0);
+    CHECK(mejiro_flash_dict_lookup(KA_CODE, out, sizeof(out)));
+    CHECK_STR(out, "か");
+}
+
+int main(void) {
+    test_lookup();
+    test_read_error();
+    test_bad_image();
+    return test_result("flash_dict");
+}
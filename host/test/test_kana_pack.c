@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * kana_pack_decode: scripts/mejiro_dictc.py の pack_text で詰めたものが元に戻るか。
+ *
+ *   test_kana_pack vectors.txt
+ *
+ * vectors.txt は kana_pack_vectors.py が書く（1 行 "<hex>\t<text>"）。
+ */
+#include <stdlib.h>
+
+#include <chord/kana_pack.h>
+
+#include "chord_test.h"
+
+static size_t from_hex(const char *hex, uint8_t *out, size_t out_len) {
+    size_t n = 0;
+
+    while (hex[0] && hex[1] && n < out_len) {
+        const char pair[3] = {hex[0], hex[1], '\0'};
+        out[n++] = (uint8_t)strtoul(pair, NULL, 16);
+        hex += 2;
+    }
+    return n;
+}
+
+static void test_vectors(const char *path) {
+    FILE *f = fopen(path, "r");
+    char line[1024];
+    size_t count = 0;
+
+    if (!f) {
+        perror(path);
+        test_failures++;
+        return;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *text = strchr(line, '\t');
+        uint8_t packed[512];
+        char out[1024];
+
+        if (!text) {
+            continue;
+        }
+        *text++ = '\0';
+        const size_t len = from_hex(line, packed, sizeof(packed));
+        CHECK_EQ(kana_pack_decode(packed, len, out, sizeof(out)), strlen(text));
+        CHECK_STR(out, text);
+        count++;
+    }
+    fclose(f);
+    CHECK(count > 0);
+}
+
+/* 壊れた入力と out 不足は 0（out は NUL 終端） */
+static void test_errors(void) {
+    static const uint8_t hira_a[] = {0x81};               /* あ */
+    static const uint8_t esc_short[] = {0x7F, 0x03, 'x'}; /* 長さが足りない */
+    static const uint8_t kata_bad[] = {0xDC, 0x41};       /* カタカナの後がかなでない */
+    static const uint8_t kata_end[] = {0xDC};
+    static const uint8_t zero[] = {0x00};
+    char out[8];
+
+    CHECK_EQ(kana_pack_decode(hira_a, sizeof(hira_a), out, sizeof(out)), 3);
+    CHECK_STR(out, "あ");
+    CHECK_EQ(kana_pack_decode(hira_a, sizeof(hira_a), out, 3), 0);
+    CHECK_STR(out, "");
+    CHECK_EQ(kana_pack_decode(esc_short, sizeof(esc_short), out, sizeof(out)), 0);
+    CHECK_EQ(kana_pack_decode(kata_bad, sizeof(kata_bad), out, sizeof(out)), 0);
+    CHECK_EQ(kana_pack_decode(kata_end, sizeof(kata_end), out, sizeof(out)), 0);
+    CHECK_EQ(kana_pack_decode(zero, sizeof(zero), out, sizeof(out)), 0);
+    CHECK_EQ(kana_pack_decode(NULL, 0, out, sizeof(out)), 0);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        test_vectors(argv[1]);
+    }
+    test_errors();
+    return test_result("kana_pack");
+}
@@ -0,0 +1,72 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * kana_roman_encode: IME で確実に元のかなに戻る、短い方の綴り（kana_out.h）。
+ */
+#include <chord/kana_out.h>
+
+#include "chord_test.h"
+
+static const struct {
+    const char *kana;
+    const char *roman;
+} cases[] = {
+    {"かな", "kana"},
+    {"カタカナ", "katakana"},
+    {"きって", "kitte"},
+    {"ざっし", "zassi"},
+    {"かんじ", "kanzi"},
+    {"しんや", "sinnya"},
+    {"ほんを", "honwo"},
+    {"じゃ", "ja"},
+    {"きゃ", "kya"},
+    {"しゃ", "sya"},
+    {"ふぁ", "fa"},
+    {"てぃ", "thi"},
+    {"でゅ", "dhu"},
+    {"うぃ", "wi"},
+    {"ゔぁ", "va"},
+    {"ゎ", "xwa"},
+    {"ヶ", "xke"},
+    /* 拗音にまとめるのは子音 + i だけ */
+    {"ぃゃ", "xixya"},
+    {"ゐゃ", "wyixya"},
+    {"いょ", "ixyo"},
+    {"ゔゅ", "vuxyu"},
+    {"ぢょ", "dyo"},
+    {"ぴゅ", "pyu"},
+    /* 末尾の ん / っ は次が分からないので単独で崩れない綴り */
+    {"かん", "kann"},
+    {"きっ", "kixtu"},
+    {"ー、。「」", "-,.[]"},
+    {"abc 1", "abc 1"},
+};
+
+static void test_cases(void) {
+    char out[64];
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const size_t n = kana_roman_encode(cases[i].kana, out, sizeof(out));
+        CHECK_STR(out, cases[i].roman);
+        CHECK_EQ(n, strlen(cases[i].roman));
+    }
+}
+
+static void test_errors(void) {
+    char out[8];
+
+    /* 綴りの無い文字は 0 */
+    CHECK_EQ(kana_roman_encode("漢", out, sizeof(out)), 0);
+    /* out が足りなければ 0、out は NUL 終端 */
+    CHECK_EQ(kana_roman_encode("かきくけこ", out, sizeof(out)), 0);
+    CHECK(memchr(out, '\0', sizeof(out)) != NULL);
+    CHECK_EQ(kana_roman_encode("", out, sizeof(out)), 0);
+    CHECK_STR(out, "");
+    CHECK_EQ(kana_roman_encode(NULL, out, sizeof(out)), 0);
+}
+
+int main(void) {
+    test_cases();
+    test_errors();
+    return test_result("kana_roman");
+}
@@ -0,0 +1,149 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * mejiro_merge（mejiro_core.c）: central の半分（LOCAL）と peripheral の半分（REMOTE）を
+ * 合わせる。出る順番、相手を待ちきれない時の timeout、ロールオーバーで半分が重なる時を見る。
+ */
+#include <mejiro/mejiro_core.h>
+
+#include "chord_test.h"
+
+#define WINDOW_MS 50
+#define TIMEOUT_MS 300
+
+#define L MEJIRO_HALF_LOCAL
+#define R MEJIRO_HALF_REMOTE
+
+/* 出たストロークを "101@70|2@140" の形で並べる（code の 16 進 @ 時刻） */
+static char emitted[256];
+
+static void emit(uint32_t code, int64_t timestamp, void *user_data) {
+    const size_t n = strlen(emitted);
+
+    (void)user_data;
+    snprintf(&emitted[n], sizeof(emitted) - n, "%s%x@%lld", n ? "|" : "", (unsigned)code,
+             (long long)timestamp);
+}
+
+static struct mejiro_merge m;
+
+static void reset(void) {
+    mejiro_merge_init(&m, WINDOW_MS, TIMEOUT_MS, emit, NULL);
+    emitted[0] = '\0';
+}
+
+static void test_order(void) {
+    /* どちらが先に確定しても 1 ストロークに。時刻は後に確定した方 */
+    reset();
+    mejiro_merge_start(&m, L, 0);
+    mejiro_merge_start(&m, R, 10);
+    mejiro_merge_done(&m, R, 0x100, 60);
+    CHECK_STR(emitted, "");
+    mejiro_merge_done(&m, L, 0x001, 70);
+    CHECK_STR(emitted, "101@70");
+
+    reset();
+    mejiro_merge_start(&m, R, 0);
+    mejiro_merge_start(&m, L, 20);
+    mejiro_merge_done(&m, L, 0x001, 60);
+    mejiro_merge_done(&m, R, 0x100, 80);
+    CHECK_STR(emitted, "101@80");
+
+    /* 相手が動いていない片手はすぐ。その後の両手は後に出る */
+    reset();
+    mejiro_merge_start(&m, L, 100);
+    mejiro_merge_done(&m, L, 0x002, 140);
+    CHECK_STR(emitted, "2@140");
+    mejiro_merge_start(&m, R, 200);
+    mejiro_merge_start(&m, L, 205);
+    mejiro_merge_done(&m, L, 0x001, 240);
+    mejiro_merge_done(&m, R, 0x100, 250);
+    CHECK_STR(emitted, "2@140|101@250");
+
+    /* 待っている半分は、同じ手の次のストロークより先に出る */
+    reset();
+    mejiro_merge_start(&m, L, 400);
+    mejiro_merge_start(&m, R, 420);
+    mejiro_merge_done(&m, L, 0x001, 430);
+    mejiro_merge_start(&m, L, 500);
+    mejiro_merge_done(&m, L, 0x002, 530);
+    CHECK_STR(emitted, "1@430|2@530");
+    mejiro_merge_done(&m, R, 0x100, 540);
+    CHECK_STR(emitted, "1@430|2@530|100@540");
+    CHECK_EQ(m.stats.merged, 0);
+    CHECK_EQ(m.stats.single, 3);
+    CHECK_EQ(m.stats.timeouts, 0);
+}
+
+static void test_timeout(void) {
+    reset();
+    CHECK_EQ(mejiro_merge_deadline(&m), -1);
+    mejiro_merge_start(&m, L, 1000);
+    mejiro_merge_start(&m, R, 1010);
+    mejiro_merge_done(&m, L, 0x001, 1040);
+    CHECK_EQ(mejiro_merge_deadline(&m), 1040 + TIMEOUT_MS);
+
+    mejiro_merge_expire(&m, 1040 + TIMEOUT_MS - 1);
+    CHECK_STR(emitted, "");
+    /* 片手として、確定した時刻で出す */
+    mejiro_merge_expire(&m, 1040 + TIMEOUT_MS);
+    CHECK_STR(emitted, "1@1040");
+    CHECK_EQ(m.stats.timeouts, 1);
+    CHECK_EQ(mejiro_merge_deadline(&m), -1);
+
+    /* 遅れて届いた相手の半分も片手で出る */
+    mejiro_merge_done(&m, R, 0x100, 1400);
+    CHECK_STR(emitted, "1@1040|100@1400");
+
+    /* START が落ちた半分は確定時刻を始まりとして合わせる */
+    reset();
+    mejiro_merge_start(&m, L, 2000);
+    mejiro_merge_done(&m, R, 0x100, 2030);
+    mejiro_merge_done(&m, L, 0x001, 2040);
+    CHECK_STR(emitted, "101@2040");
+    CHECK_EQ(m.stats.merged, 1);
+}
+
+static void test_overlap(void) {
+    /* 左のロールオーバー: 1 つ目は右と合わせ、2 つ目は片手 */
+    reset();
+    mejiro_merge_start(&m, L, 3000);
+    mejiro_merge_start(&m, R, 3005);
+    mejiro_merge_start(&m, L, 3030);
+    mejiro_merge_done(&m, L, 0x001, 3040);
+    CHECK_STR(emitted, "");
+    mejiro_merge_done(&m, R, 0x100, 3050);
+    CHECK_STR(emitted, "101@3050");
+    mejiro_merge_done(&m, L, 0x002, 3080);
+    CHECK_STR(emitted, "101@3050|2@3080");
+
+    /* 押している間が重なっても、始まりが窓より離れていれば別のストローク */
+    reset();
+    mejiro_merge_start(&m, L, 4000);
+    mejiro_merge_start(&m, R, 4000 + WINDOW_MS + 1);
+    mejiro_merge_done(&m, L, 0x001, 4060);
+    CHECK_STR(emitted, "1@4060");
+    CHECK_EQ(mejiro_merge_deadline(&m), -1);
+    mejiro_merge_done(&m, R, 0x100, 4090);
+    CHECK_STR(emitted, "1@4060|100@4090");
+
+    /* 右が待っている間に左が次を押し始めても、右は左の 1 つ目と合わせる */
+    reset();
+    mejiro_merge_start(&m, R, 5000);
+    mejiro_merge_start(&m, L, 5040);
+    mejiro_merge_done(&m, R, 0x100, 5045);
+    mejiro_merge_start(&m, L, 5100);
+    mejiro_merge_done(&m, L, 0x001, 5120);
+    CHECK_STR(emitted, "101@5120");
+    mejiro_merge_done(&m, L, 0x002, 5130);
+    CHECK_STR(emitted, "101@5120|2@5130");
+    CHECK_EQ(m.stats.merged, 1);
+    CHECK_EQ(m.stats.single, 1);
+}
+
+int main(void) {
+    test_order();
+    test_timeout();
+    test_overlap();
+    return test_result("mejiro_merge");
+}
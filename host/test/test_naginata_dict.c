@@ -0,0 +1,171 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * naginata_dict.c（同時押しの表）と naginata_shift.c（先行シフト面）: ストロークを
+ * 打って、kana_out が送った keycode をローマ字に戻して見る。
+ */
+#include <dt-bindings/zmk/keys.h>
+
+#include <host_shim.h>
+#include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_shift.h>
+
+#include "chord_test.h"
+
+static char typed[128];
+static size_t typed_len;
+
+/* 押下だけを 1 文字に戻す。← は '<'、Shift は '^'、知らないものは '?' */
+static void hid_hook(uint32_t encoded, bool pressed, int64_t timestamp, void *user) {
+    (void)timestamp;
+    (void)user;
+    if (!pressed || typed_len + 1 >= sizeof(typed)) {
+        return;
+    }
+
+    char c = '?';
+    if (encoded >= A && encoded <= Z) {
+        c = (char)('a' + (encoded - A));
+    } else if (encoded == COMMA) {
+        c = ',';
+    } else if (encoded == DOT) {
+        c = '.';
+    } else if (encoded == MINUS) {
+        c = '-';
+    } else if (encoded == SPACE) {
+        c = ' ';
+    } else if (encoded == ENTER) {
+        c = '\n';
+    } else if (encoded == BSPC) {
+        c = '\b';
+    } else if (encoded == LEFT) {
+        c = '<';
+    } else if (encoded == LSHIFT) {
+        c = '^';
+    }
+    typed[typed_len++] = c;
+    typed[typed_len] = '\0';
+}
+
+static void reset(void) {
+    typed_len = 0;
+    typed[0] = '\0';
+}
+
+/* 押下順の keycode を 1 ストロークとして判定する */
+static bool type(const uint32_t *keys, int count) {
+    NGListArray strokes;
+    NGList one;
+
+    initializeListArray(&strokes);
+    initializeList(&one);
+    for (int i = 0; i < count; i++) {
+        (void)addToList(&one, keys[i]);
+    }
+    (void)addToListArray(&strokes, &one);
+    reset();
+    return naginata_type_from_nglistarray(&strokes, 0);
+}
+
+#define TYPE(...)                                                                                 \
+    type((const uint32_t[]){__VA_ARGS__},                                                         \
+         sizeof((const uint32_t[]){__VA_ARGS__}) / sizeof(uint32_t))
+
+static void test_chords(void) {
+    CHECK(TYPE(J));
+    CHECK_STR(typed, "a");
+    /* シフトは押した順によらない */
+    TYPE(SPACE, O);
+    CHECK_STR(typed, "e");
+    TYPE(O, SPACE);
+    CHECK_STR(typed, "e");
+    TYPE(J, F);
+    CHECK_STR(typed, "ga");
+    TYPE(W, H);
+    CHECK_STR(typed, "kya");
+    TYPE(Q, J);
+    CHECK_STR(typed, "xa");
+    /* 3 キーの外来音 */
+    TYPE(M, E, K);
+    CHECK_STR(typed, "thi");
+    TYPE(V, L, K);
+    CHECK_STR(typed, "wi");
+    TYPE(SPACE);
+    CHECK_STR(typed, " ");
+    TYPE(SPACE, M);
+    CHECK_STR(typed, ".\n");
+}
+
+static void test_rollover(void) {
+    /* 1 つの組み合わせでなければ、先頭から長く一致するものを順に */
+    TYPE(J, K);
+    CHECK_STR(typed, "ai");
+    TYPE(J, F, I);
+    CHECK_STR(typed, "garu");
+    /* 連続シフト: 先に押した SPACE は後のキーにも効く */
+    TYPE(SPACE, O, N);
+    CHECK_STR(typed, "eo");
+    /* 表に無いキーは捨てる */
+    CHECK(!TYPE(Q));
+    CHECK_STR(typed, "");
+}
+
+static void test_funcs(void) {
+    TYPE(T);
+    CHECK_STR(typed, "<");
+    TYPE(SPACE, T);
+    CHECK_STR(typed, "^<");
+    TYPE(U);
+    CHECK_STR(typed, "\b");
+    /* かなの後に func */
+    TYPE(J, T);
+    CHECK_STR(typed, "a<");
+}
+
+static void shift_fallback(const uint32_t *keys, uint8_t count, int64_t timestamp) {
+    NGListArray strokes;
+    NGList one;
+
+    initializeListArray(&strokes);
+    initializeList(&one);
+    for (uint8_t i = 0; i < count; i++) {
+        (void)addToList(&one, keys[i]);
+    }
+    (void)addToListArray(&strokes, &one);
+    (void)naginata_type_from_nglistarray(&strokes, timestamp);
+}
+
+static void tap_shifted(uint32_t key) {
+    CHECK(naginata_shift_press(key, false, 0));
+    CHECK(naginata_shift_release(key, 0));
+}
+
+static void test_prefix_plane(void) {
+    naginata_shift_init(shift_fallback);
+    reset();
+
+    /* ng SPACE を押したまま: 小書き、外来音、面に無いキーは {SPACE, キー} の同時押し */
+    CHECK(naginata_shift_press(SPACE, false, 0));
+    tap_shifted(J);
+    tap_shifted(W);
+    tap_shifted(Q);
+    tap_shifted(Z);
+    tap_shifted(COMMA);
+    CHECK(naginata_shift_release(SPACE, 0));
+    CHECK_STR(typed, "xawivufane");
+
+    /* 何も打たずに離した SPACE は単打 */
+    reset();
+    CHECK(naginata_shift_press(SPACE, false, 0));
+    CHECK(naginata_shift_release(SPACE, 0));
+    CHECK_STR(typed, " ");
+}
+
+int main(void) {
+    host_hid_set_hook(hid_hook, NULL);
+    test_chords();
+    test_rollover();
+    test_funcs();
+    test_prefix_plane();
+    return test_result("naginata_dict");
+}
@@ -0,0 +1,113 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Committed text to a host companion (CONFIG_ZMK_CHORD_COMPANION).
+ *
+ * companion（scripts/chord_companion.py）が応答している間、kana_out は確定したかなを
+ * ローマ字の keycode にせず UTF-8 のままフレームで送り、companion がそのまま入力する
+ * （IME を通らない）。1 フレームに何ストロークでも入るので、速さは HID の打鍵数では
+ * なく USB のフレームで決まる。companion が答えなくなれば keycode に戻る。
+ *
+ * フレーム（little endian、mejiro_dict_update.h と同じ形で SYNC だけ違う）:
+ *   0xA5 0x4B | type u8 | len u16 | payload[len] | crc16 u16
+ *   crc16 = CRC-16/XMODEM (crc16_itu_t, seed 0) over type..payload
+ *
+ *   host -> kbd  HELLO  { version u8 }   lease_ms の間 companion がいるとみなす。
+ *                                        companion は lease より短い間隔で送り続ける
+ *   kbd -> host  HELLO|RESP { version u8, frame_max u16 }
+ *   kbd -> host  TEXT   { seq u8, utf8[] }  U+0008 は Backspace
+ *   host -> kbd  TEXT|RESP { seq u8 }    入力し終えた
+ *   kbd -> host  CANCEL { seq u8 }       返事の来ない TEXT を取り消す
+ *   host -> kbd  CANCEL|RESP { seq u8, typed u8 }
+ *                                        typed = 1 は入力済み。0 ならその seq は後から
+ *                                        届いても入力しない（捨てる）
+ *   host -> kbd  BYE    {}               すぐ keycode に戻す
+ *
+ * 返事を待っている TEXT は 1 つだけ。その間に確定したものは次のフレームにまとめる
+ * （入りきらない分と keycode は kana_out が後ろに並べる。送る側は返事を待たない）。
+ * ack_timeout_ms 以内に返事が無ければ CANCEL を送る。入力済みの答え（か遅れて来た
+ * TEXT|RESP）ならそのまま続け、捨てたと答えた時だけその文字を keycode で送り直して
+ * keycode に戻る。CANCEL にも返事が無ければ companion はいないものとし、入力された
+ * か分からない文字は捨てて（log に残す）keycode に戻る。どの場合も二重には出ない。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHORD_COMP_SYNC0 0xA5
+#define CHORD_COMP_SYNC1 0x4B
+#define CHORD_COMP_RESP 0x80
+#define CHORD_COMP_VERSION 1
+
+enum chord_companion_type {
+    CHORD_COMP_HELLO = 1,
+    CHORD_COMP_TEXT = 2,
+    CHORD_COMP_BYE = 3,
+    CHORD_COMP_CANCEL = 4,
+};
+
+/* 送り先（USB CDC-ACM なら chord_companion_uart.c、host のベンチは loopback） */
+struct chord_companion_transport {
+    /* Write one whole frame. Returns 0 or a negative errno. */
+    int (*write)(const uint8_t *data, size_t len, void *ctx);
+    void *ctx;
+};
+
+struct chord_companion_stats {
+    uint32_t frames;    /* 送った TEXT */
+    uint32_t bytes;     /* その UTF-8 の bytes */
+    uint32_t acks;
+    uint32_t dropped;   /* CANCEL にも返事が無く、捨てたフレーム */
+    uint32_t fallbacks; /* 返事が無く keycode に戻った回数 */
+};
+
+void chord_companion_set_transport(const struct chord_companion_transport *transport);
+
+/* Bytes from the host, in any split. Call from a thread, not from an ISR. */
+void chord_companion_receive(const uint8_t *data, size_t len);
+
+/* A companion answered recently, or text is still waiting for its answer. */
+bool chord_companion_active(void);
+
+/*
+ * Queue text for the companion. Returns false when no companion is active
+ * (the caller sends keycodes instead).
+ */
+bool chord_companion_send(const char *utf8, int64_t timestamp);
+
+bool chord_companion_backspaces(size_t count, int64_t timestamp);
+
+/*
+ * Text is waiting for its answer. kana_out queues keycodes behind it and sends
+ * them once the companion calls kana_out_resume().
+ */
+bool chord_companion_busy(void);
+
+/*
+ * Wait until the companion has typed everything (or give up and fall back).
+ * Blocks: only for kana_out_flush(); sends never wait for the answer.
+ */
+void chord_companion_flush(void);
+
+/* どちらで出すか（chord companion mode。CONFIG_ZMK_CHORD_PERSIST なら chord/companion に残る） */
+enum chord_companion_mode {
+    CHORD_COMP_MODE_AUTO,      /* companion が答えている間だけ（既定） */
+    CHORD_COMP_MODE_KEYCODE,   /* 常に keycode */
+    CHORD_COMP_MODE_COMPANION, /* transport があれば常に。捨てたと答えた文字だけ keycode */
+};
+
+void chord_companion_set_mode(enum chord_companion_mode mode);
+
+enum chord_companion_mode chord_companion_get_mode(void);
+
+void chord_companion_get_stats(struct chord_companion_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,123 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Chord engine shared by the Mejiro and Naginata behaviors.
+ *
+ * キーの押下・離上からストロークの確定までは両方式で同じ:
+ *   press/release -> (先行シフトなどの横取り) -> chord_seg -> 確定 -> resolver
+ * ここがその共通部分（chord_seg、確定の方式、chord tune、期限の timer、wakeup の計測、
+ * "chord engine" の統計）を持ち、behavior は key の値を決めて（Mejiro は stroke code の
+ * bit、Naginata は keycode）、確定したストロークを自分の方式で出力する ops を渡すだけ。
+ * ops は const の表なので、方式ごとの違いはビルド時に決まる。
+ *
+ * 出力は kana_out（chord/kana_out.h）が両方式で共通。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+
+#include <chord/chord_seg.h>
+#include <chord/chord_tune.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct chord_engine;
+
+/* 方式ごとの部分。commit 以外は NULL 可 */
+struct chord_engine_ops {
+    const char *name; /* "mejiro" / "naginata"（chord tune の settings のキーにもなる） */
+
+    /* chord_seg より先に見る（Naginata の先行シフト）。true なら消費した */
+    bool (*intercept_press)(struct chord_engine *engine, uint32_t key, int64_t timestamp);
+    bool (*intercept_release)(struct chord_engine *engine, uint32_t key, int64_t timestamp);
+
+    /* 未確定のストロークが 1 つ増えた（離上で切り出されたものも） */
+    void (*stroke_start)(struct chord_engine *engine, const struct chord_stroke *stroke);
+
+    /* chord_seg に割り当てた後の押下（推測送信など） */
+    void (*pressed)(struct chord_engine *engine, const struct chord_stroke *stroke,
+                    int64_t timestamp);
+
+    /* 確定したストローク（古い順）。stroke は呼び出し中のみ有効 */
+    void (*commit)(struct chord_engine *engine, const struct chord_stroke *stroke);
+
+    /* chord tune の出力 tap 間隔 */
+    void (*set_gap)(uint16_t gap_ms);
+
+    /* chord tune の値を chord_seg に書いた後（split の peripheral にも伝える時） */
+    void (*tuned)(struct chord_engine *engine, const struct chord_tune_params *params);
+
+    /* chord_engine_arm() の時刻になった（system work queue から）。now は k_uptime_get() */
+    void (*expire)(struct chord_engine *engine, int64_t now);
+};
+
+/* devicetree の chord-window-ms / inter-key-gap-ms / commit-mode */
+struct chord_engine_config {
+    uint16_t window_ms;
+    uint16_t gap_ms;
+    enum chord_commit_mode commit_mode;
+};
+
+/*
+ * 時刻はすべて press / release に渡された時刻（ZMK では position event の、キーを読んだ時刻）。
+ * queue_ms はそこから press / release が呼ばれるまで（event manager の待ち）、
+ * commit_ms はストロークの最初の押下から ops->commit が返るまで。commit は出力を
+ * kana_out の queue に積むだけのことがあるので、HID に出るまでは kana_out_get_stats()。
+ */
+struct chord_engine_stats {
+    uint32_t presses;
+    uint32_t releases;
+    uint32_t intercepted; /* intercept_press が消費した押下 */
+    uint32_t strokes;     /* commit に渡したストローク */
+    uint32_t queue_ms_sum;
+    uint32_t queue_ms_max;
+    uint32_t commit_ms_sum;
+    uint32_t commit_ms_max;
+};
+
+struct chord_engine {
+    const struct chord_engine_ops *ops;
+    struct chord_seg seg;
+    uint8_t started;   /* stroke_start に渡した未確定ストローク */
+    int64_t timestamp; /* 最後の押下・離上（キーを読んだ時刻） */
+    struct k_work_delayable timer; /* chord_engine_arm() */
+    struct chord_engine_stats stats;
+#ifdef CONFIG_ZMK_CHORD_TUNE
+    struct chord_tune_engine tune;
+#endif
+};
+
+/*
+ * behavior の init から呼ぶ（cfg->gap_ms は behavior が先に自分で効かせておく）。
+ * chord tune と "chord engine" コマンドに登録する。
+ */
+void chord_engine_init(struct chord_engine *engine, const struct chord_engine_ops *ops,
+                       const struct chord_engine_config *cfg);
+
+/* timestamp はキーを読んだ時刻（k_uptime_get() 基準）。これを呼んだ時刻ではない */
+void chord_engine_press(struct chord_engine *engine, uint32_t key, int64_t timestamp);
+
+void chord_engine_release(struct chord_engine *engine, uint32_t key, int64_t timestamp);
+
+/* 押下中のキーがあっても、未確定のストロークを全部確定する */
+void chord_engine_flush(struct chord_engine *engine);
+
+/*
+ * deadline（k_uptime_get() 基準。過ぎていればすぐ）に ops->expire を呼ぶ。
+ * 張り直すと前の期限は消える。負なら取り消す。
+ */
+void chord_engine_arm(struct chord_engine *engine, int64_t deadline);
+
+/* 割り当て済みで未確定のストローク数 */
+static inline uint8_t chord_engine_pending(const struct chord_engine *engine) {
+    return engine->seg.count;
+}
+
+#ifdef __cplusplus
+}
+#endif
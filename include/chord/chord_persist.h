@@ -0,0 +1,61 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Debounced settings write-back (CONFIG_ZMK_CHORD_PERSIST).
+ *
+ * 変更は chord_persist_set() で値を写して印を付けるだけ。最後の変更から DELAY_MS 何も
+ * 来なければ、優先度の低い専用 work queue で印の付いた item をまとめて書く
+ * （変更が続いても MAX_DELAY_MS で 1 回は書く）。書く前に前回書いた（読んだ）
+ * 内容と CRC を比べ、同じなら書かない。入力の経路で flash を待つことは無い。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct chord_persist_item {
+    const char *key; /* settings のキー（static） */
+    void *data;      /* 書く値の置き場（static、len bytes）。chord_persist だけが書く */
+    size_t len;
+    /* 以下は chord_persist が使う */
+    uint32_t crc;     /* flash 上の内容（無ければ stored = false） */
+    bool stored;
+    bool dirty;
+};
+
+#define CHORD_PERSIST_ITEM_INIT(_key, _data)                                                      \
+    { .key = (_key), .data = &(_data), .len = sizeof(_data) }
+
+struct chord_persist_stats {
+    uint32_t marks;   /* chord_persist_set の回数 */
+    uint32_t writes;  /* settings_save_one の回数（flash の消耗はこれで見る） */
+    uint32_t skipped; /* 内容が同じで書かなかった回数 */
+    uint32_t errors;
+    uint32_t pending; /* 書き込み待ちの item（get_stats の時点） */
+};
+
+/* 値が変わった: value（item->len bytes）を写して、書くのは後で（どのスレッドからでもよい） */
+void chord_persist_set(struct chord_persist_item *item, const void *value);
+
+/* settings から value を読んだ（同じ内容を書き直さないため） */
+void chord_persist_loaded(struct chord_persist_item *item, const void *value);
+
+/*
+ * 印の付いた item を今すぐ書く（呼んだスレッドで）。0 or 最初のエラー。
+ * 書けなかった item は印を残し、DELAY_MS 後にまた書く
+ */
+int chord_persist_flush(void);
+
+/* item を settings から消す（印も消す） */
+int chord_persist_forget(struct chord_persist_item *item);
+
+void chord_persist_get_stats(struct chord_persist_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,60 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Latency-vs-power profile and wakeup counters for the chord engines.
+ *
+ * ストロークの確定は離上で決まるので、chord のタイマーは無い。起きるのはキーの
+ * 押下・離上と、出力を間隔を空けて流している間（kana_out の one-shot work）、
+ * settings の書き込みだけ。電池の時（CONFIG_ZMK_CHORD_POWER_*）は出力を何 tap か
+ * まとめて送り、その分だけ間隔を広げて起きる回数を減らす。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum chord_wake {
+    CHORD_WAKE_KEY,    /* キーの押下・離上 */
+    CHORD_WAKE_OUTPUT, /* 出力キューの work */
+    CHORD_WAKE_STORE,  /* settings への書き込み work */
+    CHORD_WAKE_COUNT,
+};
+
+struct chord_power_stats {
+    uint32_t wakeups[CHORD_WAKE_COUNT];
+    uint32_t chars; /* kana_out が送った文字数（かな 1 文字 = 1） */
+};
+
+/* 出力の流し方: burst tap を続けて送り、gap_ms 待って次 */
+struct chord_power_pacing {
+    uint8_t burst;
+    uint16_t gap_ms;
+};
+
+/* Battery profile, or AUTO while not powered over USB. */
+bool chord_power_on_battery(void);
+
+/* Pacing for a behavior's inter-key-gap-ms under the current profile. */
+struct chord_power_pacing chord_power_pacing(uint16_t gap_ms);
+
+#ifdef CONFIG_ZMK_CHORD_POWER_STATS
+
+void chord_power_wake(enum chord_wake src);
+void chord_power_chars(uint32_t count);
+void chord_power_get_stats(struct chord_power_stats *out);
+void chord_power_reset_stats(void);
+
+#else
+
+static inline void chord_power_wake(enum chord_wake src) { (void)src; }
+static inline void chord_power_chars(uint32_t count) { (void)count; }
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,105 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Rollover-aware chord segmentation.
+ *
+ * 速打ちでは「前のストロークの最後のキーを離す前に次のストロークの最初のキーを押す」
+ * ので、押下中キーの集合だけを見ていると 2 ストロークが 1 つに混ざる。
+ * ここでは押下ごとにストロークを割り当てる:
+ *
+ *  - 最新ストロークのキーがまだ 1 つも離されていなければ、そのストロークに追加
+ *  - 1 つでも離された後の押下は次のストロークになる（離上順）
+ *  - 最初の離上の直前 split_ms 以内に押され、かつ最初の押下から split_ms 以上
+ *    遅れて押されたキーは次のストロークへ移す（タイミング）
+ *
+ * 確定は古い順。新しいストロークが先に全離上したら、古いストロークを強制確定する
+ * （残っているキーの離上は無視される）。キーは混ざらず、落ちない。
+ *
+ * CHORD_COMMIT_ALL_RELEASED では分割しない（従来のステノ式: 全キーを離すまで 1 ストローク）。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_ZMK_CHORD_MAX_STROKE_KEYS
+#define CHORD_STROKE_MAX_KEYS CONFIG_ZMK_CHORD_MAX_STROKE_KEYS
+#else
+#define CHORD_STROKE_MAX_KEYS 10
+#endif
+
+#ifdef CONFIG_ZMK_CHORD_MAX_PENDING_STROKES
+#define CHORD_SEG_MAX_PENDING CONFIG_ZMK_CHORD_MAX_PENDING_STROKES
+#else
+#define CHORD_SEG_MAX_PENDING 4
+#endif
+
+/* devicetree の commit-mode と同じ並び */
+enum chord_commit_mode {
+    CHORD_COMMIT_ROLLOVER = 0,
+    CHORD_COMMIT_ALL_RELEASED = 1,
+};
+
+struct chord_stroke {
+    uint32_t keys[CHORD_STROKE_MAX_KEYS];       /* 押下順 */
+    int64_t pressed_at[CHORD_STROKE_MAX_KEYS];
+    uint8_t count;
+    uint16_t held;          /* bit i: keys[i] が押下中 */
+    bool released;          /* 1 つでも離されたか */
+    int64_t first_press;
+    int64_t first_release;
+    int64_t last_release;
+};
+
+struct chord_seg_stats {
+    uint32_t strokes;   /* 確定したストローク数 */
+    uint32_t splits;    /* 押下中に次ストロークへ切り出した回数 */
+    uint32_t forced;    /* 押下中のキーを残したまま確定した回数 */
+};
+
+/* stroke は呼び出し中のみ有効 */
+typedef void (*chord_seg_commit_cb)(const struct chord_stroke *stroke, void *user_data);
+
+struct chord_seg {
+    struct chord_stroke ring[CHORD_SEG_MAX_PENDING];
+    uint8_t head;
+    uint8_t count;
+    uint16_t split_ms;
+    uint8_t mode;       /* enum chord_commit_mode */
+    chord_seg_commit_cb commit;
+    void *user_data;
+    struct chord_seg_stats stats;
+};
+
+void chord_seg_init(struct chord_seg *seg, uint16_t split_ms, chord_seg_commit_cb commit,
+                    void *user_data);
+
+/* Default is CHORD_COMMIT_ROLLOVER. Call after chord_seg_init. */
+void chord_seg_set_mode(struct chord_seg *seg, enum chord_commit_mode mode);
+
+/* Change split_ms (chord tune). With CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW it is a new start value. */
+void chord_seg_set_window(struct chord_seg *seg, uint16_t split_ms);
+
+/* Returns the stroke the key was assigned to (valid until the next call). */
+const struct chord_stroke *chord_seg_press(struct chord_seg *seg, uint32_t key, int64_t ts);
+
+void chord_seg_release(struct chord_seg *seg, uint32_t key, int64_t ts);
+
+/*
+ * The i-th pending stroke, oldest first, or NULL (valid until the next call).
+ * 離上時の切り出しでもストロークが増えるので、始まりを知りたい時は press / release の後に
+ * count と見比べる。
+ */
+const struct chord_stroke *chord_seg_pending(const struct chord_seg *seg, uint8_t i);
+
+/* Commit every pending stroke regardless of held keys. */
+void chord_seg_flush(struct chord_seg *seg);
+
+#ifdef __cplusplus
+}
+#endif
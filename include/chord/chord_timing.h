@@ -0,0 +1,43 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Adaptive simultaneous-press window (CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW).
+ *
+ * ストローク間隔（前のストロークの最初の押下 -> 次の最初の押下）と
+ * キーの押下時間を指数移動平均で追い、chord_seg の split 窓を
+ * [MIN, MAX] の範囲で調整する。速く打つと窓が狭く（遅延が減る）、
+ * ゆっくり打つと広く（同時押しが割れにくい）なる。
+ * 打鍵リズムは人に付くので、Mejiro / Naginata で 1 つを共有する。
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct chord_timing_stats {
+    uint16_t window_ms;
+    uint16_t min_ms;
+    uint16_t max_ms;
+    uint16_t interval_ms; /* ストローク間隔の平均 */
+    uint16_t hold_ms;     /* 押下時間の平均 */
+    uint32_t interval_samples;
+    uint32_t hold_samples;
+};
+
+/* A new stroke started at ts (first key of the stroke). */
+void chord_timing_stroke_start(int64_t ts);
+
+/* A key was held for hold_ms. */
+void chord_timing_key_hold(uint32_t hold_ms);
+
+/* Current window (ms). */
+uint16_t chord_timing_window(void);
+
+void chord_timing_get_stats(struct chord_timing_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
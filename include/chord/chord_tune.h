@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Runtime tuning of the chord engines (CONFIG_ZMK_CHORD_TUNE).
+ *
+ * 初期値は各 behavior の devicetree プロパティ。"chord tune" シェルで
+ * 打ちながら変えられ、CONFIG_ZMK_CHORD_PERSIST なら settings（chord/tune/<engine>）に
+ * 少し遅れて残る（chord_persist.h、"chord tune save" で今すぐ）。
+ * 保存した値は起動時の settings_load で devicetree の値の上に戻る。
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 実行時に変えられる値（engine 1 つ分）。settings にもこの形（6 bytes、padding 無し）で
+ * 書き、CRC もこのまま取るので、reserved は常に 0（chord_tune が書き直す）
+ */
+struct chord_tune_params {
+    uint16_t window_ms;  /* chord_seg の split 窓 */
+    uint16_t gap_ms;     /* 出力 tap の間 */
+    uint8_t commit_mode; /* enum chord_commit_mode */
+    uint8_t reserved;
+};
+
+struct chord_tune_engine {
+    const char *name;                   /* "mejiro" / "naginata"（settings のキーにもなる） */
+    struct chord_tune_params params;    /* 今の値 */
+    struct chord_tune_params defaults;  /* devicetree の値 */
+    /* params を engine に反映する（behavior 側で chord_seg / 出力に書く） */
+    void (*apply)(const struct chord_tune_params *params);
+};
+
+/*
+ * Called from the behavior's init with params == defaults already applied.
+ * engine must stay valid (static). 0 or -ENOMEM.
+ */
+int chord_tune_register(struct chord_tune_engine *engine);
+
+/* NULL if no engine has that name. */
+struct chord_tune_engine *chord_tune_find(const char *name);
+
+/* Set params, apply them and schedule the settings write. */
+void chord_tune_set(struct chord_tune_engine *engine, const struct chord_tune_params *params);
+
+/* Write pending params to settings now. 0 or -errno. */
+int chord_tune_save(void);
+
+/* Back to the devicetree values and delete the saved ones. */
+int chord_tune_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Kana / ASCII text -> keycode taps (romaji through the host IME).
+ * Mejiro と Naginata の「かなを出す」経路はここに集める。
+ * host の companion が応答している間は、かなのまま companion に送る（chord_companion.h）。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Encode UTF-8 text (hiragana/katakana, ー、。 and ASCII) to romaji.
+ * Uses the shortest spelling the IME reads back unambiguously (kitte, kanzi,
+ * ja); ん/っ at the end of text stay nn/xtu since the next stroke is unknown.
+ * Returns the romaji length, or 0 if something could not be encoded or
+ * out was too small. out is always NUL-terminated when out_len > 0.
+ */
+size_t kana_roman_encode(const char *utf8, char *out, size_t out_len);
+
+/*
+ * Encode and tap. Returns true if every character was sent.
+ * timestamp is that of the key that produced the text; every event sent for
+ * it carries it, queued taps included.
+ */
+bool kana_out_send(const char *utf8, int64_t timestamp);
+
+/*
+ * Always keycodes, never the companion ('\b' taps Backspace), tapped right
+ * away ahead of the queue: for text the companion dropped, which is older than
+ * anything queued behind it.
+ */
+bool kana_out_send_keys(const char *utf8, int64_t timestamp);
+
+void kana_out_backspaces(size_t count, int64_t timestamp);
+
+/*
+ * Same as above, waiting gap_ms between taps (0 = back to back).
+ * 速い連打を落とすホスト / IME 向け。値は各 behavior の inter-key-gap-ms。
+ * 待ちは出力キューと one-shot の work で、呼んだ側は待たない（電池の時は
+ * chord_power_pacing() で何 tap かずつまとめる）。キューに入りきらなければ
+ * 待たずに捨てて false。
+ */
+bool kana_out_send_paced(const char *utf8, uint16_t gap_ms, int64_t timestamp);
+
+void kana_out_backspaces_paced(size_t count, uint16_t gap_ms, int64_t timestamp);
+
+/*
+ * Run fn(args, count, timestamp) once everything queued before it has been sent.
+ * For output that does not go through kana_out (naginata の type_keys など): with
+ * an empty queue it runs right away, otherwise from the drain work, so the
+ * caller never waits. args is copied (at most CHORD_STROKE_MAX_KEYS).
+ */
+typedef void (*kana_out_call_cb)(const uint32_t *args, uint8_t count, int64_t timestamp);
+
+void kana_out_call(kana_out_call_cb fn, const uint32_t *args, uint8_t count, int64_t timestamp);
+
+/*
+ * Send whatever is still queued now, sleeping for the gaps (and wait for the
+ * companion to type what it was sent). Blocks the caller: only for callers that
+ * must have the output out before they return; key paths use kana_out_call().
+ */
+void kana_out_flush(void);
+
+/* The companion has nothing waiting any more: send what was queued behind it. */
+void kana_out_resume(void);
+
+/*
+ * Key scan to HID for each tap sent here, queued taps included (timed from the
+ * timestamp they were sent with). Text handed to the companion is not counted.
+ */
+struct kana_out_stats {
+    uint32_t taps;
+    uint32_t hid_ms_sum;
+    uint32_t hid_ms_max;
+};
+
+void kana_out_get_stats(struct kana_out_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
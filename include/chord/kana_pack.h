@@ -0,0 +1,32 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Packed kana text (static shared codebook).
+ *
+ * 辞書イメージの出力文字列は 1 かな 1 byte を基本に詰める。符号表は固定で、
+ * scripts/mejiro_dictc.py と同じもの:
+ *   0x01..0x7E  ASCII
+ *   0x7F n ...  エスケープ: 続く n bytes をそのまま UTF-8 として出す
+ *   0x80..0xD5  ぁ..ゖ (U+3041..U+3096)
+ *   0xD6..0xDB  ー 、 。 「 」 ・
+ *   0xDC x      カタカナ: x (0x80..0xD5) の +0x60
+ *   0xDD..0xFF  よく出る 2 かな（kana_pack.c の bigrams[]）
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * packed -> UTF-8。NUL 終端した長さを返す。壊れた入力や out 不足は 0
+ * （out_len > 0 なら out は常に NUL 終端）。
+ */
+size_t kana_pack_decode(const uint8_t *in, size_t len, char *out, size_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
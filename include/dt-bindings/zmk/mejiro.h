@@ -2,32 +2,89 @@
  * SPDX-License-Identifier: MIT
  *
  * dt-bindings for Mejiro behavior parameter
- * これが無いと keymap 内で &mj MJ_L0 の MJ_L0 が “数値”にならず dtc が落ちる
+ * これが無いと keymap 内で &mj MJ_L_S の MJ_L_S が “数値”にならず dtc が落ちる
+ *
+ * &mj の param1 = Mejiro key id。C 側（include/mejiro/mejiro_key_ids.h）もこれを使う。
+ * 片手 9 キー、並びはストローク表記と同じ s t k N n y i a U:
+ *   Left  : 0..8   (MJ_L_0 + i)
+ *   Right : 16..24 (MJ_R_0 + i)
+ *   Mod   : 32 '#', 33 '*'
  */
 
 #pragma once
 
-/* 例: あなたの key_id が 0.. で並んでいる前提で最低限だけ用意 */
-#define MJ_L0 0
-#define MJ_L1 1
-#define MJ_L2 2
-#define MJ_L3 3
-#define MJ_L4 4
-#define MJ_L5 5
-#define MJ_L6 6
-#define MJ_L7 7
-
-#define MJ_R0 8
-#define MJ_R1 9
-#define MJ_R2 10
-#define MJ_R3 11
-#define MJ_R4 12
-#define MJ_R5 13
-#define MJ_R6 14
-#define MJ_R7 15
-
-/* mod 系があるならここに追加 */
-#define MJ_MOD0 16
-#define MJ_MOD1 17
-#define MJ_MOD2 18
-#define MJ_MOD3 19
+#define MJ_L_0 0
+#define MJ_L_1 1
+#define MJ_L_2 2
+#define MJ_L_3 3
+#define MJ_L_4 4
+#define MJ_L_5 5
+#define MJ_L_6 6
+#define MJ_L_7 7
+#define MJ_L_8 8
+
+#define MJ_R_0 16
+#define MJ_R_1 17
+#define MJ_R_2 18
+#define MJ_R_3 19
+#define MJ_R_4 20
+#define MJ_R_5 21
+#define MJ_R_6 22
+#define MJ_R_7 23
+#define MJ_R_8 24
+
+#define MJ_MOD_H 32 /* '#' */
+#define MJ_MOD_X 33 /* '*' */
+
+/* &mj_half の param1（split の peripheral で半分のストロークをまとめるか） */
+#define MJ_HALF_OFF 0
+#define MJ_HALF_ON 1
+#define MJ_HALF_TOG 2
+
+/* 名前で書く用（N = 子音の N、HN = 撥音の n） */
+#define MJ_L_S MJ_L_0
+#define MJ_L_T MJ_L_1
+#define MJ_L_K MJ_L_2
+#define MJ_L_N MJ_L_3
+#define MJ_L_HN MJ_L_4
+#define MJ_L_Y MJ_L_5
+#define MJ_L_I MJ_L_6
+#define MJ_L_A MJ_L_7
+#define MJ_L_U MJ_L_8
+
+#define MJ_R_S MJ_R_0
+#define MJ_R_T MJ_R_1
+#define MJ_R_K MJ_R_2
+#define MJ_R_N MJ_R_3
+#define MJ_R_HN MJ_R_4
+#define MJ_R_Y MJ_R_5
+#define MJ_R_I MJ_R_6
+#define MJ_R_A MJ_R_7
+#define MJ_R_U MJ_R_8
+
+/* 旧名（以前は右が 8.. だった。値は新しい並びに合わせてある） */
+#define MJ_L0 MJ_L_0
+#define MJ_L1 MJ_L_1
+#define MJ_L2 MJ_L_2
+#define MJ_L3 MJ_L_3
+#define MJ_L4 MJ_L_4
+#define MJ_L5 MJ_L_5
+#define MJ_L6 MJ_L_6
+#define MJ_L7 MJ_L_7
+#define MJ_R0 MJ_R_0
+#define MJ_R1 MJ_R_1
+#define MJ_R2 MJ_R_2
+#define MJ_R3 MJ_R_3
+#define MJ_R4 MJ_R_4
+#define MJ_R5 MJ_R_5
+#define MJ_R6 MJ_R_6
+#define MJ_R7 MJ_R_7
+#define MJ_MOD0 MJ_MOD_H
+#define MJ_MOD1 MJ_MOD_X
+
+/*
+ * 廃止（修飾は # と * の 2 つだけ）。使うと dtc / コンパイラが下の名前で止まるので、
+ * 何に置き換えるかがエラーから分かる（README の「Mejiro（&mj）のキー id の変更」）
+ */
+#define MJ_MOD2 MJ_MOD2_removed_use_MJ_MOD_H_or_MJ_MOD_X
+#define MJ_MOD3 MJ_MOD3_removed_use_MJ_MOD_H_or_MJ_MOD_X
@@ -13,6 +13,16 @@
 extern "C" {
 #endif
 
+/* 1 ストロークの出力（UTF-8、NUL 込み）の最大長 */
+#define MEJIRO_OUTPUT_MAX 32
+
+/* 片手 9 キー: bit 0..8 = s t k N n y i a U */
+#define MEJIRO_KEYS_PER_HAND 9
+
+/* mod_mask のビット */
+#define MJ_MOD_BIT_H (1u << 0) /* '#' */
+#define MJ_MOD_BIT_X (1u << 1) /* '*' */
+
 struct mejiro_state {
     /* behavior_mejiro.c が期待している名前 */
     uint32_t left_mask;   /* bits for Left keys (0..15)  */
@@ -30,7 +40,7 @@ struct mejiro_state {
 /* Reset a state (all masks -> 0) */
 void mejiro_state_reset(struct mejiro_state *s);
 
-/* Update state by key-id press/release */
+/* Update state by key-id (dt-bindings/zmk/mejiro.h) press/release */
 void mejiro_state_set_key(struct mejiro_state *s, uint32_t key_id, bool pressed);
 
 /* behavior_mejiro.c から呼べる統一入口（ログで未宣言になってたやつ） */
@@ -46,9 +56,95 @@ void mejiro_on_key_event(struct mejiro_state *s, uint32_t key_id, bool pressed);
  */
 bool mejiro_build_stroke_string(const struct mejiro_state *latched, char *out, size_t out_len);
 
-/* Try emit (tables lookup + roman sender). Return true if emitted. */
+/*
+ * Packed stroke code: L | R << 9 | M << 18（辞書のキー）。
+ */
+#define MEJIRO_CODE_R_SHIFT 9
+#define MEJIRO_CODE_M_SHIFT 18
+
+uint32_t mejiro_stroke_code(const struct mejiro_state *latched);
+
+/* mejiro_stroke_code の逆（left/right/mod_mask だけを書き換える） */
+void mejiro_state_from_code(struct mejiro_state *s, uint32_t code);
+
+/*
+ * mejiro_build_stroke_string の逆。"tk-a" / "-n" / "#*" など。
+ * 不明な文字があれば false。
+ */
+bool mejiro_parse_stroke_string(const char *stroke, struct mejiro_state *out);
+
+/*
+ * Stroke -> kana (no output). ユーザー辞書、flash 辞書（それぞれ有効時）、
+ * 例外表（mejiro_tables）の順に引き、無ければ左右のマスクから規則で合成する。out には UTF-8 のかなが入る。
+ */
+bool mejiro_lookup(const struct mejiro_state *latched, char *out, size_t out_len);
+
+/* Try emit (mejiro_lookup + roman sender). Return true if emitted. */
 bool mejiro_try_emit(const struct mejiro_state *latched, int64_t timestamp);
 
+/*
+ * Split keyboards: merge half-strokes（CONFIG_ZMK_MEJIRO_SPLIT_MERGE）。
+ *
+ * peripheral は自分の半分を chord_seg でストロークに切り、始まり（START）と確定した
+ * code（STROKE）だけを送る。central は自分の半分（LOCAL）と届いた半分（REMOTE）を
+ * ここで 1 ストロークに合わせる:
+ *  - 両方の始まりが window_ms 以内なら同じストローク。先に確定した方は、相手が
+ *    まだ押されている間（START 済みで STROKE 前）待つ
+ *  - 相手が動いていなければ片手のストロークとしてすぐ出す
+ *  - 待っている半分は timeout_ms で片手として出す（メッセージが落ちた時の保険）
+ * 時刻はすべて central の k_uptime_get() の基準。LOCAL はキーを読んだ時刻（position event）、
+ * REMOTE は届いた時刻（START は peripheral が送ってきた経過時間だけ戻す）。
+ */
+enum mejiro_half_src {
+    MEJIRO_HALF_LOCAL,
+    MEJIRO_HALF_REMOTE,
+    MEJIRO_HALF_COUNT,
+};
+
+struct mejiro_merge_stats {
+    uint32_t merged;   /* 両手を合わせた */
+    uint32_t single;   /* 片手のまま出した */
+    uint32_t timeouts; /* 相手を待ちきれずに片手で出した */
+};
+
+/* 合わせた（または片手の）ストローク。code は mejiro_stroke_code と同じ */
+typedef void (*mejiro_merge_cb)(uint32_t code, int64_t timestamp, void *user_data);
+
+struct mejiro_merge_half {
+    uint8_t active;       /* 始まって確定していないストローク数 */
+    int64_t active_start; /* その最も古いものの始まり */
+    int64_t last_start;   /* 最も新しいものの始まり */
+    bool waiting;         /* 確定して相手を待っている */
+    uint32_t code;
+    int64_t start;
+    int64_t done_at;
+};
+
+struct mejiro_merge {
+    struct mejiro_merge_half half[MEJIRO_HALF_COUNT];
+    uint16_t window_ms;
+    uint16_t timeout_ms;
+    mejiro_merge_cb emit;
+    void *user_data;
+    struct mejiro_merge_stats stats;
+};
+
+void mejiro_merge_init(struct mejiro_merge *m, uint16_t window_ms, uint16_t timeout_ms,
+                       mejiro_merge_cb emit, void *user_data);
+
+/* A half-stroke started (first key down). */
+void mejiro_merge_start(struct mejiro_merge *m, enum mejiro_half_src src, int64_t ts);
+
+/* A half-stroke was committed with code (only that half's bits). */
+void mejiro_merge_done(struct mejiro_merge *m, enum mejiro_half_src src, uint32_t code,
+                       int64_t ts);
+
+/* Emit halves that waited longer than timeout_ms. */
+void mejiro_merge_expire(struct mejiro_merge *m, int64_t now);
+
+/* When mejiro_merge_expire has something to do, or -1. */
+int64_t mejiro_merge_deadline(const struct mejiro_merge *m);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Streaming dictionary update over UART / USB CDC-ACM (CONFIG_ZMK_MEJIRO_DICT_UPDATE).
+ *
+ * 辞書イメージを「使っていない方」のパーティション（A = mejiro_dict_partition,
+ * B = mejiro_dict_alt_partition）に流し込み、CRC-32 を確かめてから
+ * settings の "mejiro/dict/active" を書き換えて切り替える。書き込み途中の
+ * イメージが使われることは無い。ホスト側は scripts/mejiro_dict_upload.py。
+ *
+ * フレーム（little endian、1 フレームごとに応答を待つ）:
+ *   0xA5 0x5A | type u8 | len u16 | payload[len] | crc16 u16
+ *   crc16 = CRC-16/XMODEM (crc16_itu_t, seed 0) over type..payload
+ * 応答: 同じ形式で type = 要求 | 0x80、payload = { status i32, value u32 }
+ * BEGIN は消去を待つ。同じ size / crc32 の BEGIN を送り直しても消し直さない。
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MJ_UPD_SYNC0 0xA5
+#define MJ_UPD_SYNC1 0x5A
+#define MJ_UPD_RESP 0x80
+
+enum mejiro_dict_update_type {
+    MJ_UPD_BEGIN = 1, /* { size u32, crc32 u32 } -> value = 書き込み先 slot */
+    MJ_UPD_DATA = 2,  /* { offset u32, bytes[] } -> value = 次の offset */
+    MJ_UPD_END = 3,   /* {} -> 検査して切り替え。value = 有効になった slot */
+    MJ_UPD_ABORT = 4, /* {} */
+    MJ_UPD_INFO = 5,  /* {} -> value = 有効な slot */
+};
+
+/* 有効な slot（0 = A, 1 = B） */
+uint8_t mejiro_dict_update_active_slot(void);
+
+/* 応答の送り先（mejiro_dict_update_uart.c、host のテストは直接） */
+struct mejiro_dict_update_transport {
+    /* Write one whole frame. Returns 0 or a negative errno. */
+    int (*write)(const uint8_t *data, size_t len, void *ctx);
+    void *ctx;
+};
+
+void mejiro_dict_update_set_transport(const struct mejiro_dict_update_transport *transport);
+
+/*
+ * Bytes from the host, in any split. Erases and writes flash: call from the
+ * update thread, never from the key path.
+ */
+void mejiro_dict_update_receive(const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,63 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Flash-partition dictionary (CONFIG_ZMK_MEJIRO_FLASH_DICT).
+ *
+ * 辞書本体は専用パーティション（devicetree の mejiro_dict_partition、外付け QSPI 可）に
+ * 置き、flash_area で 1 ページずつ読む。前段に stroke code で引く direct-mapped の
+ * RAM キャッシュを置く（無いことも覚える）。よく使うストロークは RAM で済み、
+ * ミスは 1 ページ読み。イメージは scripts/mejiro_dictc.py で作る。
+ *
+ * バイナリ形式（little endian）:
+ *   page 0 : struct mejiro_dict_header、続けて hot table（version 2 以降）
+ *   page 1..bucket_count : bucket。bucket = (code * 2654435761) >> (32 - log2(bucket_count))
+ *   hot table / bucket はどちらも
+ *     u16 count, 続けて count 個の { u24 code; u8 len; u8 text[len] }
+ *   text は chord/kana_pack.h の符号（1 かな ≒ 1 byte）で、引いた時に UTF-8 へ戻す。
+ *   hot table は open 時に RAM に読み、bucket より先に引く（--profile で回数の多いもの）。
+ *   bucket 内も回数の多い順に並ぶ。残りは 0xFF。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEJIRO_DICT_MAGIC 0x31444A4DU /* "MJD1" */
+#define MEJIRO_DICT_VERSION 3
+
+struct mejiro_dict_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t page_size;    /* bucket 1 個の大きさ（bytes） */
+    uint32_t bucket_count; /* 2 のべき */
+    uint32_t entry_count;
+    uint32_t crc32;        /* ヘッダの後ろから最後の bucket までの CRC-32 (IEEE) */
+} __attribute__((packed));
+
+struct mejiro_flash_dict_stats {
+    uint32_t lookups;
+    uint32_t hot_hits;
+    uint32_t cache_hits;
+    uint32_t page_reads;
+    uint32_t found;
+};
+
+/*
+ * 辞書パーティションを開き直す（ヘッダと CRC の検査 + キャッシュ破棄）。0 or -errno。
+ * ヘッダか CRC がだめなら今の辞書のまま。検査の間も lookup は今の辞書で引ける。
+ */
+int mejiro_flash_dict_open(uint8_t partition_id);
+
+/* true なら out に UTF-8 のかなを書いた */
+bool mejiro_flash_dict_lookup(uint32_t code, char *out, size_t out_len);
+
+void mejiro_flash_dict_get_stats(struct mejiro_flash_dict_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
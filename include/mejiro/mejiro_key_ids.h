@@ -7,52 +7,21 @@
 
 #include <stdint.h>
 
+/* id の値は keymap と共通（dt-bindings 側が正） */
+#include <dt-bindings/zmk/mejiro.h>
+
+#include "mejiro/mejiro_core.h"
+
 /*
- * Bit packing rule used by core:
- * - Left  : 0..15
- * - Right : 16..31  (bit index = id - 16)
- * - Mod   : 32..47  (bit index = id - 32)
- *
- * You can expand later; for now keep minimum stable IDs.
+ * Key id -> packed stroke code の 1 bit（mejiro_stroke_code() と同じ並び）。
+ * Mejiro のキーでなければ 0。定数式なので devicetree から表を作る時にも使う。
  */
-enum mejiro_key_id {
-    /* Left keys (0..15) */
-    MJ_L_0 = 0,
-    MJ_L_1,
-    MJ_L_2,
-    MJ_L_3,
-    MJ_L_4,
-    MJ_L_5,
-    MJ_L_6,
-    MJ_L_7,
-    MJ_L_8,
-    MJ_L_9,
-    MJ_L_10,
-    MJ_L_11,
-    MJ_L_12,
-    MJ_L_13,
-    MJ_L_14,
-    MJ_L_15,
-
-    /* Right keys (16..31) */
-    MJ_R_0 = 16,
-    MJ_R_1,
-    MJ_R_2,
-    MJ_R_3,
-    MJ_R_4,
-    MJ_R_5,
-    MJ_R_6,
-    MJ_R_7,
-    MJ_R_8,
-    MJ_R_9,
-    MJ_R_10,
-    MJ_R_11,
-    MJ_R_12,
-    MJ_R_13,
-    MJ_R_14,
-    MJ_R_15,
+#define MJ_ID_CODE_BIT(id)                                                                        \
+    (((id) >= MJ_L_0 && (id) < MJ_L_0 + MEJIRO_KEYS_PER_HAND)                                     \
+         ? (1u << ((id) - MJ_L_0))                                                                \
+     : ((id) >= MJ_R_0 && (id) < MJ_R_0 + MEJIRO_KEYS_PER_HAND)                                   \
+         ? (1u << (MEJIRO_CODE_R_SHIFT + (id) - MJ_R_0))                                          \
+     : (id) == MJ_MOD_H ? (MJ_MOD_BIT_H << MEJIRO_CODE_M_SHIFT)                                   \
+     : (id) == MJ_MOD_X ? (MJ_MOD_BIT_X << MEJIRO_CODE_M_SHIFT)                                   \
+                        : 0u)
 
-    /* Mods (32..) */
-    MJ_MOD_H = 32, /* '#' */
-    MJ_MOD_X = 33, /* '*' */
-};
@@ -0,0 +1,49 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * keymap の &mj から「position -> packed stroke code の 1 bit」の表をビルド時に作る。
+ * behavior_mejiro.c（central）と mejiro_half.c（split の peripheral）で共用する。
+ * peripheral でも keymap と &mj のノードは devicetree にある（driver が無いだけ）。
+ *
+ * 複数のレイヤーに &mj がある場合、同じ position には同じ id を置くこと（MJ_POSITION_CHECKS）。
+ * combo などの仮想 position は表の外。
+ */
+#pragma once
+
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+
+#include "mejiro/mejiro_key_ids.h"
+
+#define MJ_KEYMAP DT_INST(0, zmk_keymap)
+#define MJ_BEHAVIOR DT_INST(0, zmk_behavior_mejiro)
+
+#define MJ_IS_MJ(layer, idx) DT_SAME_NODE(DT_PHANDLE_BY_IDX(layer, bindings, idx), MJ_BEHAVIOR)
+#define MJ_PARAM_BIT(layer, idx) MJ_ID_CODE_BIT(DT_PHA_BY_IDX(layer, bindings, idx, param1))
+
+/* layer の idx 番目が &mj ならその bit、違えば（無ければ）0 */
+#define MJ_LAYER_BIT(layer, idx)                                                                  \
+    COND_CODE_1(DT_PROP_HAS_IDX(layer, bindings, idx),                                            \
+                (COND_CODE_1(MJ_IS_MJ(layer, idx), (MJ_PARAM_BIT(layer, idx)), (0u))), (0u))
+#define MJ_LAYER_BIT_OR(layer, idx) MJ_LAYER_BIT(layer, idx) |
+#define MJ_ALL_LAYERS_BIT(idx) (DT_FOREACH_CHILD_VARGS(MJ_KEYMAP, MJ_LAYER_BIT_OR, idx) 0u)
+
+#define MJ_CHECK_BINDING(layer, prop, idx)                                                        \
+    COND_CODE_1(MJ_IS_MJ(layer, idx),                                                             \
+                (BUILD_ASSERT(MJ_PARAM_BIT(layer, idx) != 0,                                      \
+                              "&mj parameter is not a Mejiro key id (dt-bindings/zmk/mejiro.h)"); \
+                 BUILD_ASSERT(MJ_ALL_LAYERS_BIT(idx) == MJ_PARAM_BIT(layer, idx),                 \
+                              "&mj at one position must use the same id on every layer");),       \
+                ())
+#define MJ_CHECK_LAYER(layer) DT_FOREACH_PROP_ELEM(layer, bindings, MJ_CHECK_BINDING)
+
+/* ファイルの先頭で 1 回 */
+#define MJ_POSITION_CHECKS DT_FOREACH_CHILD(MJ_KEYMAP, MJ_CHECK_LAYER)
+
+/* 同じ position が複数レイヤーに出ても値は同じ（上の BUILD_ASSERT） */
+#define MJ_TABLE_ENTRY(layer, prop, idx)                                                          \
+    COND_CODE_1(MJ_IS_MJ(layer, idx), ([idx] = MJ_PARAM_BIT(layer, idx),), ())
+#define MJ_TABLE_LAYER(layer) DT_FOREACH_PROP_ELEM(layer, bindings, MJ_TABLE_ENTRY)
+
+/* static const uint32_t table[ZMK_KEYMAP_LEN] = MJ_POSITION_BITS_INIT; */
+#define MJ_POSITION_BITS_INIT {DT_FOREACH_CHILD(MJ_KEYMAP, MJ_TABLE_LAYER)}
@@ -0,0 +1,41 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Per-stroke hit counters (CONFIG_ZMK_MEJIRO_PROFILE).
+ *
+ * 出力したストロークごとに回数を数え、ときどき settings ("mejiro/prof") に保存する。
+ * "chord prof" で {"stroke": count} の JSON を出し、scripts/mejiro_dictc.py --profile に
+ * 渡すと、よく使うものが bucket の先頭と常駐の hot table に並ぶ。数えた数や表の埋まり具合は
+ * "chord prof stats"。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mejiro_profile_stats {
+    uint32_t strokes; /* 数えたストローク数 */
+    uint32_t used;    /* 使っているスロット数 */
+    uint32_t dropped; /* 表が埋まっていて数えられなかった数 */
+    uint32_t saves;
+};
+
+/* 確定して出力したストローク 1 回 */
+void mejiro_profile_hit(uint32_t code);
+
+/* 回数の多い順ではなく表の順に列挙。cb が false を返したら止める */
+typedef bool (*mejiro_profile_visit_cb)(uint32_t code, uint32_t count, void *user_data);
+void mejiro_profile_foreach(mejiro_profile_visit_cb cb, void *user_data);
+
+/* 全部 0 にして保存も消す */
+void mejiro_profile_reset(void);
+
+void mejiro_profile_get_stats(struct mejiro_profile_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,6 +6,8 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,6 +16,15 @@ extern "C" {
 /* Returns true if sent. */
 bool mejiro_send_roman(const char *text);
 
+/* Same as mejiro_send_roman, with the timestamp stamped on every event. */
+bool mejiro_send_text(const char *text, int64_t timestamp);
+
+/* Tap BSPC count times (used for speculative rollback). */
+void mejiro_send_backspaces(size_t count, int64_t timestamp);
+
+/* Wait gap_ms between taps from now on (devicetree inter-key-gap-ms). */
+void mejiro_send_set_tap_gap(uint16_t gap_ms);
+
 #ifdef __cplusplus
 }
 #endif
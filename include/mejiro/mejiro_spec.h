@@ -0,0 +1,39 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Speculative emission (CONFIG_ZMK_MEJIRO_SPECULATIVE).
+ *
+ * ストロークの 1 キー目/2 キー目で最有力の解釈を即送信し、キーが足されて別の
+ * 解釈になったら「最小 BS + 差分」を 1 回のバーストで送り直す。
+ * 送った内容は journal に残すので巻き戻しは正確。推測するのはかな（と ー・、。「」）
+ * だけで、ローマ字や ASCII を出す項目は確定まで待つ（BS の数がホストの見え方で変わる）。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mejiro/mejiro_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mejiro_spec_stats {
+    uint32_t speculated;     /* 推測で送信（差し替え含む）した回数 */
+    uint32_t confirmed;      /* 確定時に推測がそのまま正解だった回数 */
+    uint32_t rollbacks;      /* BS を伴う差し替え回数 */
+    uint32_t rollback_chars; /* 送った BS の総数 */
+};
+
+/* Stroke in progress: partial = keys pressed so far. first_press opens the window. */
+void mejiro_spec_update(const struct mejiro_state *partial, int64_t first_press, int64_t timestamp);
+
+/* Stroke committed. Returns false if nothing was speculated (caller emits normally). */
+bool mejiro_spec_commit(const struct mejiro_state *latched, int64_t timestamp);
+
+void mejiro_spec_get_stats(struct mejiro_spec_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,53 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Split keyboards: half-stroke messages from the peripheral (mejiro_half.c) to the
+ * central (behavior_mejiro.c, mejiro_merge in mejiro_core.h).
+ *
+ * peripheral の &mj のキーは 1 つずつ central に送らず、半分のストロークごとに
+ * START と STROKE(code) の 2 つだけを送る。運ぶのは ZMK の input split
+ * （zmk,input-split）: peripheral の zmk,mejiro-half デバイスが input_report し、
+ * central の同じ reg の zmk,input-split から behavior_mejiro の split-input に届く。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* input event の type（Zephyr の INPUT_EV_VENDOR_START..STOP の範囲） */
+#define MEJIRO_SPLIT_EV_TYPE 0xf4
+
+/*
+ * code: START の value はそのストロークの最初の押下からの ms（ロールオーバーの切り出しで
+ * 後から分かったストロークは 0 でない）。STROKE の value は packed stroke code（その半分の
+ * bit だけ）。
+ */
+#define MEJIRO_SPLIT_CODE_START 1
+#define MEJIRO_SPLIT_CODE_STROKE 2
+
+/*
+ * peripheral でまとめるかどうか（&mj_half、既定は zmk,mejiro-half の enabled-by-default）。
+ * 切っている間は &mj のキーもそのまま central に送る（Mejiro 以外のレイヤーを使う時）。
+ */
+void mejiro_half_set_enabled(bool enabled);
+bool mejiro_half_enabled(void);
+
+/*
+ * peripheral の chord_seg の窓と確定の方式を central の chord tune（"mejiro"）に合わせる。
+ * central は値が変わった時と peripheral がつながった時に &mj_half を
+ * param1 = MEJIRO_SPLIT_HALF_TUNE、param2 = MEJIRO_SPLIT_HALF_TUNE_PARAM(...) で呼ぶ
+ * （GLOBAL なので peripheral で動く）。param1 は dt-bindings の MJ_HALF_* と重ならない値。
+ */
+#define MEJIRO_SPLIT_HALF_TUNE 0x80
+#define MEJIRO_SPLIT_HALF_TUNE_PARAM(window_ms, commit_mode)                                      \
+    ((uint32_t)(window_ms) | ((uint32_t)(commit_mode) << 16))
+
+void mejiro_half_tune(uint16_t window_ms, uint8_t commit_mode);
+
+#ifdef __cplusplus
+}
+#endif
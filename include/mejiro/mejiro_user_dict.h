@@ -0,0 +1,44 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * User dictionary overlay (CONFIG_ZMK_MEJIRO_USER_DICT).
+ *
+ * stroke code -> かな を settings ("mejiro/ud/<code>") に保存し、組み込みの表より先に引く。
+ * 登録されているコードの Bloom filter を RAM に持ち、載っていないストロークは
+ * ビット検査だけで弾く（大半のストロークは表に無いので、ここで終わる）。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mejiro_user_dict_stats {
+    uint32_t entries;
+    uint32_t rejected;        /* Bloom filter で弾いた数 */
+    uint32_t hits;
+    uint32_t false_positives; /* Bloom は通ったが表に無かった数 */
+};
+
+/* true なら out に UTF-8 のかなを書いた */
+bool mejiro_user_dict_lookup(uint32_t code, char *out, size_t out_len);
+
+/* 追加（同じコードは上書き）して settings に保存。0 or -errno */
+int mejiro_user_dict_add(uint32_t code, const char *text);
+
+/* 削除して settings からも消す。0 or -errno（無ければ -ENOENT） */
+int mejiro_user_dict_remove(uint32_t code);
+
+/* 登録順に列挙。cb が false を返したら止める */
+typedef bool (*mejiro_user_dict_visit_cb)(uint32_t code, const char *text, void *user_data);
+void mejiro_user_dict_foreach(mejiro_user_dict_visit_cb cb, void *user_data);
+
+void mejiro_user_dict_get_stats(struct mejiro_user_dict_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
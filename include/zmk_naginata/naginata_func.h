@@ -1,94 +1,141 @@
+#pragma once
 
-void naginata_on(void);
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zmk_naginata/nglistarray.h>
+
+// naginata_config.os
+#define NG_WINDOWS (uint8_t)0
+#define NG_MACOS (uint8_t)1
+#define NG_LINUX (uint8_t)2
+#define NG_IOS (uint8_t)3
+#define NG_OS_COUNT 4
+
+// 出力の待ち時間（ms）。behavior-naginata の devicetree プロパティから作る const。
+// *_ms[] は OS ごと（naginata_config.os で引く）
+struct naginata_timing {
+    uint16_t inter_key_gap_ms;               // かな出力の tap の間
+    uint16_t key_delay_ms[NG_OS_COUNT];      // IME 切り替えの後、16 進入力の桁の間
+    uint16_t modifier_delay_ms[NG_OS_COUNT]; // 修飾キーを押したままの連続入力の間
+    uint16_t sequence_delay_ms[NG_OS_COUNT]; // compose の後、押したままの修飾キーを離す前
+    uint16_t launcher_delay_ms[NG_OS_COUNT]; // GUI 押下からランチャーが開くまで
+};
+
+// 未設定なら bindings の既定値と同じもの。set は behavior の init から（timing は static）
+void naginata_set_timing(const struct naginata_timing *timing);
+const struct naginata_timing *naginata_get_timing(void);
+
+// 実行時の変更（コピーする）。NULL なら set_timing の値に戻す
+void naginata_update_timing(const struct naginata_timing *timing);
+
+// 出力先の OS（NG_WINDOWS..NG_IOS）と縦書き。変えると settings に残る（naginata_settings.h）
+uint8_t naginata_get_os(void);
+void naginata_set_os(uint8_t os);
+bool naginata_get_tategaki(void);
+void naginata_set_tategaki(bool tategaki);
+
+// 同時押しの判定（無シフト面・同時押し面の表引き、naginata_dict.c）。keys は判定待ちの
+// ストローク（押下順の keycode）で、全部取り除く。CONFIG_ZMK_NAGINATA_DICT=n の時は
+// behavior_naginata.c の既定がストロークを捨てる（先行シフト面だけで打つ）
+bool naginata_type_from_nglistarray(NGListArray *keys, int64_t timestamp);
+
+// 以下の関数（ngh_* など）の timestamp は送るイベントの時刻。呼び出し元（先行シフト /
+// 同時押し）がキーを読んだ時刻を渡す
+void naginata_on(int64_t timestamp);
 // void naginata_off(void);
-void nofunc(void);
-void switch_to_hex_input(void);
-void return_to_kana_input(void);
-void press_compose_key(void);
-void release_compose_key(void);
-void input_unicode_hex(int, int, int, int);
+void nofunc(int64_t timestamp);
+
+// CONFIG_ZMK_NAGINATA_UNICODE_HEX
+void switch_to_hex_input(int64_t timestamp);
+void return_to_kana_input(int64_t timestamp);
+void press_compose_key(int64_t timestamp);
+void release_compose_key(int64_t timestamp);
+void input_unicode_hex(int, int, int, int, int64_t timestamp);
+
+void ng_left(uint8_t, int64_t timestamp);
+void ng_right(uint8_t, int64_t timestamp);
+void ng_T(int64_t timestamp);
+void ng_Y(int64_t timestamp);
+void ng_ST(int64_t timestamp);
+void ng_SY(int64_t timestamp);
 
-void ng_T(void);
-void ng_Y(void);
-void ng_ST(void);
-void ng_SY(void);
-void ngh_JKQ(void);
-void ngh_JKW(void);
-void ngh_JKE(void);
-void ngh_JKR(void);
-void ngh_JKT(void);
-void ngh_JKA(void);
-void ngh_JKS(void);
-void ngh_JKD(void);
-void ngh_JKF(void);
-void ngh_JKG(void);
-void ngh_JKZ(void);
-void ngh_JKX(void);
-void ngh_JKC(void);
-void ngh_JKV(void);
-void ngh_JKB(void);
-void ngh_DFY(void);
-void ngh_DFU(void);
-void ngh_DFI(void);
-void ngh_DFO(void);
-void ngh_DFP(void);
-void ngh_DFH(void);
-void ngh_DFJ(void);
-void ngh_DFK(void);
-void ngh_DFL(void);
-void ngh_DFSCLN(void);
-void ngh_DFN(void);
-void ngh_DFM(void);
-void ngh_DFCOMM(void);
-void ngh_DFDOT(void);
-void ngh_DFSLSH(void);
-void ngh_MCQ(void);
-void ngh_MCW(void);
-void ngh_MCE(void);
-void ngh_MCR(void);
-void ngh_MCT(void);
-void ngh_MCA(void);
-void ngh_MCS(void);
-void ngh_MCD(void);
-void ngh_MCF(void);
-void ngh_MCG(void);
-void ngh_MCZ(void);
-void ngh_MCX(void);
-void ngh_MCC(void);
-void ngh_MCV(void);
-void ngh_MCB(void);
-void ngh_CVY(void);
-void ngh_CVU(void);
-void ngh_CVI(void);
-void ngh_CVO(void);
-void ngh_CVP(void);
-void ngh_CVH(void);
-void ngh_CVJ(void);
-void ngh_CVK(void);
-void ngh_CVL(void);
-void ngh_CVSCLN(void);
-void ngh_CVN(void);
-void ngh_CVM(void);
-void ngh_CVCOMM(void);
-void ngh_CVDOT(void);
-void ngh_CVSLSH(void);
-void ng_cut(void);
-void ng_copy(void);
-void ng_paste(void);
-void ng_up(uint8_t);
-void ng_down(uint8_t);
-void ng_left(uint8_t);
-void ng_right(uint8_t);
-void ng_next_row(void);
-void ng_prev_row(void);
-void ng_next_char(void);
-void ng_prev_char(void);
-void ng_home(void);
-void ng_end(void);
-void ng_katakana(void);
-void ng_save(void);
-void ng_hiragana(void);
-void ng_redo(void);
-void ng_undo(void);
-void ng_saihenkan(void);
-void ng_eof(void);
+// CONFIG_ZMK_NAGINATA_EDIT
+void ngh_JKQ(int64_t timestamp);
+void ngh_JKW(int64_t timestamp);
+void ngh_JKE(int64_t timestamp);
+void ngh_JKR(int64_t timestamp);
+void ngh_JKT(int64_t timestamp);
+void ngh_JKA(int64_t timestamp);
+void ngh_JKS(int64_t timestamp);
+void ngh_JKD(int64_t timestamp);
+void ngh_JKF(int64_t timestamp);
+void ngh_JKG(int64_t timestamp);
+void ngh_JKZ(int64_t timestamp);
+void ngh_JKX(int64_t timestamp);
+void ngh_JKC(int64_t timestamp);
+void ngh_JKV(int64_t timestamp);
+void ngh_JKB(int64_t timestamp);
+void ngh_DFY(int64_t timestamp);
+void ngh_DFU(int64_t timestamp);
+void ngh_DFI(int64_t timestamp);
+void ngh_DFO(int64_t timestamp);
+void ngh_DFP(int64_t timestamp);
+void ngh_DFH(int64_t timestamp);
+void ngh_DFJ(int64_t timestamp);
+void ngh_DFK(int64_t timestamp);
+void ngh_DFL(int64_t timestamp);
+void ngh_DFSCLN(int64_t timestamp);
+void ngh_DFN(int64_t timestamp);
+void ngh_DFM(int64_t timestamp);
+void ngh_DFCOMM(int64_t timestamp);
+void ngh_DFDOT(int64_t timestamp);
+void ngh_DFSLSH(int64_t timestamp);
+void ngh_MCQ(int64_t timestamp);
+void ngh_MCW(int64_t timestamp);
+void ngh_MCE(int64_t timestamp);
+void ngh_MCR(int64_t timestamp);
+void ngh_MCT(int64_t timestamp);
+void ngh_MCA(int64_t timestamp);
+void ngh_MCS(int64_t timestamp);
+void ngh_MCD(int64_t timestamp);
+void ngh_MCF(int64_t timestamp);
+void ngh_MCG(int64_t timestamp);
+void ngh_MCZ(int64_t timestamp);
+void ngh_MCX(int64_t timestamp);
+void ngh_MCC(int64_t timestamp);
+void ngh_MCV(int64_t timestamp);
+void ngh_MCB(int64_t timestamp);
+void ngh_CVY(int64_t timestamp);
+void ngh_CVU(int64_t timestamp);
+void ngh_CVI(int64_t timestamp);
+void ngh_CVO(int64_t timestamp);
+void ngh_CVP(int64_t timestamp);
+void ngh_CVH(int64_t timestamp);
+void ngh_CVJ(int64_t timestamp);
+void ngh_CVK(int64_t timestamp);
+void ngh_CVL(int64_t timestamp);
+void ngh_CVSCLN(int64_t timestamp);
+void ngh_CVN(int64_t timestamp);
+void ngh_CVM(int64_t timestamp);
+void ngh_CVCOMM(int64_t timestamp);
+void ngh_CVDOT(int64_t timestamp);
+void ngh_CVSLSH(int64_t timestamp);
+void ng_cut(int64_t timestamp);
+void ng_copy(int64_t timestamp);
+void ng_paste(int64_t timestamp);
+void ng_up(uint8_t, int64_t timestamp);
+void ng_down(uint8_t, int64_t timestamp);
+void ng_next_row(int64_t timestamp);
+void ng_prev_row(int64_t timestamp);
+void ng_next_char(int64_t timestamp);
+void ng_prev_char(int64_t timestamp);
+void ng_home(int64_t timestamp);
+void ng_end(int64_t timestamp);
+void ng_katakana(int64_t timestamp);
+void ng_save(int64_t timestamp);
+void ng_hiragana(int64_t timestamp);
+void ng_redo(int64_t timestamp);
+void ng_undo(int64_t timestamp);
+void ng_saihenkan(int64_t timestamp);
+void ng_eof(int64_t timestamp);
@@ -0,0 +1,86 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Naginata key index / bit (B_*) definitions.
+ * &ng の param1（keycode）-> キー番号。B_* は naginata_zmk_v16.rb の出力と同じ名前。
+ */
+#pragma once
+
+#include <stdint.h>
+
+enum naginata_key {
+    NG_K_Q = 0,
+    NG_K_W,
+    NG_K_E,
+    NG_K_R,
+    NG_K_T,
+    NG_K_Y,
+    NG_K_U,
+    NG_K_I,
+    NG_K_O,
+    NG_K_P,
+    NG_K_A,
+    NG_K_S,
+    NG_K_D,
+    NG_K_F,
+    NG_K_G,
+    NG_K_H,
+    NG_K_J,
+    NG_K_K,
+    NG_K_L,
+    NG_K_SEMI,
+    NG_K_Z,
+    NG_K_X,
+    NG_K_C,
+    NG_K_V,
+    NG_K_B,
+    NG_K_N,
+    NG_K_M,
+    NG_K_COMMA,
+    NG_K_DOT,
+    NG_K_SLASH,
+    NG_K_SPACE, /* 親指シフト（ng SPACE） */
+    NG_K_SQT,   /* 追加シフト（ng SQT） */
+
+    NG_KEY_COUNT,
+    NG_K_NONE = 0xFF,
+};
+
+#define B_Q (1UL << NG_K_Q)
+#define B_W (1UL << NG_K_W)
+#define B_E (1UL << NG_K_E)
+#define B_R (1UL << NG_K_R)
+#define B_T (1UL << NG_K_T)
+#define B_Y (1UL << NG_K_Y)
+#define B_U (1UL << NG_K_U)
+#define B_I (1UL << NG_K_I)
+#define B_O (1UL << NG_K_O)
+#define B_P (1UL << NG_K_P)
+#define B_A (1UL << NG_K_A)
+#define B_S (1UL << NG_K_S)
+#define B_D (1UL << NG_K_D)
+#define B_F (1UL << NG_K_F)
+#define B_G (1UL << NG_K_G)
+#define B_H (1UL << NG_K_H)
+#define B_J (1UL << NG_K_J)
+#define B_K (1UL << NG_K_K)
+#define B_L (1UL << NG_K_L)
+#define B_SEMI (1UL << NG_K_SEMI)
+#define B_Z (1UL << NG_K_Z)
+#define B_X (1UL << NG_K_X)
+#define B_C (1UL << NG_K_C)
+#define B_V (1UL << NG_K_V)
+#define B_B (1UL << NG_K_B)
+#define B_N (1UL << NG_K_N)
+#define B_M (1UL << NG_K_M)
+#define B_COMMA (1UL << NG_K_COMMA)
+#define B_DOT (1UL << NG_K_DOT)
+#define B_SLASH (1UL << NG_K_SLASH)
+#define B_SPACE (1UL << NG_K_SPACE)
+#define B_SQT (1UL << NG_K_SQT)
+
+/* 先行シフト面を持つキー（naginata_shift.c）。ng SQT は同時押し面なので入らない */
+#define B_SHIFTS B_SPACE
+
+/* keycode (&ng の param1) -> enum naginata_key。該当なしは NG_K_NONE */
+uint8_t naginata_key_index(uint32_t keycode);
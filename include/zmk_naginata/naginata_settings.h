@@ -0,0 +1,24 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * naginata_config（OS、縦書き）と OS ごとの待ち時間を settings の "chord/ng" に残す
+ * （CONFIG_ZMK_CHORD_PERSIST）。書くのは chord_persist がまとめて後で。
+ */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Load chord/ng now (behavior_naginata_init). 0 or -errno. */
+int naginata_settings_load(void);
+
+/* naginata_config or the timing changed: schedule a write. */
+void naginata_settings_changed(void);
+
+/* Write pending changes now. */
+int naginata_settings_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * 親指先行シフト / 連続シフトの状態機械。
+ *
+ * ng SPACE を先に押し下げている間は、各キーの押下をその場で
+ * 「シフト面[キー番号]」の 1 回の表引きで確定する（O(1)、同時押し窓の待ち無し）。
+ * ng SQT は同時押し面（README）なので、ここでは扱わず通常の判定に回る。
+ * 押したままなら何打でも連続でシフトされる。
+ * シフト面に無いキーは {シフト, キー} のストロークとして通常の判定に回す。
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 通常の判定（同時押し判定）に回すストローク。keys は keycode。kana_out の出力の順番で呼ぶ */
+typedef void (*naginata_shift_fallback_cb)(const uint32_t *keys, uint8_t count, int64_t timestamp);
+
+struct naginata_shift_stats {
+    uint32_t resolved;  /* シフト面で即確定した打鍵数 */
+    uint32_t fallback;  /* シフト面に無く通常判定へ回した数 */
+    uint32_t bare;      /* シフトキー単打（何も打たずに離した）数 */
+};
+
+void naginata_shift_init(naginata_shift_fallback_cb fallback);
+
+/*
+ * 押下。true ならシフト状態機械が消費した（chord_seg に渡さない）。
+ * chord_pending: 他のキーが既に同時押し判定中か（その場合シフトキーは先行ではない）
+ */
+bool naginata_shift_press(uint32_t keycode, bool chord_pending, int64_t timestamp);
+
+/* 離上。true なら消費した */
+bool naginata_shift_release(uint32_t keycode, int64_t timestamp);
+
+/* いずれかのシフト面が有効か */
+bool naginata_shift_active(void);
+
+void naginata_shift_get_stats(struct naginata_shift_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,10 +1,15 @@
 #pragma once
 #include <zephyr/device.h>
+#include <zephyr/sys/util.h>
 
-#define LIST_SIZE 22 // 集合の最大サイズ
+#include <chord/chord_seg.h>
+#include <zmk_naginata/naginata_keys.h>
+
+// 集合の最大サイズ: 1 ストロークのキー（chord_seg の上限、薙刀式のキーの数を超えない）
+#define NG_LIST_SIZE MIN(CHORD_STROKE_MAX_KEYS, NG_KEY_COUNT)
 
 typedef struct {
-    uint32_t elements[LIST_SIZE];
+    uint32_t elements[NG_LIST_SIZE];
     int size;
 } NGList;
 
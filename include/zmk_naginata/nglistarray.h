@@ -1,10 +1,11 @@
 #pragma once
 #include <zmk_naginata/nglist.h>
 
-#define LIST_SIZE 22 // 集合の最大サイズ
+// 判定待ちのストロークの最大数（chord_seg が同時に持てる数）
+#define NG_LIST_ARRAY_SIZE CHORD_SEG_MAX_PENDING
 
 typedef struct {
-    NGList elements[LIST_SIZE];
+    NGList elements[NG_LIST_ARRAY_SIZE];
     int size;
 } NGListArray;
 
@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Host companion: type the text the keyboard commits, bypassing romaji keycodes.
+
+    python3 scripts/chord_companion.py /dev/ttyACM1
+    python3 scripts/chord_companion.py COM5 --print     # 入力せず表示だけ
+
+CONFIG_ZMK_CHORD_COMPANION のキーボードに HELLO を送り続け、届いた TEXT フレーム
+（確定したかな、UTF-8）をそのまま入力して返事をする。止めるとキーボードは
+lease（既定 2 s）が切れるか BYE で keycode に戻る。プロトコルは
+include/chord/chord_companion.h を参照。native_sim では UART が pty になるので、
+そのパスを渡せば同じように動く。
+
+入力の方法:
+  windows : SendInput (KEYEVENTF_UNICODE)
+  x11     : xdotool type
+  wayland : wtype
+  macos   : osascript (System Events)
+  print   : 標準出力へ（確認用）
+
+pyserial が必要（pip install pyserial）。
+"""
+
+import argparse
+import binascii
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import time
+
+SYNC = b"\xa5\x4b"
+RESP = 0x80
+VERSION = 1
+HELLO, TEXT, BYE, CANCEL = 1, 2, 3, 4
+LEN_MAX = 1024  # CONFIG_ZMK_CHORD_COMPANION_FRAME_MAX の上限
+
+
+def frame(ftype, payload=b""):
+    body = struct.pack("<BH", ftype, len(payload)) + payload
+    return SYNC + body + struct.pack("<H", binascii.crc_hqx(body, 0))
+
+
+class Link:
+    def __init__(self, port, baud, timeout):
+        import serial  # pyserial
+
+        self.ser = serial.Serial(port, baud, timeout=timeout)
+        self.buf = b""
+
+    def write(self, ftype, payload=b""):
+        self.ser.write(frame(ftype, payload))
+
+    def read_frame(self):
+        """-> (type, payload) or None when nothing complete arrived in time."""
+        self.buf += self.ser.read(max(1, self.ser.in_waiting))
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                self.buf = self.buf[-1:]
+                return None
+            self.buf = self.buf[start:]
+            if len(self.buf) < 5:
+                return None
+            ftype, length = struct.unpack("<BH", self.buf[2:5])
+            if length > LEN_MAX:
+                self.buf = self.buf[1:]
+                continue
+            end = 5 + length + 2
+            if len(self.buf) < end:
+                return None
+            body, (crc,) = self.buf[2 : 5 + length], struct.unpack("<H", self.buf[5 + length : end])
+            if binascii.crc_hqx(body, 0) != crc:
+                # SYNC に見えた別のバイト列: 1 byte ずらして探し直す
+                self.buf = self.buf[1:]
+                continue
+            self.buf = self.buf[end:]
+            return ftype, body[3:]
+
+
+# ---- injection -------------------------------------------------------------
+
+
+def inject_print(text):
+    out = []
+    for ch in text:
+        out.append("\b \b" if ch == "\b" else ch)
+    sys.stdout.write("".join(out))
+    sys.stdout.flush()
+
+
+def make_windows():
+    import ctypes
+    from ctypes import wintypes
+
+    INPUT_KEYBOARD = 1
+    KEYEVENTF_KEYUP = 0x0002
+    KEYEVENTF_UNICODE = 0x0004
+    VK_BACK = 0x08
+
+    class KEYBDINPUT(ctypes.Structure):
+        _fields_ = [
+            ("wVk", wintypes.WORD),
+            ("wScan", wintypes.WORD),
+            ("dwFlags", wintypes.DWORD),
+            ("time", wintypes.DWORD),
+            ("dwExtraInfo", ctypes.c_size_t),
+        ]
+
+    class INPUT(ctypes.Structure):
+        class _U(ctypes.Union):
+            # MOUSEINPUT が一番大きいので、その大きさに合わせる
+            _fields_ = [("ki", KEYBDINPUT), ("pad", ctypes.c_byte * 32)]
+
+        _anonymous_ = ("u",)
+        _fields_ = [("type", wintypes.DWORD), ("u", _U)]
+
+    send_input = ctypes.windll.user32.SendInput
+
+    def key(vk=0, scan=0, flags=0):
+        i = INPUT(type=INPUT_KEYBOARD)
+        i.ki = KEYBDINPUT(vk, scan, flags, 0, 0)
+        return i
+
+    def inject(text):
+        events = []
+        for ch in text:
+            if ch == "\b":
+                events += [key(vk=VK_BACK), key(vk=VK_BACK, flags=KEYEVENTF_KEYUP)]
+                continue
+            # BMP の外はサロゲートペアで 2 つ
+            units = ch.encode("utf-16-le")
+            for k in range(0, len(units), 2):
+                scan = int.from_bytes(units[k : k + 2], "little")
+                events += [
+                    key(scan=scan, flags=KEYEVENTF_UNICODE),
+                    key(scan=scan, flags=KEYEVENTF_UNICODE | KEYEVENTF_KEYUP),
+                ]
+        arr = (INPUT * len(events))(*events)
+        send_input(len(events), arr, ctypes.sizeof(INPUT))
+
+    return inject
+
+
+def split_backspaces(text):
+    """'か\\b\\bき' -> [('text', 'か'), ('bs', 2), ('text', 'き')]"""
+    parts = []
+    for ch in text:
+        kind = "bs" if ch == "\b" else "text"
+        if parts and parts[-1][0] == kind:
+            parts[-1] = (kind, parts[-1][1] + (1 if kind == "bs" else ch))
+        else:
+            parts.append((kind, 1 if kind == "bs" else ch))
+    return parts
+
+
+def make_command(type_cmd, bs_cmd):
+    def inject(text):
+        for kind, value in split_backspaces(text):
+            if kind == "bs":
+                subprocess.run(bs_cmd(value), check=False)
+            else:
+                subprocess.run(type_cmd(value), check=False)
+
+    return inject
+
+
+def applescript_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+INJECTORS = {
+    "print": lambda: inject_print,
+    "windows": make_windows,
+    "x11": lambda: make_command(
+        lambda s: ["xdotool", "type", "--delay", "0", "--", s],
+        lambda n: ["xdotool", "key", "--delay", "0"] + ["BackSpace"] * n,
+    ),
+    "wayland": lambda: make_command(
+        lambda s: ["wtype", "--", s],
+        lambda n: ["wtype"] + ["-k", "BackSpace"] * n,
+    ),
+    "macos": lambda: make_command(
+        lambda s: ["osascript", "-e",
+                   f'tell application "System Events" to keystroke {applescript_string(s)}'],
+        lambda n: ["osascript", "-e",
+                   f'tell application "System Events" to repeat {n} times\n'
+                   "key code 51\nend repeat"],
+    ),
+}
+
+
+def default_injector():
+    if sys.platform == "win32":
+        return "windows"
+    if sys.platform == "darwin":
+        return "macos"
+    if os.environ.get("WAYLAND_DISPLAY") and shutil.which("wtype"):
+        return "wayland"
+    return "x11"
+
+
+# ---- main loop -------------------------------------------------------------
+
+
+def serve(link, inject, hello_interval, verbose):
+    next_hello = 0.0
+    frames = chars = 0
+    typed = cancelled = None  # 最後に入力した seq / 取り消した seq
+    t0 = time.monotonic()
+
+    while True:
+        now = time.monotonic()
+        if now >= next_hello:
+            link.write(HELLO, bytes([VERSION]))
+            next_hello = now + hello_interval
+
+        got = link.read_frame()
+        if not got:
+            continue
+        ftype, payload = got
+        if ftype == HELLO | RESP and len(payload) >= 3:
+            if verbose:
+                version, frame_max = struct.unpack("<BH", payload[:3])
+                print(f"keyboard: version {version}, frame max {frame_max}", file=sys.stderr)
+            continue
+        if ftype == CANCEL and payload:
+            # 返事が落ちた: 入力済みならそう答える。まだなら、この seq は後で届いても捨てる
+            seq = payload[0]
+            if seq != typed:
+                cancelled = seq
+            link.write(CANCEL | RESP, bytes([seq, seq == typed]))
+            continue
+        if ftype != TEXT or not payload:
+            continue
+
+        seq, text = payload[0], payload[1:].decode("utf-8", errors="replace")
+        if seq == cancelled:
+            # キーボードは keycode で送り直している
+            continue
+        inject(text)
+        typed = seq
+        # 入力し終えてから返事（キーボードは返事までの分を次のフレームにまとめる）
+        link.write(TEXT | RESP, bytes([seq]))
+        frames += 1
+        chars += len(text)
+        if verbose:
+            rate = chars / max(time.monotonic() - t0, 1e-3)
+            print(f"\n[{frames} frames, {chars} chars, {rate:.1f} chars/s]", file=sys.stderr)
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("port", help="serial port (e.g. /dev/ttyACM1, COM5, native_sim pty)")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--inject", choices=sorted(INJECTORS), default=None,
+                    help=f"how to type the text (default here: {default_injector()})")
+    ap.add_argument("--print", dest="inject", action="store_const", const="print",
+                    help="same as --inject print")
+    ap.add_argument("--hello", type=float, default=0.5,
+                    help="HELLO interval in seconds, < CONFIG_ZMK_CHORD_COMPANION_LEASE_MS "
+                         "(default 0.5)")
+    ap.add_argument("-v", "--verbose", action="store_true")
+    args = ap.parse_args(argv)
+
+    inject = INJECTORS[args.inject or default_injector()]()
+    link = Link(args.port, args.baud, timeout=min(args.hello, 0.05))
+    try:
+        serve(link, inject, args.hello, args.verbose)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        # すぐ keycode に戻させる
+        link.write(BYE)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
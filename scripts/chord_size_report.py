@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Flash / RAM per feature group, from the linker map of a build.
+
+    west build -t chord_size_report
+    west build -t chord_ram_report        # 静的 RAM を変数ごとに
+    python3 scripts/chord_size_report.py build/zephyr/zephyr.map [-v | --ram]
+
+GNU ld の map（Zephyr の zephyr.map、host の corpus_bench.map）を読み、リンクされた
+入力セクションをこのモジュールのファイル名と関数名で機能グループ（Kconfig の
+ZMK_MEJIRO_ENGINE / ZMK_NAGINATA / ZMK_NAGINATA_EDIT ... と同じ単位）に分けて足す。
+-ffunction-sections なら 1 関数 1 セクション、そうでなければセクション内のシンボルの
+アドレスの差で分ける（static 関数はその前の global シンボルに入る）。
+
+flash = text / rodata / data の初期値、RAM = data / bss / noinit。
+リンクされなかった（--gc-sections で落ちた）ものは数えない。
+
+--ram はグループごとに RAM にある変数（nginput、chord_seg の ring、kana_out の
+キューなど）を大きい順に出す。容量は Kconfig の CONFIG_ZMK_CHORD_MAX_STROKE_KEYS /
+CONFIG_ZMK_CHORD_MAX_PENDING_STROKES / *_QUEUE_LEN などで決まる。
+"""
+
+import argparse
+import re
+import sys
+from collections import defaultdict
+
+# (group, object file stem, function / variable name pattern or None)。上から順に最初に合うもの
+NG_SHIFT_HELPERS = r"ng_(left|right|T|Y|ST|SY)$"
+RULES = [
+    ("naginata unicode hex", "naginata_func",
+     r"(input_unicode_hex|switch_to_hex_input|return_to_kana_input|press_compose_key|"
+     r"release_compose_key)$"),
+    ("naginata", "naginata_func", NG_SHIFT_HELPERS),
+    ("naginata edit", "naginata_func",
+     r"(ngh_\w+|ng_(cut|copy|paste|up|down|next_row|prev_row|next_char|prev_char|home|end|"
+     r"katakana|save|hiragana|redo|undo|saihenkan|eof))$"),
+    ("naginata", "naginata_func", None),
+    ("naginata", "behavior_naginata", None),
+    ("naginata dict", "naginata_dict", None),
+    ("naginata", "naginata_keys", None),
+    ("naginata", "naginata_shift", None),
+    ("naginata", "nglist", None),
+    ("naginata", "nglistarray", None),
+    ("mejiro", "mejiro_core", None),
+    ("mejiro", "mejiro_send_roman", None),
+    ("mejiro", "behavior_mejiro", None),
+    ("mejiro", "mejiro_tables", None),
+    ("mejiro user dict", "mejiro_user_dict", None),
+    ("mejiro flash dict", "mejiro_flash_dict", None),
+    ("mejiro flash dict", "kana_pack", None),
+    ("mejiro dict update", "mejiro_dict_update", None),
+    ("mejiro dict update", "mejiro_dict_update_uart", None),
+    ("mejiro profile", "mejiro_profile", None),
+    ("mejiro speculative", "mejiro_spec", None),
+    ("mejiro split", "mejiro_half", None),
+    ("mejiro split", "behavior_mejiro_half", None),
+    ("chord core", "chord_engine", None),
+    ("chord core", "chord_power", None),
+    ("chord core", "chord_seg", None),
+    ("chord core", "chord_shell", None),
+    ("chord core", "kana_out", None),
+    ("chord adaptive window", "chord_timing", None),
+    ("chord tune", "chord_tune", None),
+    ("chord tune", "naginata_tune", None),
+    ("chord persist", "chord_persist", None),
+    ("chord persist", "naginata_settings", None),
+    ("chord companion", "chord_companion", None),
+    ("chord companion", "chord_companion_uart", None),
+]
+RULES = [(g, stem, re.compile(pat) if pat else None) for g, stem, pat in RULES]
+STEMS = {stem for _, stem, _ in RULES}
+
+OBJ_RE = re.compile(r"([A-Za-z0-9_]+)\.c\.o(?:bj)?\)?$")
+HEX = r"0x[0-9a-fA-F]+"
+REGION_RE = re.compile(rf"^(\S+)\s+({HEX})\s+({HEX})\s*(\S*)\s*$")
+OUT_RE = re.compile(rf"^(\S+)\s+({HEX})\s+({HEX})(?:\s+load address\s+({HEX}))?")
+IN_RE = re.compile(rf"^ (\S+)(?:\s+({HEX})\s+({HEX})\s+(\S.*))?$")
+CONT_RE = re.compile(rf"^\s+({HEX})\s+({HEX})\s+(\S.*)$")
+SYM_RE = re.compile(rf"^\s+({HEX})\s+([A-Za-z_][A-Za-z0-9_.$]*)\s*$")
+
+
+def classify(stem, name):
+    for group, rule_stem, pat in RULES:
+        if rule_stem == stem and (pat is None or (name and pat.match(name))):
+            return group
+    return None
+
+
+class Section:
+    def __init__(self, name, addr, size, obj, kind):
+        self.name, self.addr, self.size, self.obj, self.kind = name, addr, size, obj, kind
+        self.symbols = []
+
+    def pieces(self):
+        """-> [(name, size)]: シンボルごと。-ffunction-sections ならセクション名の末尾"""
+        m = re.match(r"\.(?:text|rodata|data|bss|noinit)\w*\.(?:rel\.)?(?:ro\.)?(?:local\.)?(.+)$",
+                     self.name)
+        syms = sorted(s for s in self.symbols if self.addr <= s[0] < self.addr + self.size)
+        if m or not syms:
+            return [(m.group(1) if m else (syms[0][1] if syms else None), self.size)]
+        out = []
+        if syms[0][0] > self.addr:
+            out.append((None, syms[0][0] - self.addr))
+        for i, (addr, name) in enumerate(syms):
+            end = syms[i + 1][0] if i + 1 < len(syms) else self.addr + self.size
+            out.append((name, end - addr))
+        return out
+
+
+def parse_map(lines):
+    regions = []  # (origin, end, is_ram)
+    sections = []
+    in_memcfg = in_map = False
+    kind = "flash"
+    pending = None  # 名前だけの行（長いセクション名は次の行に addr size file）
+    cur = None
+
+    for line in lines:
+        line = line.rstrip("\n")
+        if line.startswith("Memory Configuration"):
+            in_memcfg = True
+            continue
+        if line.startswith("Linker script and memory map"):
+            in_memcfg, in_map = False, True
+            continue
+        if in_memcfg:
+            m = REGION_RE.match(line)
+            if m and m.group(1) not in ("Name", "*default*"):
+                origin, length = int(m.group(2), 16), int(m.group(3), 16)
+                regions.append((origin, origin + length, "w" in m.group(4)))
+            continue
+        if not in_map or not line:
+            continue
+
+        if not line[0].isspace():
+            m = OUT_RE.match(line)
+            if m:
+                kind = out_kind(m.group(1), int(m.group(2), 16), m.group(4), regions)
+            pending = cur = None
+            continue
+
+        m = SYM_RE.match(line)
+        if m and cur is not None:
+            cur.symbols.append((int(m.group(1), 16), m.group(2)))
+            continue
+
+        if pending is not None:
+            m = CONT_RE.match(line)
+            name, pending = pending, None
+            if m:
+                cur = add_section(sections, name, m.group(1), m.group(2), m.group(3), kind)
+                continue
+
+        m = IN_RE.match(line)
+        if m and not m.group(1).startswith("*"):
+            if m.group(2) is None:
+                pending, cur = m.group(1), None
+            else:
+                cur = add_section(sections, m.group(1), m.group(2), m.group(3), m.group(4), kind)
+            continue
+        cur = None
+    return sections
+
+
+NOT_LOADED = (".debug", ".comment", ".note", ".stab", ".ARM.attributes", ".symtab", ".strtab",
+              ".shstrtab", "/DISCARD/")
+
+
+def out_kind(name, vma, load, regions):
+    if name.startswith(NOT_LOADED):
+        return None
+    if regions:
+        ram = any(lo <= vma < hi and is_ram for lo, hi, is_ram in regions)
+    else:
+        # host の map には RAM / FLASH の区別が無い。.data.rel.ro は MCU なら rodata
+        data = "data" in name and "rodata" not in name and "rel.ro" not in name
+        ram = data or "bss" in name or "noinit" in name
+        load = load or data
+    if not ram:
+        return "flash"
+    return "both" if load else "ram"
+
+
+def add_section(sections, name, addr, size, obj, kind):
+    m = OBJ_RE.search(obj.strip())
+    if kind is None or not m or m.group(1) not in STEMS:
+        return None
+    sec = Section(name, int(addr, 16), int(size, 16), m.group(1), kind)
+    if sec.size:
+        sections.append(sec)
+    return sec
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("map", help="linker map (build/zephyr/zephyr.map)")
+    ap.add_argument("-v", "--verbose", action="store_true", help="list symbols per group")
+    ap.add_argument("--ram", action="store_true", help="list the static RAM of each group")
+    args = ap.parse_args(argv)
+
+    try:
+        with open(args.map, encoding="utf-8", errors="replace") as f:
+            sections = parse_map(f)
+    except OSError as e:
+        print(f"{args.map}: {e.strerror} (build first)", file=sys.stderr)
+        return 1
+
+    flash = defaultdict(int)
+    ram = defaultdict(int)
+    detail = defaultdict(lambda: defaultdict(int))
+    ram_detail = defaultdict(lambda: defaultdict(int))
+    for sec in sections:
+        for name, size in sec.pieces():
+            group = classify(sec.obj, name) or classify(sec.obj, None) or "other"
+            if sec.kind in ("flash", "both"):
+                flash[group] += size
+            if sec.kind in ("ram", "both"):
+                ram[group] += size
+                ram_detail[group][f"{sec.obj}:{name or sec.name}"] += size
+            detail[group][f"{sec.obj}:{name or sec.name}"] += size
+
+    if not detail:
+        print(f"{args.map}: no objects of this module linked", file=sys.stderr)
+        return 1
+
+    order = [g for g in dict.fromkeys(g for g, _, _ in RULES) if g in detail]
+    if args.ram:
+        for g in order:
+            if not ram[g]:
+                continue
+            print(f"{g:<52}{ram[g]:>8}")
+            for name, size in sorted(ram_detail[g].items(), key=lambda kv: -kv[1]):
+                print(f"    {name:<48}{size:>8}")
+        print(f"{'total':<52}{sum(ram.values()):>8}")
+        return 0
+
+    print(f"{'group':<24}{'flash':>10}{'ram':>10}")
+    for g in order:
+        print(f"{g:<24}{flash[g]:>10}{ram[g]:>10}")
+        if args.verbose:
+            for name, size in sorted(detail[g].items(), key=lambda kv: -kv[1]):
+                print(f"    {name:<44}{size:>8}")
+    print(f"{'total':<24}{sum(flash.values()):>10}{sum(ram.values()):>10}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
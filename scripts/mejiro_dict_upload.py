@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Upload a Mejiro dictionary image over UART / USB CDC-ACM.
+
+    python3 scripts/mejiro_dict_upload.py /dev/ttyACM1 mejiro_dict.bin
+
+イメージ（scripts/mejiro_dictc.py の出力）を使っていない方の辞書パーティションへ
+流し込み、キーボード側で CRC を確かめて切り替える。途中で切れても有効な辞書は
+そのまま。プロトコルは include/mejiro/mejiro_dict_update.h を参照。
+native_sim では UART が pty になるので、そのパスを渡せば同じように動く。
+
+pyserial が必要（pip install pyserial）。
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+import time
+import zlib
+
+SYNC = b"\xa5\x5a"
+RESP = 0x80
+BEGIN, DATA, END, ABORT, INFO = 1, 2, 3, 4, 5
+NAMES = {BEGIN: "BEGIN", DATA: "DATA", END: "END", ABORT: "ABORT", INFO: "INFO"}
+
+
+def frame(ftype, payload=b""):
+    body = struct.pack("<BH", ftype, len(payload)) + payload
+    return SYNC + body + struct.pack("<H", binascii.crc_hqx(body, 0))
+
+
+class Link:
+    def __init__(self, port, baud, timeout, retries):
+        import serial  # pyserial
+
+        self.ser = serial.Serial(port, baud, timeout=timeout)
+        self.timeout = timeout
+        self.retries = retries
+
+    def read_frame(self):
+        """-> (type, payload) or None on timeout / bad CRC."""
+        state = b""
+        while state != SYNC:
+            b = self.ser.read(1)
+            if not b:
+                return None
+            state = (state + b)[-2:]
+        hdr = self.ser.read(3)
+        if len(hdr) != 3:
+            return None
+        ftype, length = struct.unpack("<BH", hdr)
+        rest = self.ser.read(length + 2)
+        if len(rest) != length + 2:
+            return None
+        payload, (crc,) = rest[:length], struct.unpack("<H", rest[length:])
+        if binascii.crc_hqx(hdr + payload, 0) != crc:
+            return None
+        return ftype, payload
+
+    def request(self, ftype, payload=b"", timeout=None):
+        """Send and wait for the matching response. -> (status, value)"""
+        self.ser.timeout = timeout or self.timeout
+        try:
+            for _ in range(self.retries):
+                self.ser.write(frame(ftype, payload))
+                resp = self.read_frame()
+                if resp and resp[0] == ftype | RESP and len(resp[1]) == 8:
+                    return struct.unpack("<iI", resp[1])
+        finally:
+            self.ser.timeout = self.timeout
+        raise TimeoutError(f"no response to {NAMES.get(ftype, ftype)}")
+
+
+def upload(link, image, chunk, erase_timeout):
+    # BEGIN はパーティションを消し終えてから答える。待ちきれずに送り直しても
+    # 同じイメージなら消し直さない
+    status, slot = link.request(BEGIN, struct.pack("<II", len(image), zlib.crc32(image)),
+                                timeout=erase_timeout)
+    if status:
+        raise RuntimeError(f"BEGIN failed ({status})")
+    print(f"writing {len(image)} bytes to slot {'AB'[slot]}")
+
+    off = 0
+    while off < len(image):
+        data = image[off : off + chunk]
+        status, nxt = link.request(DATA, struct.pack("<I", off) + data)
+        if status and nxt == off:
+            raise RuntimeError(f"DATA at {off} failed ({status})")
+        # 応答が落ちて再送した場合などはキーボード側の offset に合わせる
+        off = nxt
+        print(f"\r{off * 100 // len(image):3d}%", end="", flush=True)
+    print()
+
+    status, slot = link.request(END)
+    if status:
+        raise RuntimeError(f"verify/switch failed ({status}), previous dictionary kept")
+    return slot
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("port", help="serial port (e.g. /dev/ttyACM1, COM5, native_sim pty)")
+    ap.add_argument("image", nargs="?", help="dictionary image; omit to show the active slot")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--chunk", type=int, default=256,
+                    help="<= CONFIG_ZMK_MEJIRO_DICT_UPDATE_CHUNK_MAX (default 256)")
+    ap.add_argument("--timeout", type=float, default=2.0,
+                    help="per-frame timeout in seconds (default 2.0)")
+    ap.add_argument("--erase-timeout", type=float, default=20.0,
+                    help="timeout for BEGIN, which erases the partition (default 20.0)")
+    ap.add_argument("--retries", type=int, default=5)
+    args = ap.parse_args(argv)
+
+    link = Link(args.port, args.baud, args.timeout, args.retries)
+
+    if not args.image:
+        _, slot = link.request(INFO)
+        print(f"active slot {'AB'[slot]}")
+        return 0
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+
+    t0 = time.monotonic()
+    try:
+        slot = upload(link, image, args.chunk, args.erase_timeout)
+    except (RuntimeError, TimeoutError) as e:
+        try:
+            link.request(ABORT)
+        except TimeoutError:
+            pass
+        print(f"error: {e}", file=sys.stderr)
+        return 1
+
+    print(f"active slot {'AB'[slot]} ({time.monotonic() - t0:.1f} s)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,446 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""
+Mejiro dictionary compiler: Plover-style JSON -> flash dictionary image.
+
+    python3 scripts/mejiro_dictc.py dict.json -o mejiro_dict.bin [--profile counts.json]
+    python3 scripts/mejiro_dictc.py --check dict.json ...
+
+入力は {"stroke": "かな", ...}。stroke は mejiro_build_stroke_string() と同じ表記
+（左 "stkNnyiaU#*"、'-' の後が右）。"/" で区切った複数ストロークはイメージには入れないが、
+検査はする。
+
+検査（毎回。--check なら検査だけ、--strict なら問題があれば失敗）:
+  - duplicate : 違う書き方・別ファイルで同じストロークに別の出力
+  - prefix    : "A/B" の前半 "A" が単独でも登録されている（A が離上で確定して B に届かない）
+  - unreachable: include/dt-bindings/zmk/mejiro.h に ID の無いキー、
+                 CONFIG_ZMK_CHORD_MAX_STROKE_KEYS を超えるキー数
+エントリ単位の検査は -j で全コアに分ける。
+
+--profile にはキーボードの "chord prof" の出力（{"stroke": count}）を渡す。
+回数の多いものから page 0 の hot table（RAM 常駐）に入れ、各 bucket の中も
+回数の多い順に並べる。
+
+出力の形式は include/mejiro/mejiro_flash_dict.h を参照。できたイメージを
+mejiro_dict_partition の先頭に書き込む（例: nrfjprog --program ... / west flash の追加イメージ）。
+"""
+
+import argparse
+import functools
+import json
+import os
+import re
+import struct
+import sys
+import time
+import zlib
+from concurrent.futures import ProcessPoolExecutor
+
+MAGIC = 0x31444A4D  # "MJD1"
+VERSION = 3
+HEADER = struct.Struct("<IHHIII")
+REC_HDR = 4  # u24 code + u8 len
+OUTPUT_MAX = 32  # MEJIRO_OUTPUT_MAX（UTF-8 + NUL）
+
+# ---- packed text（include/chord/kana_pack.h と同じ符号表） ----
+TOK_ESC = 0x7F
+TOK_HIRA = 0x80
+TOK_PUNCT = 0xD6
+TOK_KATA = 0xDC
+TOK_BIGRAM = 0xDD
+HIRA_FIRST, HIRA_COUNT, KATA_OFFSET = 0x3041, 86, 0x60
+PUNCT = "ー、。「」・"
+# src/kana_pack.c の bigrams[] と同じ順
+BIGRAMS = [
+    "ょう", "ゅう", "った", "って", "ます", "した", "する", "です", "ない",
+    "こと", "いる", "ある", "れる", "から", "まし", "その", "この", "ため",
+    "もの", "よう", "しょ", "しゅ", "きょ", "ちょ", "じょ", "じゅ", "りょ",
+    "せい", "とう", "こう", "しい", "ける", "いう", "なる", "られ",
+]
+assert TOK_BIGRAM + len(BIGRAMS) == 0x100
+
+
+def pack_text(text):
+    out = bytearray()
+    i = 0
+    while i < len(text):
+        pair = text[i : i + 2]
+        if pair in BIGRAMS:
+            out.append(TOK_BIGRAM + BIGRAMS.index(pair))
+            i += 2
+            continue
+        ch = text[i]
+        cp = ord(ch)
+        if 0x01 <= cp < TOK_ESC:
+            out.append(cp)
+        elif HIRA_FIRST <= cp < HIRA_FIRST + HIRA_COUNT:
+            out.append(TOK_HIRA + cp - HIRA_FIRST)
+        elif ch in PUNCT:
+            out.append(TOK_PUNCT + PUNCT.index(ch))
+        elif HIRA_FIRST + KATA_OFFSET <= cp < HIRA_FIRST + KATA_OFFSET + HIRA_COUNT:
+            out += bytes((TOK_KATA, TOK_HIRA + cp - HIRA_FIRST - KATA_OFFSET))
+        else:
+            raw = ch.encode("utf-8")
+            out += bytes((TOK_ESC, len(raw))) + raw
+        i += 1
+    return bytes(out)
+
+
+def unpack_text(data):
+    out = []
+    i = 0
+    while i < len(data):
+        t = data[i]
+        i += 1
+        if 0x01 <= t < TOK_ESC:
+            out.append(chr(t))
+        elif t == TOK_ESC:
+            n = data[i]
+            out.append(data[i + 1 : i + 1 + n].decode("utf-8"))
+            i += 1 + n
+        elif TOK_HIRA <= t < TOK_PUNCT:
+            out.append(chr(HIRA_FIRST + t - TOK_HIRA))
+        elif TOK_PUNCT <= t < TOK_KATA:
+            out.append(PUNCT[t - TOK_PUNCT])
+        elif t == TOK_KATA:
+            out.append(chr(HIRA_FIRST + KATA_OFFSET + data[i] - TOK_HIRA))
+            i += 1
+        elif t >= TOK_BIGRAM:
+            out.append(BIGRAMS[t - TOK_BIGRAM])
+        else:
+            raise ValueError("bad token 0x00")
+    return "".join(out)
+
+
+KEYS = "stkNnyiaU"  # bit 0..8
+R_SHIFT = 9
+M_SHIFT = 18
+MOD_BITS = {"#": 1 << 0, "*": 1 << 1}
+
+
+_KEY_BIT = {ch: 1 << i for i, ch in enumerate(KEYS)}
+_MOD = {ch: bit << M_SHIFT for ch, bit in MOD_BITS.items()}
+
+
+@functools.lru_cache(maxsize=None)
+def parse_stroke(stroke):
+    """Stroke string -> packed code (L | R << 9 | M << 18). None if invalid."""
+    left, _, right = stroke.partition("-")
+    code = 0
+    try:
+        for ch in left:
+            code |= _MOD.get(ch) or _KEY_BIT[ch]
+        for ch in right:
+            code |= _MOD.get(ch) or _KEY_BIT[ch] << R_SHIFT
+    except KeyError:
+        return None  # 不明な文字、2 つ目の '-'
+    return code or None
+
+
+# ---- validation ----
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+KEY_IDS_H = os.path.join(ROOT, "include", "dt-bindings", "zmk", "mejiro.h")
+CORE_H = os.path.join(ROOT, "include", "mejiro", "mejiro_core.h")
+KCONFIG = os.path.join(ROOT, "Kconfig")
+PARALLEL_MIN = 20000  # これより少なければ 1 プロセスの方が速い
+
+
+def reachable_mask(key_ids_h=KEY_IDS_H, core_h=CORE_H):
+    """Code bits that have a key id (dt-bindings/zmk/mejiro.h) within MEJIRO_KEYS_PER_HAND."""
+    with open(core_h, encoding="utf-8") as f:
+        per_hand = int(re.search(r"#define\s+MEJIRO_KEYS_PER_HAND\s+(\d+)", f.read()).group(1))
+    with open(key_ids_h, encoding="utf-8") as f:
+        text = f.read()
+    mask = 0
+    for side, shift in (("L", 0), ("R", R_SHIFT)):
+        for i in map(int, re.findall(r"\bMJ_%s_(\d+)\b" % side, text)):
+            if i < per_hand:
+                mask |= 1 << (shift + i)
+    for name, bit in (("H", MOD_BITS["#"]), ("X", MOD_BITS["*"])):
+        if re.search(r"\bMJ_MOD_%s\b" % name, text):
+            mask |= bit << M_SHIFT
+    return mask
+
+
+def kconfig_default(name, kconfig=KCONFIG):
+    with open(kconfig, encoding="utf-8") as f:
+        m = re.search(r"config %s\n(?:[ \t]+.*\n)*?[ \t]+default (\d+)" % name, f.read())
+    return int(m.group(1)) if m else None
+
+
+def _check_chunk(args):
+    """Per-entry checks (runs in a worker). -> [(path, stroke, text, codes or None, [problems])]"""
+    items, reachable, max_keys = args
+    code_problems = {}  # 同じストロークは何度も出るので一度だけ調べる
+
+    def check_code(code):
+        found = []
+        if code & ~reachable:
+            found.append("unreachable: key without a key id (0x%06x)" % (code & ~reachable))
+        keys = bin(code).count("1")
+        if keys > max_keys:
+            found.append(f"unreachable: {keys} keys > max stroke keys {max_keys}")
+        return found
+
+    out = []
+    for path, stroke, text in items:
+        if "/" in stroke:
+            codes = tuple(map(parse_stroke, stroke.split("/")))
+        else:
+            codes = (parse_stroke(stroke),)
+        if None in codes:
+            out.append((path, stroke, text, None, ("bad stroke",)))
+            continue
+        problems = ()
+        for code in codes:
+            found = code_problems.get(code)
+            if found is None:
+                found = code_problems[code] = tuple(check_code(code))
+            problems += found
+        if len(text) * 3 >= OUTPUT_MAX and len(text.encode("utf-8")) >= OUTPUT_MAX:
+            problems += (f"output longer than {OUTPUT_MAX - 1} bytes",)
+        out.append((path, stroke, text, codes, problems))
+    return out
+
+
+def validate(paths, jobs=None, max_keys=None, reachable=None):
+    """-> (problems [(kind, message)], entry count). Later files win, as in load_entries."""
+    items = []
+    for path in paths:
+        with open(path, encoding="utf-8") as f:
+            items += [(path, k, v) for k, v in json.load(f).items()]
+
+    reachable = reachable_mask() if reachable is None else reachable
+    if max_keys is None:
+        max_keys = kconfig_default("ZMK_CHORD_MAX_STROKE_KEYS") or 10
+    jobs = jobs or os.cpu_count() or 1
+
+    if jobs > 1 and len(items) >= PARALLEL_MIN:
+        size = (len(items) + jobs - 1) // jobs
+        chunks = [(items[i : i + size], reachable, max_keys) for i in range(0, len(items), size)]
+        with ProcessPoolExecutor(max_workers=jobs) as ex:
+            checked = [r for part in ex.map(_check_chunk, chunks) for r in part]
+    else:
+        checked = _check_chunk((items, reachable, max_keys))
+
+    problems = []
+    outlines = {}  # codes -> (path, stroke, text)
+    for path, stroke, text, codes, errs in checked:
+        for e in errs:
+            kind = e.split(":")[0] if e.startswith("unreachable") else "entry"
+            problems.append((kind, f"{path}: '{stroke}': {e}"))
+        if codes is None:
+            continue
+        prev = outlines.get(codes)
+        if prev and prev[2] != text:
+            problems.append(("duplicate", f"{path}: '{stroke}' -> '{text}' overrides "
+                                          f"{prev[0]}: '{prev[1]}' -> '{prev[2]}'"))
+        outlines[codes] = (path, stroke, text)
+
+    for codes, (path, stroke, _) in outlines.items():
+        for n in range(1, len(codes)):
+            hit = outlines.get(codes[:n])
+            if hit:
+                problems.append(("prefix", f"{path}: '{stroke}' is shadowed by "
+                                           f"{hit[0]}: '{hit[1]}' (commits first)"))
+                break
+    return problems, len(items)
+
+
+def report(problems, count, elapsed):
+    kinds = {}
+    for kind, msg in problems:
+        kinds[kind] = kinds.get(kind, 0) + 1
+        print(f"{kind}: {msg}", file=sys.stderr)
+    summary = ", ".join(f"{n} {k}" for k, n in sorted(kinds.items())) or "no problems"
+    print(f"checked {count} entries in {elapsed * 1000:.0f} ms: {summary}")
+
+
+def bucket_of(code, bucket_count):
+    shift = 32 - (bucket_count.bit_length() - 1)
+    return 0 if shift >= 32 else ((code * 2654435761) & 0xFFFFFFFF) >> shift
+
+
+def load_entries(paths, max_text):
+    """-> (ordered dict code -> (stroke, bytes), warnings)"""
+    entries = {}
+    warnings = []
+    for path in paths:
+        with open(path, encoding="utf-8") as f:
+            data = json.load(f)
+        for stroke, text in data.items():
+            if "/" in stroke:
+                warnings.append(f"{path}: '{stroke}': multi-stroke entries are not compiled")
+                continue
+            code = parse_stroke(stroke)
+            # 壊れたストロークと長すぎる出力は validate() が報告する
+            if code is None or len(text.encode("utf-8")) >= OUTPUT_MAX:
+                continue
+            raw = pack_text(text)
+            if len(raw) > max_text:
+                warnings.append(f"{path}: '{stroke}': packed output longer than {max_text} bytes")
+                continue
+            entries[code] = (stroke, raw)
+    return entries, warnings
+
+
+def load_profile(paths):
+    """-> dict code -> count (several files are summed)."""
+    counts = {}
+    for path in paths:
+        with open(path, encoding="utf-8") as f:
+            data = json.load(f)
+        for stroke, n in data.items():
+            code = parse_stroke(stroke)
+            if code is not None:
+                counts[code] = counts.get(code, 0) + int(n)
+    return counts
+
+
+def record(code, raw):
+    return struct.pack("<I", code)[:3] + bytes((len(raw),)) + raw
+
+
+def build_hot(entries, counts, room):
+    """Hottest entries that fit in `room` bytes (after the u16 count)."""
+    hot = []
+    used = 2
+    for code in sorted(entries, key=lambda c: -counts.get(c, 0)):
+        if counts.get(code, 0) == 0:
+            break
+        size = REC_HDR + len(entries[code][1])
+        if used + size <= room:
+            hot.append(code)
+            used += size
+    return hot
+
+
+def build_buckets(entries, page_size):
+    """Smallest power-of-two bucket count whose buckets each fit in one page."""
+    total = sum(REC_HDR + len(raw) for _, raw in entries.values())
+    count = 1
+    while count * (page_size - 2) < total:
+        count *= 2
+
+    while True:
+        buckets = [[] for _ in range(count)]
+        for code in entries:
+            buckets[bucket_of(code, count)].append(code)
+        if all(2 + sum(REC_HDR + len(entries[c][1]) for c in b) <= page_size for b in buckets):
+            return buckets
+        count *= 2
+
+
+def encode(entries, buckets, hot, counts, page_size):
+    def table(codes):
+        out = bytearray(struct.pack("<H", len(codes)))
+        for code in codes:
+            out += record(code, entries[code][1])
+        return out
+
+    body = bytearray()
+    for b in buckets:
+        # bucket 内も回数の多い順（同数はコード順で出力を安定させる）
+        page = table(sorted(b, key=lambda c: (-counts.get(c, 0), c)))
+        page += b"\xff" * (page_size - len(page))
+        body += page
+
+    hot_area = table(hot)
+    hot_area += b"\xff" * (page_size - HEADER.size - len(hot_area))
+
+    crc = zlib.crc32(bytes(hot_area) + bytes(body))
+    header = HEADER.pack(MAGIC, VERSION, page_size, len(buckets), len(entries), crc)
+    return header + bytes(hot_area) + bytes(body)
+
+
+def find_record(image, off, size, code):
+    (count,) = struct.unpack_from("<H", image, off)
+    p = off + 2
+    for _ in range(count):
+        c = int.from_bytes(image[p : p + 3], "little")
+        n = image[p + 3]
+        p += REC_HDR
+        if p + n > off + size:
+            break
+        if c == code:
+            return image[p : p + n]
+        p += n
+    return None
+
+
+def lookup(image, code):
+    """Same walk as mejiro_flash_dict.c (for self-check)."""
+    magic, _, page_size, bucket_count, _, _ = HEADER.unpack_from(image)
+    assert magic == MAGIC
+    hit = find_record(image, HEADER.size, page_size - HEADER.size, code)
+    if hit is not None:
+        return hit
+    off = (bucket_of(code, bucket_count) + 1) * page_size
+    return find_record(image, off, page_size, code)
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("json", nargs="+", help="Plover-style JSON dictionaries (later files win)")
+    ap.add_argument("-o", "--output", help="output image (not needed with --check)")
+    ap.add_argument("--check", action="store_true", help="validate only, fail on any problem")
+    ap.add_argument("--strict", action="store_true", help="fail the build on any problem")
+    ap.add_argument("-j", "--jobs", type=int, default=None,
+                    help="worker processes for validation (default: all cores)")
+    ap.add_argument("--max-stroke-keys", type=int, default=None,
+                    help="CONFIG_ZMK_CHORD_MAX_STROKE_KEYS (default: the Kconfig default)")
+    ap.add_argument("--page-size", type=int, default=256,
+                    help="bucket page size, <= CONFIG_ZMK_MEJIRO_FLASH_DICT_PAGE_MAX (default 256)")
+    ap.add_argument("--max-text", type=int, default=24,
+                    help="packed bytes per entry, CONFIG_ZMK_MEJIRO_FLASH_DICT_TEXT_LEN (default 24)")
+    ap.add_argument("--profile", action="append", default=[],
+                    help="stroke counts from 'chord prof' (JSON, may repeat)")
+    args = ap.parse_args(argv)
+
+    if args.page_size < HEADER.size + 2 or args.page_size > 0xFFFF:
+        ap.error("bad --page-size")
+    if not args.check and not args.output:
+        ap.error("-o is required unless --check")
+
+    t0 = time.monotonic()
+    problems, count = validate(args.json, args.jobs, args.max_stroke_keys)
+    report(problems, count, time.monotonic() - t0)
+    if args.check or (args.strict and problems):
+        return 1 if problems else 0
+
+    entries, warnings = load_entries(args.json, args.max_text)
+    for w in warnings:
+        print("warning:", w, file=sys.stderr)
+    if not entries:
+        print("error: no entries", file=sys.stderr)
+        return 1
+
+    counts = load_profile(args.profile)
+    buckets = build_buckets(entries, args.page_size)
+    hot = build_hot(entries, counts, args.page_size - HEADER.size)
+    image = encode(entries, buckets, hot, counts, args.page_size)
+
+    for code, (stroke, raw) in entries.items():
+        if lookup(image, code) != raw or pack_text(unpack_text(raw)) != raw:
+            print(f"error: self-check failed for '{stroke}'", file=sys.stderr)
+            return 1
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    print(f"{len(entries)} entries ({len(hot)} hot), {len(buckets)} buckets x "
+          f"{args.page_size} bytes, {len(image)} bytes -> {args.output}")
+    utf8 = sum(5 + len(unpack_text(raw).encode("utf-8")) for _, raw in entries.values())
+    packed = sum(REC_HDR + len(raw) for _, raw in entries.values())
+    print(f"records: {packed} bytes packed vs {utf8} bytes as u32 code + UTF-8 "
+          f"({packed * 100 // max(utf8, 1)}%)")
+    if counts:
+        total = sum(counts.values())
+        in_hot = sum(counts.get(c, 0) for c in hot)
+        print(f"profile: {in_hot * 100 // max(total, 1)}% of counted strokes resolve from the hot table")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,104 +1,342 @@
-/*
- * SPDX-License-Identifier: MIT
- *
- * behavior_mejiro.c
- *
- * - compatible: "zmk,behavior-mejiro"
- * - #binding-cells = <1>
- * - binding->param1 = enum mejiro_key_id (dt-binding で数値になること)
- *
- * このファイルの責務:
- *  1) &mj の press/release を受ける
- *  2) 離された瞬間に「latched」を確定ストロークとして core に渡して送信
- *  3) naginata 側から呼ばれる hook(mejiro_try_emit_from_nginput) を提供（リンク切れ防止＋将来拡張）
- */
-
-#define DT_DRV_COMPAT zmk_behavior_mejiro
-
-#include <zephyr/device.h>
-#include <zephyr/logging/log.h>
-#include <zephyr/sys/util.h> // ARG_UNUSED
-
-#include <drivers/behavior.h>
-#include <zmk/behavior.h>
-
-/* --- Mejiro public headers (あなたの規約: include/mejiro/...) ------------- */
-#include "mejiro/mejiro_core.h"
-#include "mejiro/mejiro_key_ids.h"
-
-/* --- For naginata hook signature ----------------------------------------- */
-/* NGListArray は zmk-naginata module 側の型。hook で参照するので include する */
-#include <zmk_naginata/nglistarray.h>
-/*
- * SPDX-License-Identifier: MIT
- *
- * ZMK behavior: mejiro
- */
-#define DT_DRV_COMPAT zmk_behavior_mejiro
-
-#include <zephyr/device.h>
-#include <zephyr/kernel.h>
-#include <drivers/behavior.h>
-#include <zephyr/logging/log.h>
-
-#include <zmk/behavior.h>
-#include <zmk/event_manager.h>
-#include <zmk/events/keycode_state_changed.h>
-
-#include "mejiro/mejiro_core.h"
-
-LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
-
-struct mejiro_runtime {
-    struct mejiro_state current;
-    struct mejiro_state latched;
-};
-
-static struct mejiro_runtime g;
-
-/* 押下/離上イベントを state に記録する */
-static void record_key(uint32_t id, bool pressed) {
-    /* ここで implicit declaration になってたので core側で宣言/定義済み */
-    mejiro_on_key_event(&g.latched, id, pressed);
-}
-
-/* ---- ZMK behavior hooks ---- */
-
-static int behavior_mejiro_init(const struct device *dev) {
-    ARG_UNUSED(dev);
-    mejiro_state_reset(&g.current);
-    mejiro_state_reset(&g.latched);
-    return 0;
-}
-
-static int behavior_mejiro_binding_pressed(struct zmk_behavior_binding *binding,
-                                           struct zmk_behavior_binding_event event) {
-    ARG_UNUSED(binding);
-
-    record_key(event.position, true);
-    return ZMK_BEHAVIOR_OPAQUE;
-}
-
-static int behavior_mejiro_binding_released(struct zmk_behavior_binding *binding,
-                                            struct zmk_behavior_binding_event event) {
-    ARG_UNUSED(binding);
-
-    record_key(event.position, false);
-
-    /* ここがログの致命点：mejiro_try_emit は timestamp 引数が必要 */
-    int64_t ts = k_uptime_get();
-    (void)mejiro_try_emit(&g.latched, ts);
-
-    return ZMK_BEHAVIOR_OPAQUE;
-}
-
-/* ---- driver API ---- */
-
-static const struct behavior_driver_api behavior_mejiro_driver_api = {
-    .binding_pressed = behavior_mejiro_binding_pressed,
-    .binding_released = behavior_mejiro_binding_released,
-};
-
-DEVICE_DT_INST_DEFINE(0, behavior_mejiro_init, NULL, NULL, NULL,
-                      APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
-                      &behavior_mejiro_driver_api);
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * behavior_mejiro.c
+ *
+ * - compatible: "zmk,behavior-mejiro"
+ * - #binding-cells = <1>
+ * - binding->param1 = Mejiro key id（dt-bindings/zmk/mejiro.h の MJ_L_S など）
+ *
+ * このファイルの責務:
+ *  1) &mj の press/release を position の bit にして chord_engine に渡す
+ *  2) chord_engine（chord_seg）が確定したストロークを core に渡して送信
+ *     （ロールオーバーで次のストロークのキーが混ざらないようにする）
+ *  3) split-input があれば、peripheral がまとめて送ってくる半分のストロークと
+ *     自分の半分を mejiro_merge で 1 ストロークにする（CONFIG_ZMK_MEJIRO_SPLIT_MERGE）。
+ *     chord tune の窓と確定の方式は &mj_half で peripheral にも送る
+ */
+
+#define DT_DRV_COMPAT zmk_behavior_mejiro
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/input/input.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h> // ARG_UNUSED
+
+#include <drivers/behavior.h>
+#include <zmk/behavior.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/split_peripheral_status_changed.h>
+#include <zmk/matrix.h>
+#include <zmk/split/central.h>
+
+/* --- Mejiro public headers (あなたの規約: include/mejiro/...) ------------- */
+#include "mejiro/mejiro_core.h"
+#include "mejiro/mejiro_key_ids.h"
+#include "mejiro/mejiro_positions.h"
+#include "mejiro/mejiro_profile.h"
+#include "mejiro/mejiro_send_roman.h"
+#include "mejiro/mejiro_spec.h"
+#include "mejiro/mejiro_split.h"
+
+#include <chord/chord_engine.h>
+#include <chord/chord_power.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+/*
+ * position -> packed stroke code の 1 bit（mejiro_positions.h）。押下ごとの処理は表を
+ * 1 回引くだけで、ストロークは bit の OR になる。chord_engine にもこの bit をキーとして渡す
+ * （Mejiro のキーごとに一意）。combo などの仮想 position と、表に無い position（どの
+ * レイヤーでも直接は &mj でない。hold-tap などから呼ばれた時）は param1 から引く。
+ */
+MJ_POSITION_CHECKS
+
+static const uint32_t mj_position_bits[ZMK_KEYMAP_LEN] = MJ_POSITION_BITS_INIT;
+
+BUILD_ASSERT(MJ_ID_CODE_BIT(MJ_R_0) == BIT(MEJIRO_CODE_R_SHIFT),
+             "key ids and stroke code disagree");
+BUILD_ASSERT(MJ_ID_CODE_BIT(MJ_MOD_X) == (MJ_MOD_BIT_X << MEJIRO_CODE_M_SHIFT),
+             "key ids and stroke code disagree");
+
+static inline uint32_t position_bit(const struct zmk_behavior_binding *binding, uint32_t position) {
+    if (position < ARRAY_SIZE(mj_position_bits) && mj_position_bits[position]) {
+        return mj_position_bits[position];
+    }
+    return MJ_ID_CODE_BIT(binding->param1);
+}
+
+/* devicetree のプロパティ（dts/bindings/behaviors/zmk,behavior-mejiro.yaml）をそのまま持つ */
+struct behavior_mejiro_config {
+    struct chord_engine_config engine;
+};
+
+static struct chord_engine engine;
+
+/* stroke->keys は position_bit() の bit なので、ストロークはその OR */
+static uint32_t stroke_code(const struct chord_stroke *stroke) {
+    uint32_t code = 0;
+
+    for (uint8_t i = 0; i < stroke->count; i++) {
+        code |= stroke->keys[i];
+    }
+    return code;
+}
+
+/* 確定したストローク（packed code）-> latched state -> core */
+static void emit_code(uint32_t code, int64_t timestamp) {
+    struct mejiro_state latched;
+
+    mejiro_state_reset(&latched);
+    mejiro_state_from_code(&latched, code);
+
+#if IS_ENABLED(CONFIG_ZMK_MEJIRO_PROFILE)
+    mejiro_profile_hit(code);
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_MEJIRO_SPECULATIVE)
+    if (mejiro_spec_commit(&latched, timestamp)) {
+        return;
+    }
+#endif
+    (void)mejiro_try_emit(&latched, timestamp);
+}
+
+/* ---- split: peripheral の半分と合わせる ---- */
+
+#define MJ_SPLIT_MERGE                                                                            \
+    (IS_ENABLED(CONFIG_ZMK_MEJIRO_SPLIT_MERGE) && DT_INST_NODE_HAS_PROP(0, split_input))
+
+#if MJ_SPLIT_MERGE
+
+static struct mejiro_merge merge;
+
+/* 自分の半分の始まり（chord_engine が離上時の切り出しも含めて教える） */
+static void merge_stroke_start(struct chord_engine *e, const struct chord_stroke *stroke) {
+    ARG_UNUSED(e);
+    mejiro_merge_start(&merge, MEJIRO_HALF_LOCAL, stroke->first_press);
+}
+
+static void merge_emit(uint32_t code, int64_t timestamp, void *user_data) {
+    ARG_UNUSED(user_data);
+    emit_code(code, timestamp);
+}
+
+/* 相手を待っている半分がある間だけ、engine の timer で timeout を張る */
+static void merge_arm(void) { chord_engine_arm(&engine, mejiro_merge_deadline(&merge)); }
+
+static void merge_expire(struct chord_engine *e, int64_t now) {
+    ARG_UNUSED(e);
+    mejiro_merge_expire(&merge, now);
+    merge_arm();
+}
+
+/* input のコールバックから system work queue（behavior と同じ）へ渡す */
+struct split_msg {
+    uint16_t code;
+    uint32_t value;
+    int64_t ts;
+};
+
+K_MSGQ_DEFINE(split_msgq, sizeof(struct split_msg), 8, 4);
+
+static void split_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    struct split_msg msg;
+
+    while (k_msgq_get(&split_msgq, &msg, K_NO_WAIT) == 0) {
+        chord_power_wake(CHORD_WAKE_KEY);
+        if (msg.code == MEJIRO_SPLIT_CODE_START) {
+            mejiro_merge_start(&merge, MEJIRO_HALF_REMOTE, msg.ts);
+        } else if (msg.code == MEJIRO_SPLIT_CODE_STROKE && msg.value) {
+            mejiro_merge_done(&merge, MEJIRO_HALF_REMOTE, msg.value, msg.ts);
+        }
+    }
+    merge_arm();
+}
+
+static K_WORK_DEFINE(split_work, split_work_handler);
+
+static void split_input_cb(struct input_event *evt, void *user_data) {
+    ARG_UNUSED(user_data);
+    if (evt->type != MEJIRO_SPLIT_EV_TYPE) {
+        return;
+    }
+
+    /* START の value は peripheral でそのストロークが始まってからの ms */
+    const struct split_msg msg = {
+        .code = evt->code,
+        .value = (uint32_t)evt->value,
+        .ts = k_uptime_get() - (evt->code == MEJIRO_SPLIT_CODE_START ? evt->value : 0),
+    };
+    if (k_msgq_put(&split_msgq, &msg, K_NO_WAIT)) {
+        LOG_WRN("MEJIRO split: message dropped");
+    }
+    k_work_submit(&split_work);
+}
+
+INPUT_CALLBACK_DEFINE(DEVICE_DT_GET(DT_INST_PHANDLE(0, split_input)), split_input_cb, NULL);
+
+#endif /* MJ_SPLIT_MERGE */
+
+/* ---- split: peripheral の chord_seg を chord tune に合わせる ---- */
+
+#define MJ_HALF_TUNE                                                                              \
+    (MJ_SPLIT_MERGE && IS_ENABLED(CONFIG_ZMK_CHORD_TUNE) &&                                       \
+     DT_HAS_COMPAT_STATUS_OKAY(zmk_behavior_mejiro_half))
+
+#if MJ_HALF_TUNE
+
+/* peripheral は devicetree の窓のままなので、変わった時とつながった時に今の値を送る */
+static void half_tune_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    const struct chord_tune_params *p = &engine.tune.params;
+    struct zmk_behavior_binding binding = {
+        .behavior_dev = DEVICE_DT_NAME(DT_INST(0, zmk_behavior_mejiro_half)),
+        .param1 = MEJIRO_SPLIT_HALF_TUNE,
+        .param2 = MEJIRO_SPLIT_HALF_TUNE_PARAM(p->window_ms, p->commit_mode),
+    };
+    const struct zmk_behavior_binding_event event = {.timestamp = k_uptime_get()};
+
+    for (uint8_t i = 0; i < ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT; i++) {
+        int err = zmk_split_central_invoke_behavior(i, &binding, event, true);
+        if (err) {
+            /* つながっていない peripheral には、つながった時に送る */
+            LOG_DBG("MEJIRO split: tune not sent to %u (%d)", i, err);
+        }
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(half_tune_work, half_tune_handler);
+
+static void half_tuned(struct chord_engine *e, const struct chord_tune_params *params) {
+    ARG_UNUSED(e);
+    ARG_UNUSED(params);
+    k_work_reschedule(&half_tune_work, K_NO_WAIT);
+}
+
+static int half_tune_listener(const zmk_event_t *eh) {
+    const struct zmk_split_peripheral_status_changed *ev =
+        as_zmk_split_peripheral_status_changed(eh);
+
+    if (ev && ev->connected) {
+        /* つながった直後は behavior を呼ぶ characteristic をまだ探している */
+        k_work_reschedule(&half_tune_work, K_SECONDS(1));
+    }
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(behavior_mejiro_half_tune, half_tune_listener);
+ZMK_SUBSCRIPTION(behavior_mejiro_half_tune, zmk_split_peripheral_status_changed);
+
+#endif /* MJ_HALF_TUNE */
+
+/* ---- chord_engine ops ---- */
+
+static void on_stroke_commit(struct chord_engine *e, const struct chord_stroke *stroke) {
+    ARG_UNUSED(e);
+    const uint32_t code = stroke_code(stroke);
+
+#if MJ_SPLIT_MERGE
+    mejiro_merge_done(&merge, MEJIRO_HALF_LOCAL, code, stroke->last_release);
+    merge_arm();
+#else
+    emit_code(code, stroke->last_release);
+#endif
+}
+
+#if IS_ENABLED(CONFIG_ZMK_MEJIRO_SPECULATIVE)
+
+/*
+ * 重なっているストロークが無い時だけ、1〜2 キー目で推測送信する
+ * （journal は常に一番古い未確定ストロークのもの）
+ */
+static void on_pressed(struct chord_engine *e, const struct chord_stroke *stroke,
+                       int64_t timestamp) {
+    if (chord_engine_pending(e) == 1 && stroke->count <= 2) {
+        struct mejiro_state partial;
+        mejiro_state_reset(&partial);
+        mejiro_state_from_code(&partial, stroke_code(stroke));
+        mejiro_spec_update(&partial, stroke->first_press, timestamp);
+    }
+}
+
+#endif
+
+static const struct chord_engine_ops mejiro_ops = {
+    .name = "mejiro",
+#if MJ_SPLIT_MERGE
+    .stroke_start = merge_stroke_start,
+    .expire = merge_expire,
+#endif
+#if IS_ENABLED(CONFIG_ZMK_MEJIRO_SPECULATIVE)
+    .pressed = on_pressed,
+#endif
+    .commit = on_stroke_commit,
+    .set_gap = mejiro_send_set_tap_gap,
+#if MJ_HALF_TUNE
+    .tuned = half_tuned,
+#endif
+};
+
+/* ---- ZMK behavior hooks ---- */
+
+static int behavior_mejiro_init(const struct device *dev) {
+    const struct behavior_mejiro_config *cfg = dev->config;
+
+    mejiro_send_set_tap_gap(cfg->engine.gap_ms);
+#if MJ_SPLIT_MERGE
+    mejiro_merge_init(&merge, CONFIG_ZMK_MEJIRO_SPLIT_MERGE_WINDOW_MS,
+                      CONFIG_ZMK_MEJIRO_SPLIT_MERGE_TIMEOUT_MS, merge_emit, NULL);
+#endif
+    chord_engine_init(&engine, &mejiro_ops, &cfg->engine);
+    return 0;
+}
+
+static int behavior_mejiro_binding_pressed(struct zmk_behavior_binding *binding,
+                                           struct zmk_behavior_binding_event event) {
+    const uint32_t bit = position_bit(binding, event.position);
+    if (bit) {
+        /* position event の時刻（キーを読んだ時。event manager の待ちを含まない） */
+        chord_engine_press(&engine, bit, event.timestamp);
+    }
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static int behavior_mejiro_binding_released(struct zmk_behavior_binding *binding,
+                                            struct zmk_behavior_binding_event event) {
+    const uint32_t bit = position_bit(binding, event.position);
+    if (bit) {
+        /* 確定（mejiro_try_emit）は on_stroke_commit から */
+        chord_engine_release(&engine, bit, event.timestamp);
+    }
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+/* ---- driver API ---- */
+
+static const struct behavior_driver_api behavior_mejiro_driver_api = {
+    .binding_pressed = behavior_mejiro_binding_pressed,
+    .binding_released = behavior_mejiro_binding_released,
+};
+
+/* 状態と position の表は instance 0 のもの */
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) <= 1, "only one zmk,behavior-mejiro node");
+
+#define MJ_INST(n)                                                                                \
+    static const struct behavior_mejiro_config behavior_mejiro_config_##n = {                     \
+        .engine =                                                                                 \
+            {                                                                                     \
+                .window_ms =                                                                      \
+                    DT_INST_PROP_OR(n, chord_window_ms, CONFIG_ZMK_CHORD_ROLLOVER_SPLIT_MS),      \
+                .gap_ms = DT_INST_PROP(n, inter_key_gap_ms),                                      \
+                .commit_mode = DT_INST_ENUM_IDX(n, commit_mode),                                  \
+            },                                                                                    \
+    };                                                                                            \
+    DEVICE_DT_INST_DEFINE(n, behavior_mejiro_init, NULL, NULL, &behavior_mejiro_config_##n,       \
+                          APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,                       \
+                          &behavior_mejiro_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(MJ_INST)
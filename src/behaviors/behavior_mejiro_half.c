@@ -0,0 +1,72 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * &mj_half MJ_HALF_ON / MJ_HALF_OFF / MJ_HALF_TOG
+ *
+ * split の peripheral で &mj のキーを半分のストロークにまとめるかを切り替える
+ * （mejiro_half.c）。locality は GLOBAL なので、central で押すと peripheral でも動く。
+ * Mejiro のレイヤーに入る / 出るマクロに一緒に入れておく。central では何もしない。
+ * central の behavior_mejiro は chord tune の窓を伝えるのにも使う（MEJIRO_SPLIT_HALF_TUNE）。
+ */
+
+#define DT_DRV_COMPAT zmk_behavior_mejiro_half
+
+#include <zephyr/device.h>
+#include <drivers/behavior.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/kernel.h>
+
+#include <dt-bindings/zmk/mejiro.h>
+#include <zmk/behavior.h>
+
+#include "mejiro/mejiro_split.h"
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
+                                     struct zmk_behavior_binding_event event) {
+    ARG_UNUSED(event);
+
+#if IS_ENABLED(CONFIG_ZMK_MEJIRO_SPLIT_HALF)
+    switch (binding->param1) {
+    case MJ_HALF_OFF:
+        mejiro_half_set_enabled(false);
+        break;
+    case MJ_HALF_ON:
+        mejiro_half_set_enabled(true);
+        break;
+    case MJ_HALF_TOG:
+        mejiro_half_set_enabled(!mejiro_half_enabled());
+        break;
+    case MEJIRO_SPLIT_HALF_TUNE:
+        /* central の chord tune から（mejiro_split.h） */
+        mejiro_half_tune(binding->param2 & 0xffff, binding->param2 >> 16);
+        return ZMK_BEHAVIOR_OPAQUE;
+    default:
+        return -ENOTSUP;
+    }
+    LOG_DBG("mejiro half: %s", mejiro_half_enabled() ? "on" : "off");
+#else
+    ARG_UNUSED(binding);
+#endif
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event) {
+    ARG_UNUSED(binding);
+    ARG_UNUSED(event);
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static const struct behavior_driver_api behavior_mejiro_half_driver_api = {
+    .binding_pressed = on_keymap_binding_pressed,
+    .binding_released = on_keymap_binding_released,
+    .locality = BEHAVIOR_LOCALITY_GLOBAL,
+};
+
+#define MJ_HALF_INST(n)                                                                           \
+    DEVICE_DT_INST_DEFINE(n, NULL, NULL, NULL, NULL, APPLICATION,                                 \
+                          CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &behavior_mejiro_half_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(MJ_HALF_INST)
@@ -15,43 +15,112 @@
 #include <zmk_naginata/nglist.h>
 #include <zmk_naginata/nglistarray.h>
 #include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_settings.h>
+#include <zmk_naginata/naginata_shift.h>
+
+#include <chord/chord_engine.h>
+#include <chord/kana_out.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+/* devicetree のプロパティ（dts/bindings/behaviors/zmk,behavior-naginata.yaml）をそのまま持つ */
+struct behavior_naginata_config {
+    struct chord_engine_config engine; /* gap_ms は timing.inter_key_gap_ms と同じ */
+    struct naginata_timing timing;
+};
+
+/* chord_seg の 1 ストロークが NGList 1 つに、未確定のストロークが nginput に収まる */
+BUILD_ASSERT(CHORD_STROKE_MAX_KEYS <= NG_LIST_SIZE, "a stroke must fit one NGList");
+BUILD_ASSERT(CHORD_SEG_MAX_PENDING <= NG_LIST_ARRAY_SIZE, "pending strokes must fit nginput");
+
 static NGListArray nginput;
-static int64_t timestamp;
+static struct chord_engine engine;
+
+/* keycode の並び（押下順）を 1 ストロークとして同時押し判定に渡す */
+static void type_keys(const uint32_t *keys, uint8_t count, int64_t ts) {
+    NGList one;
+    initializeList(&one);
+    for (uint8_t i = 0; i < count; i++) {
+        (void)addToList(&one, keys[i]);
+    }
+    (void)addToListArray(&nginput, &one);
+    (void)naginata_type_from_nglistarray(&nginput, ts);
+}
+
+#if !IS_ENABLED(CONFIG_ZMK_NAGINATA_DICT)
+/* 同時押しの表（naginata_dict.c）を外した時: 先行シフト面だけで打つ。判定待ちは捨てる */
+bool naginata_type_from_nglistarray(NGListArray *keys, int64_t timestamp) {
+    ARG_UNUSED(timestamp);
+    LOG_DBG("naginata: no chord table, dropped %d stroke(s)", keys->size);
+    initializeListArray(keys);
+    return false;
+}
+#endif
+
+/* ---- chord_engine ops ---- */
+
+/* 親指先行シフト中はその場で確定（同時押し判定を通さない） */
+static bool intercept_press(struct chord_engine *e, uint32_t keycode, int64_t timestamp) {
+    return naginata_shift_press(keycode, chord_engine_pending(e) > 0, timestamp);
+}
+
+static bool intercept_release(struct chord_engine *e, uint32_t keycode, int64_t timestamp) {
+    ARG_UNUSED(e);
+    return naginata_shift_release(keycode, timestamp);
+}
+
+/*
+ * 確定したストローク（押下順）を NGList にして addToListArray する。
+ * 重なった 2 ストロークは別々の NGList になる。
+ */
+static void on_stroke_commit(struct chord_engine *e, const struct chord_stroke *stroke) {
+    ARG_UNUSED(e);
+    /* type_keys は kana_out を通さずに送るので、流している途中のかなの後ろに並べる */
+    kana_out_call(type_keys, stroke->keys, stroke->count, stroke->first_press);
+}
+
+/* 出力の間隔は naginata_timing の中にある。OS ごとの待ち時間は naginata_tune.c */
+static void set_gap(uint16_t gap_ms) {
+    struct naginata_timing timing = *naginata_get_timing();
+
+    timing.inter_key_gap_ms = gap_ms;
+    naginata_update_timing(&timing);
+}
+
+static const struct chord_engine_ops naginata_ops = {
+    .name = "naginata",
+    .intercept_press = intercept_press,
+    .intercept_release = intercept_release,
+    .commit = on_stroke_commit,
+    .set_gap = set_gap,
+};
+
+/* ---- ZMK behavior hooks ---- */
 
 static int behavior_naginata_init(const struct device *dev) {
-    ARG_UNUSED(dev);
+    const struct behavior_naginata_config *cfg = dev->config;
+
     initializeListArray(&nginput);
-    timestamp = 0;
+    naginata_set_timing(&cfg->timing);
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+    /* OS / 縦書き / 待ち時間は main の settings_load を待たずに戻す（起動直後の入力から効く） */
+    (void)naginata_settings_load();
+#endif
+    chord_engine_init(&engine, &naginata_ops, &cfg->engine);
+    naginata_shift_init(type_keys);
     return 0;
 }
 
 static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
                                      struct zmk_behavior_binding_event event) {
-    ARG_UNUSED(binding);
-    /* pressでは何もしない（あなたの方針：離した時に判定） */
-    timestamp = k_uptime_get();
+    /* event.timestamp は position event の時刻（キーを読んだ時） */
+    chord_engine_press(&engine, binding->param1, event.timestamp);
     return ZMK_BEHAVIOR_OPAQUE;
 }
 
 static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
                                       struct zmk_behavior_binding_event event) {
-    ARG_UNUSED(binding);
-
-    /* event.position を NGList にして addToListArray する（宣言に合わせる） */
-    NGList one;
-    initializeList(&one);
-    (void)addToList(&one, (uint32_t)event.position);
-    (void)addToListArray(&nginput, &one);
-
-    /* あなたの naginata_func 側の関数名に合わせる必要があるので、
-       ここは「宣言がある関数」に合わせて呼ぶこと。
-       もし naginata_type_from_nglistarray が存在しないなら、
-       naginata_func.h の実際の公開関数名に置換する。 */
-    (void)naginata_type_from_nglistarray(&nginput, timestamp);
-
+    chord_engine_release(&engine, binding->param1, event.timestamp);
     return ZMK_BEHAVIOR_OPAQUE;
 }
 
@@ -60,6 +129,37 @@ static const struct behavior_driver_api behavior_naginata_driver_api = {
     .binding_released = on_keymap_binding_released,
 };
 
-DEVICE_DT_INST_DEFINE(0, behavior_naginata_init, NULL, NULL, NULL,
-                      APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
-                      &behavior_naginata_driver_api);
+/* 状態（nginput / engine）はモジュールで 1 つ */
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) <= 1, "only one zmk,behavior-naginata node");
+
+#define NG_OS_ARRAY(n, prop)                                                                      \
+    BUILD_ASSERT(DT_INST_PROP_LEN(n, prop) == NG_OS_COUNT,                                        \
+                 #prop " needs one value per OS <windows macos linux ios>");
+
+#define NG_INST(n)                                                                                \
+    NG_OS_ARRAY(n, key_delay_ms)                                                                  \
+    NG_OS_ARRAY(n, modifier_delay_ms)                                                             \
+    NG_OS_ARRAY(n, sequence_delay_ms)                                                             \
+    NG_OS_ARRAY(n, launcher_delay_ms)                                                             \
+    static const struct behavior_naginata_config behavior_naginata_config_##n = {                 \
+        .engine =                                                                                 \
+            {                                                                                     \
+                .window_ms =                                                                      \
+                    DT_INST_PROP_OR(n, chord_window_ms, CONFIG_ZMK_CHORD_ROLLOVER_SPLIT_MS),      \
+                .gap_ms = DT_INST_PROP(n, inter_key_gap_ms),                                      \
+                .commit_mode = DT_INST_ENUM_IDX(n, commit_mode),                                  \
+            },                                                                                    \
+        .timing =                                                                                 \
+            {                                                                                     \
+                .inter_key_gap_ms = DT_INST_PROP(n, inter_key_gap_ms),                            \
+                .key_delay_ms = DT_INST_PROP(n, key_delay_ms),                                    \
+                .modifier_delay_ms = DT_INST_PROP(n, modifier_delay_ms),                          \
+                .sequence_delay_ms = DT_INST_PROP(n, sequence_delay_ms),                          \
+                .launcher_delay_ms = DT_INST_PROP(n, launcher_delay_ms),                          \
+            },                                                                                    \
+    };                                                                                            \
+    DEVICE_DT_INST_DEFINE(n, behavior_naginata_init, NULL, NULL, &behavior_naginata_config_##n,   \
+                          APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,                       \
+                          &behavior_naginata_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(NG_INST)
@@ -1,12 +1,17 @@
 /*
  * SPDX-License-Identifier: MIT
  */
+#include <string.h>
+
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
 
 #include "mejiro/mejiro_core.h"
+#include "mejiro/mejiro_flash_dict.h"
 #include "mejiro/mejiro_key_ids.h"
 #include "mejiro/mejiro_tables.h"
+#include "mejiro/mejiro_user_dict.h"
 
 /* 送信は roman 実装へ */
 #include "mejiro/mejiro_send_roman.h"
@@ -51,39 +56,22 @@ void mejiro_state_reset(struct mejiro_state *s) {
     s->active = false;
 }
 
-static inline bool is_left_id(uint32_t id) { return id <= MJ_L_U; }
-static inline bool is_right_id(uint32_t id) { return (id >= MJ_R_S) && (id <= MJ_R_U); }
-
+/* 片手 9 キー（s t k N n y i a U）と # * 以外の id は無視する */
 void mejiro_state_set_key(struct mejiro_state *s, uint32_t key_id, bool pressed) {
     if (!s) return;
 
-    if (is_left_id(key_id)) {
-        uint32_t bit = 1u << key_id; /* 0..8 */
-        if (pressed) s->left_mask |= bit;
-        else s->left_mask &= ~bit;
-        return;
-    }
+    uint32_t code = mejiro_stroke_code(s);
+    const uint32_t bit = MJ_ID_CODE_BIT(key_id);
 
-    if (is_right_id(key_id)) {
-        uint32_t bit = 1u << (key_id - MJ_R_S); /* 0..8 */
-        if (pressed) s->right_mask |= bit;
-        else s->right_mask &= ~bit;
-        return;
-    }
+    mejiro_state_from_code(s, pressed ? (code | bit) : (code & ~bit));
+}
 
-    if (key_id == MJ_H) {
-        uint32_t bit = 1u << 0;
-        if (pressed) s->mod_mask |= bit;
-        else s->mod_mask &= ~bit;
-        return;
-    }
+void mejiro_state_from_code(struct mejiro_state *s, uint32_t code) {
+    const uint32_t hand = BIT(MEJIRO_KEYS_PER_HAND) - 1;
 
-    if (key_id == MJ_X) {
-        uint32_t bit = 1u << 1;
-        if (pressed) s->mod_mask |= bit;
-        else s->mod_mask &= ~bit;
-        return;
-    }
+    s->left_mask = code & hand;
+    s->right_mask = (code >> MEJIRO_CODE_R_SHIFT) & hand;
+    s->mod_mask = (code >> MEJIRO_CODE_M_SHIFT) & (MJ_MOD_BIT_H | MJ_MOD_BIT_X);
 }
 
 bool mejiro_build_stroke_string(const struct mejiro_state *latched, char *out, size_t out_len) {
@@ -106,8 +94,8 @@ bool mejiro_build_stroke_string(const struct mejiro_state *latched, char *out, s
     }
 
     /* H/X は「左右で分けない」ので左側に付ける（仕様の最小解釈） */
-    if (M & (1u << 0)) append_char(left, sizeof(left), &lp, '#');
-    if (M & (1u << 1)) append_char(left, sizeof(left), &lp, '*');
+    if (M & MJ_MOD_BIT_H) append_char(left, sizeof(left), &lp, '#');
+    if (M & MJ_MOD_BIT_X) append_char(left, sizeof(left), &lp, '*');
 
     for (size_t i = 0; i < (sizeof(mj_order) / sizeof(mj_order[0])); i++) {
         if (R & mj_order[i].bit) append_char(right, sizeof(right), &rp, mj_order[i].ch);
@@ -136,23 +124,303 @@ bool mejiro_build_stroke_string(const struct mejiro_state *latched, char *out, s
     return true;
 }
 
-bool mejiro_try_emit(const struct mejiro_state *latched, int64_t timestamp) {
+uint32_t mejiro_stroke_code(const struct mejiro_state *latched) {
+    if (!latched) return 0;
+    return latched->left_mask | (latched->right_mask << MEJIRO_CODE_R_SHIFT) |
+           (latched->mod_mask << MEJIRO_CODE_M_SHIFT);
+}
+
+bool mejiro_parse_stroke_string(const char *stroke, struct mejiro_state *out) {
+    if (!stroke || !out) return false;
+
+    mejiro_state_reset(out);
+    uint32_t *hand = &out->left_mask;
+
+    for (const char *p = stroke; *p; p++) {
+        if (*p == '-' && hand == &out->left_mask) {
+            hand = &out->right_mask;
+            continue;
+        }
+        if (*p == '#' || *p == '*') {
+            out->mod_mask |= (*p == '#') ? MJ_MOD_BIT_H : MJ_MOD_BIT_X;
+            continue;
+        }
+
+        size_t i = 0;
+        while (i < ARRAY_SIZE(mj_order) && mj_order[i].ch != *p) {
+            i++;
+        }
+        if (i == ARRAY_SIZE(mj_order)) {
+            return false;
+        }
+        *hand |= mj_order[i].bit;
+    }
+
+    return out->left_mask || out->right_mask || out->mod_mask;
+}
+
+/* ---- synthesis ---------------------------------------------------------- */
+
+/*
+ * 片手 = 子音 4 キー (s t k N) + 撥音 n + 母音 4 キー (y i a U)。
+ *   consonant = mask & 0xF, n = bit 4, vowel = (mask >> 5) & 0xF
+ * 左右とも同じ規則で 1 音節（+ 二重母音の後半 + ん）を作り、
+ * 出力 = 左 + ('*' なら っ) + 右。'#' 付きは例外表のみ（記号・機能用）。
+ */
+#define CONS(m) ((m) & 0xFu)
+#define HATSU(m) (((m) >> 4) & 1u)
+#define VOWEL(m) (((m) >> 5) & 0xFu)
+
+enum { DAN_A, DAN_I, DAN_U, DAN_E, DAN_O, DAN_YA, DAN_YU, DAN_YO, DAN_NONE };
+
+/* 子音キーの組 -> 行。NULL は無い音 */
+static const struct {
+    const char *dan[5]; /* あ い う え お 段 */
+    bool yoon;          /* い段 + ゃゅょ を作れる */
+} rows[16] = {
+    [0x0] = {{"あ", "い", "う", "え", "お"}},
+    [0x1] = {{"さ", "し", "す", "せ", "そ"}, true},          /* s */
+    [0x2] = {{"た", "ち", "つ", "て", "と"}, true},          /* t */
+    [0x3] = {{"ら", "り", "る", "れ", "ろ"}, true},          /* st */
+    [0x4] = {{"か", "き", "く", "け", "こ"}, true},          /* k */
+    [0x5] = {{"わ", "うぃ", "う", "うぇ", "を"}},           /* sk */
+    [0x6] = {{"は", "ひ", "ふ", "へ", "ほ"}, true},          /* tk */
+    [0x7] = {{"ぱ", "ぴ", "ぷ", "ぺ", "ぽ"}, true},          /* stk */
+    [0x8] = {{"な", "に", "ぬ", "ね", "の"}, true},          /* N */
+    [0x9] = {{"ざ", "じ", "ず", "ぜ", "ぞ"}, true},          /* sN */
+    [0xA] = {{"だ", "ぢ", "づ", "で", "ど"}, true},          /* tN */
+    [0xB] = {{"ば", "び", "ぶ", "べ", "ぼ"}, true},          /* stN */
+    [0xC] = {{"が", "ぎ", "ぐ", "げ", "ご"}, true},          /* kN */
+    [0xD] = {{"や", NULL, "ゆ", "いぇ", "よ"}},              /* skN */
+    [0xE] = {{"ま", "み", "む", "め", "も"}, true},          /* tkN */
+    [0xF] = {{"ふぁ", "ふぃ", "ふ", "ふぇ", "ふぉ"}},        /* stkN */
+};
+
+/* 母音キーの組 (bit0=y bit1=i bit2=a bit3=U) -> 段 + 後半 */
+static const struct {
+    uint8_t dan;
+    const char *tail;
+} vowels[16] = {
+    [0x0] = {DAN_NONE, NULL}, [0x1] = {DAN_NONE, NULL},
+    [0x2] = {DAN_I, ""},      [0x3] = {DAN_YU, "う"}, /* i  / yi  */
+    [0x4] = {DAN_A, ""},      [0x5] = {DAN_YA, ""},   /* a  / ya  */
+    [0x6] = {DAN_E, ""},      [0x7] = {DAN_E, "い"},  /* ia / yia */
+    [0x8] = {DAN_U, ""},      [0x9] = {DAN_YU, ""},   /* U  / yU  */
+    [0xA] = {DAN_U, "い"},    [0xB] = {DAN_YO, "う"}, /* iU / yiU */
+    [0xC] = {DAN_O, ""},      [0xD] = {DAN_YO, ""},   /* aU / yaU */
+    [0xE] = {DAN_A, "い"},    [0xF] = {DAN_O, "う"},  /* iaU / yiaU */
+};
+
+static const char *const small_y[3] = {"ゃ", "ゅ", "ょ"};
+static const char *const plain_y[3] = {"や", "ゆ", "よ"};
+
+static bool append_str(char *out, size_t out_len, size_t *pos, const char *str) {
+    size_t n = strlen(str);
+    if (*pos + n >= out_len) {
+        return false;
+    }
+    memcpy(&out[*pos], str, n + 1);
+    *pos += n;
+    return true;
+}
+
+/* 片手分。mask == 0 は空で成功 */
+static bool synth_hand(uint32_t mask, char *out, size_t out_len, size_t *pos) {
+    const uint32_t c = CONS(mask);
+    const uint32_t v = VOWEL(mask);
+    const char *kana;
+    const char *yo = NULL;
+
+    if (v == 0) {
+        /* 母音無し: 「ん」単独のみ */
+        if (c != 0) return false;
+        return !HATSU(mask) || append_str(out, out_len, pos, "ん");
+    }
+
+    const uint8_t dan = vowels[v].dan;
+    if (dan == DAN_NONE) {
+        return false;
+    }
+    if (dan < DAN_YA) {
+        kana = rows[c].dan[dan];
+    } else if (c == 0 || c == 0xD) {
+        kana = plain_y[dan - DAN_YA];
+    } else if (rows[c].yoon) {
+        kana = rows[c].dan[DAN_I];
+        yo = small_y[dan - DAN_YA];
+    } else {
+        return false;
+    }
+    if (!kana) {
+        return false;
+    }
+
+    return append_str(out, out_len, pos, kana) && (!yo || append_str(out, out_len, pos, yo)) &&
+           append_str(out, out_len, pos, vowels[v].tail) &&
+           (!HATSU(mask) || append_str(out, out_len, pos, "ん"));
+}
+
+static bool synthesize(const struct mejiro_state *st, char *out, size_t out_len) {
+    size_t pos = 0;
+
+    out[0] = '\0';
+    if (st->mod_mask & MJ_MOD_BIT_H) {
+        return false;
+    }
+    if (!synth_hand(st->left_mask, out, out_len, &pos)) {
+        return false;
+    }
+    if ((st->mod_mask & MJ_MOD_BIT_X) && !append_str(out, out_len, &pos, "っ")) {
+        return false;
+    }
+    if (!synth_hand(st->right_mask, out, out_len, &pos)) {
+        return false;
+    }
+    return pos > 0;
+}
+
+bool mejiro_lookup(const struct mejiro_state *latched, char *out, size_t out_len) {
     char stroke[64];
-    char out[96];
+    const char *exc;
 
+    if (!latched || !out || out_len == 0) {
+        return false;
+    }
     if (!mejiro_build_stroke_string(latched, stroke, sizeof(stroke))) {
         return false;
     }
+#if IS_ENABLED(CONFIG_ZMK_MEJIRO_USER_DICT)
+    if (mejiro_user_dict_lookup(mejiro_stroke_code(latched), out, out_len)) {
+        return true;
+    }
+#endif
+#if IS_ENABLED(CONFIG_ZMK_MEJIRO_FLASH_DICT)
+    if (mejiro_flash_dict_lookup(mejiro_stroke_code(latched), out, out_len)) {
+        return true;
+    }
+#endif
+    if (mejiro_tables_lookup(stroke, &exc)) {
+        if (strlen(exc) >= out_len) {
+            return false;
+        }
+        strcpy(out, exc);
+        return true;
+    }
+    return synthesize(latched, out, out_len);
+}
 
-    /* ここがあなたの確認ポイント: stroke が期待通り出るか */
-    LOG_DBG("MEJIRO stroke='%s' (L=0x%08x R=0x%08x M=0x%08x)",
-            stroke, latched->left_mask, latched->right_mask, latched->mod_mask);
+bool mejiro_try_emit(const struct mejiro_state *latched, int64_t timestamp) {
+    char out[MEJIRO_OUTPUT_MAX];
 
-    if (!mejiro_tables_lookup(stroke, out, sizeof(out))) {
-        LOG_DBG("MEJIRO tables: no match for '%s'", stroke);
+    if (!mejiro_lookup(latched, out, sizeof(out))) {
+        LOG_DBG("MEJIRO no match (L=0x%03x R=0x%03x M=0x%x)", latched->left_mask,
+                latched->right_mask, latched->mod_mask);
         return false;
     }
 
-    LOG_DBG("MEJIRO emit: '%s' <= '%s'", out, stroke);
+    LOG_DBG("MEJIRO emit: '%s' (L=0x%03x R=0x%03x M=0x%x)", out, latched->left_mask,
+            latched->right_mask, latched->mod_mask);
     return mejiro_send_text(out, timestamp);
 }
+
+/* ---- split half-stroke merge ------------------------------------------- */
+
+void mejiro_merge_init(struct mejiro_merge *m, uint16_t window_ms, uint16_t timeout_ms,
+                       mejiro_merge_cb emit, void *user_data) {
+    if (!m) return;
+    memset(m, 0, sizeof(*m));
+    m->window_ms = window_ms;
+    m->timeout_ms = timeout_ms;
+    m->emit = emit;
+    m->user_data = user_data;
+}
+
+static inline bool within(int64_t a, int64_t b, uint16_t window_ms) {
+    return (a > b ? a - b : b - a) <= window_ms;
+}
+
+static void emit_single(struct mejiro_merge *m, enum mejiro_half_src src, bool timeout) {
+    m->half[src].waiting = false;
+    m->stats.single++;
+    if (timeout) {
+        m->stats.timeouts++;
+    }
+    m->emit(m->half[src].code, m->half[src].done_at, m->user_data);
+}
+
+void mejiro_merge_start(struct mejiro_merge *m, enum mejiro_half_src src, int64_t ts) {
+    if (!m || src >= MEJIRO_HALF_COUNT) return;
+
+    if (m->half[src].active == 0) {
+        m->half[src].active_start = ts;
+    }
+    m->half[src].last_start = ts;
+    if (m->half[src].active < UINT8_MAX) {
+        m->half[src].active++;
+    }
+}
+
+void mejiro_merge_done(struct mejiro_merge *m, enum mejiro_half_src src, uint32_t code,
+                       int64_t ts) {
+    if (!m || src >= MEJIRO_HALF_COUNT) return;
+
+    const enum mejiro_half_src other = src == MEJIRO_HALF_LOCAL ? MEJIRO_HALF_REMOTE
+                                                                : MEJIRO_HALF_LOCAL;
+    struct mejiro_merge_half *h = &m->half[src];
+    struct mejiro_merge_half *o = &m->half[other];
+
+    /* 始まりを知らない（chord_seg が離上で切り出した）ストロークは確定時刻で代える */
+    const int64_t start = h->active ? h->active_start : ts;
+    if (h->active && --h->active) {
+        /* ロールオーバー中。次に古いものの始まりは分からないので最新で代える */
+        h->active_start = h->last_start;
+    }
+
+    if (h->waiting) {
+        /* 前の半分には相手が来なかった */
+        emit_single(m, src, false);
+    }
+    if (o->waiting) {
+        if (within(o->start, start, m->window_ms)) {
+            o->waiting = false;
+            m->stats.merged++;
+            m->emit(o->code | code, ts, m->user_data);
+            return;
+        }
+        emit_single(m, other, false);
+    }
+    if (o->active && within(o->active_start, start, m->window_ms)) {
+        /* 相手はまだ押されている: 確定を待つ */
+        h->waiting = true;
+        h->code = code;
+        h->start = start;
+        h->done_at = ts;
+        return;
+    }
+    m->stats.single++;
+    m->emit(code, ts, m->user_data);
+}
+
+void mejiro_merge_expire(struct mejiro_merge *m, int64_t now) {
+    if (!m) return;
+    for (int i = 0; i < MEJIRO_HALF_COUNT; i++) {
+        if (m->half[i].waiting && now - m->half[i].done_at >= m->timeout_ms) {
+            emit_single(m, (enum mejiro_half_src)i, true);
+        }
+    }
+}
+
+int64_t mejiro_merge_deadline(const struct mejiro_merge *m) {
+    int64_t deadline = -1;
+
+    for (int i = 0; m && i < MEJIRO_HALF_COUNT; i++) {
+        if (!m->half[i].waiting) {
+            continue;
+        }
+        const int64_t t = m->half[i].done_at + m->timeout_ms;
+        if (deadline < 0 || t < deadline) {
+            deadline = t;
+        }
+    }
+    return deadline;
+}
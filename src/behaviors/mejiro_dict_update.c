@@ -0,0 +1,324 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#include "mejiro/mejiro_dict_update.h"
+#include "mejiro/mejiro_flash_dict.h"
+
+LOG_MODULE_DECLARE(mejiro_core, CONFIG_ZMK_LOG_LEVEL);
+
+BUILD_ASSERT(FIXED_PARTITION_EXISTS(mejiro_dict_partition) &&
+                 FIXED_PARTITION_EXISTS(mejiro_dict_alt_partition),
+             "dictionary updates need mejiro_dict_partition and mejiro_dict_alt_partition");
+
+#define CHUNK_MAX CONFIG_ZMK_MEJIRO_DICT_UPDATE_CHUNK_MAX
+#define WRITE_BLOCK CONFIG_ZMK_MEJIRO_DICT_UPDATE_WRITE_BLOCK
+#define FRAME_MAX (CHUNK_MAX + 4)
+
+static const uint8_t slot_ids[2] = {
+    FIXED_PARTITION_ID(mejiro_dict_partition),
+    FIXED_PARTITION_ID(mejiro_dict_alt_partition),
+};
+
+static uint8_t active_slot;
+
+static const struct mejiro_dict_update_transport *transport;
+
+/* 書き込み中のイメージ */
+static struct {
+    bool open;
+    uint8_t slot;
+    const struct flash_area *fa;
+    uint32_t size;
+    uint32_t crc;
+    uint32_t received; /* 受け取った bytes（= 次の offset） */
+    uint32_t flushed;  /* flash に書いた bytes（WRITE_BLOCK 単位） */
+    uint16_t wlen;
+    uint8_t wbuf[WRITE_BLOCK];
+} up;
+
+/* 受信中のフレーム */
+static struct {
+    enum { S_SYNC0, S_SYNC1, S_TYPE, S_LEN0, S_LEN1, S_PAYLOAD, S_CRC0, S_CRC1 } st;
+    uint8_t type;
+    uint16_t len;
+    uint16_t pos;
+    uint16_t crc;
+    uint8_t buf[FRAME_MAX];
+} rx;
+
+uint8_t mejiro_dict_update_active_slot(void) { return active_slot; }
+
+/* ---- transport ------------------------------------------------------------ */
+
+/* 応答は { status i32, value u32 } だけ */
+static void respond(uint8_t type, int32_t status, uint32_t value) {
+    uint8_t frame[5 + 8 + 2] = {MJ_UPD_SYNC0, MJ_UPD_SYNC1, type | MJ_UPD_RESP, 8, 0};
+
+    sys_put_le32((uint32_t)status, &frame[5]);
+    sys_put_le32(value, &frame[9]);
+
+    const uint16_t crc = crc16_itu_t(0, &frame[2], 3 + 8);
+    frame[13] = (uint8_t)crc;
+    frame[14] = (uint8_t)(crc >> 8);
+    if (transport) {
+        (void)transport->write(frame, sizeof(frame), transport->ctx);
+    }
+}
+
+/* ---- update ------------------------------------------------------------- */
+
+static int flush_block(bool final) {
+    if (up.wlen == 0) {
+        return 0;
+    }
+    uint16_t len = up.wlen;
+    if (final) {
+        /* 最後は書き込み単位まで 0xFF で埋める */
+        len = ROUND_UP(up.wlen, flash_area_align(up.fa));
+        memset(&up.wbuf[up.wlen], 0xFF, len - up.wlen);
+    }
+    int err = flash_area_write(up.fa, up.flushed, up.wbuf, len);
+    if (err) {
+        return err;
+    }
+    up.flushed += up.wlen;
+    up.wlen = 0;
+    return 0;
+}
+
+static uint32_t crc_written(void) {
+    uint8_t buf[64];
+    uint32_t crc = 0;
+
+    for (uint32_t off = 0; off < up.size; off += sizeof(buf)) {
+        size_t n = MIN(sizeof(buf), up.size - off);
+        if (flash_area_read(up.fa, off, buf, n)) {
+            return ~up.crc;
+        }
+        crc = crc32_ieee_update(crc, buf, n);
+    }
+    return crc;
+}
+
+static void handle_begin(const uint8_t *p, uint16_t len) {
+    if (len != 8) {
+        respond(MJ_UPD_BEGIN, -EINVAL, 0);
+        return;
+    }
+
+    const uint32_t size = sys_get_le32(&p[0]);
+    const uint32_t crc = sys_get_le32(&p[4]);
+
+    /*
+     * 消去に時間がかかり、ホストが応答を待ちきれず同じ BEGIN を送り直すことがある。
+     * 同じイメージならもう消してあるので、消し直さずにそのまま続ける（DATA は
+     * 受け取った続きの offset を返す）
+     */
+    if (up.open && up.size == size && up.crc == crc) {
+        respond(MJ_UPD_BEGIN, 0, up.slot);
+        return;
+    }
+
+    memset(&up, 0, sizeof(up));
+    up.slot = !active_slot;
+    up.size = size;
+    up.crc = crc;
+
+    int err = flash_area_open(slot_ids[up.slot], &up.fa);
+    if (!err && up.size > up.fa->fa_size) {
+        err = -EFBIG;
+    }
+    if (!err) {
+        /* 有効な方には触らない。消すのは書き込み先だけ */
+        err = flash_area_erase(up.fa, 0, up.fa->fa_size);
+    }
+    if (err) {
+        respond(MJ_UPD_BEGIN, err, 0);
+        return;
+    }
+
+    up.open = true;
+    LOG_INF("MEJIRO dict update: %u bytes -> slot %u", up.size, up.slot);
+    respond(MJ_UPD_BEGIN, 0, up.slot);
+}
+
+static void handle_data(const uint8_t *p, uint16_t len) {
+    if (!up.open || len < 4) {
+        respond(MJ_UPD_DATA, -EINVAL, up.received);
+        return;
+    }
+    uint32_t off = sys_get_le32(p);
+    p += 4;
+    len -= 4;
+
+    if (off != up.received) {
+        /* 再送や取りこぼし: 次に欲しい offset を返す */
+        respond(MJ_UPD_DATA, -EAGAIN, up.received);
+        return;
+    }
+    if (off + len > up.size) {
+        respond(MJ_UPD_DATA, -EFBIG, up.received);
+        return;
+    }
+
+    while (len) {
+        uint16_t n = MIN(len, WRITE_BLOCK - up.wlen);
+        memcpy(&up.wbuf[up.wlen], p, n);
+        up.wlen += n;
+        up.received += n;
+        p += n;
+        len -= n;
+        if (up.wlen == WRITE_BLOCK) {
+            int err = flush_block(false);
+            if (err) {
+                up.open = false;
+                respond(MJ_UPD_DATA, err, up.received);
+                return;
+            }
+        }
+    }
+    respond(MJ_UPD_DATA, 0, up.received);
+}
+
+static void handle_end(void) {
+    int err = 0;
+
+    if (!up.open || up.received != up.size) {
+        err = -EINVAL;
+    }
+    if (!err) {
+        err = flush_block(true);
+    }
+    if (!err && crc_written() != up.crc) {
+        err = -EBADMSG;
+    }
+    up.open = false;
+
+    if (!err) {
+        /* ヘッダ/bucket の検査も通ってから切り替える（だめなら今の辞書のまま） */
+        err = mejiro_flash_dict_open(slot_ids[up.slot]);
+    }
+    if (!err) {
+        active_slot = up.slot;
+        err = settings_save_one("mejiro/dict/active", &active_slot, sizeof(active_slot));
+    }
+
+    LOG_INF("MEJIRO dict update: %s (%d), active slot %u", err ? "failed" : "done", err,
+            active_slot);
+    respond(MJ_UPD_END, err, active_slot);
+}
+
+static void handle_frame(void) {
+    switch (rx.type) {
+    case MJ_UPD_BEGIN:
+        handle_begin(rx.buf, rx.len);
+        break;
+    case MJ_UPD_DATA:
+        handle_data(rx.buf, rx.len);
+        break;
+    case MJ_UPD_END:
+        handle_end();
+        break;
+    case MJ_UPD_ABORT:
+        up.open = false;
+        respond(MJ_UPD_ABORT, 0, active_slot);
+        break;
+    case MJ_UPD_INFO:
+        respond(MJ_UPD_INFO, 0, active_slot);
+        break;
+    default:
+        respond(rx.type, -ENOTSUP, 0);
+        break;
+    }
+}
+
+static void rx_byte(uint8_t b) {
+    switch (rx.st) {
+    case S_SYNC0:
+        rx.st = (b == MJ_UPD_SYNC0) ? S_SYNC1 : S_SYNC0;
+        break;
+    case S_SYNC1:
+        rx.st = (b == MJ_UPD_SYNC1) ? S_TYPE : S_SYNC0;
+        break;
+    case S_TYPE:
+        rx.type = b;
+        rx.crc = crc16_itu_t(0, &b, 1);
+        rx.st = S_LEN0;
+        break;
+    case S_LEN0:
+        rx.len = b;
+        rx.crc = crc16_itu_t(rx.crc, &b, 1);
+        rx.st = S_LEN1;
+        break;
+    case S_LEN1:
+        rx.len |= (uint16_t)b << 8;
+        rx.crc = crc16_itu_t(rx.crc, &b, 1);
+        rx.pos = 0;
+        if (rx.len > FRAME_MAX) {
+            rx.st = S_SYNC0;
+        } else {
+            rx.st = rx.len ? S_PAYLOAD : S_CRC0;
+        }
+        break;
+    case S_PAYLOAD:
+        rx.buf[rx.pos++] = b;
+        rx.crc = crc16_itu_t(rx.crc, &b, 1);
+        if (rx.pos == rx.len) {
+            rx.st = S_CRC0;
+        }
+        break;
+    case S_CRC0:
+        rx.crc ^= b;
+        rx.st = S_CRC1;
+        break;
+    case S_CRC1:
+        rx.crc ^= (uint16_t)b << 8;
+        rx.st = S_SYNC0;
+        if (rx.crc == 0) {
+            handle_frame();
+        }
+        /* CRC 不一致は黙って捨てる（ホストのタイムアウトで再送） */
+        break;
+    }
+}
+
+void mejiro_dict_update_set_transport(const struct mejiro_dict_update_transport *t) {
+    transport = t;
+}
+
+void mejiro_dict_update_receive(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        rx_byte(data[i]);
+    }
+}
+
+/* ---- settings: mejiro/dict/active --------------------------------------- */
+
+static int dict_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+                             void *cb_arg) {
+    uint8_t slot;
+
+    if (strcmp(name, "active") != 0) {
+        return -ENOENT;
+    }
+    if (len != sizeof(slot) || read_cb(cb_arg, &slot, sizeof(slot)) < 0 || slot > 1) {
+        return -EINVAL;
+    }
+    if (slot != active_slot && mejiro_flash_dict_open(slot_ids[slot]) == 0) {
+        active_slot = slot;
+    }
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(mejiro_dict, "mejiro/dict", NULL, dict_settings_set, NULL, NULL);
@@ -0,0 +1,80 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * mejiro_dict_update over UART / USB CDC-ACM (chosen zmk,mejiro-dict-uart).
+ */
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/sys/util.h>
+
+#include "mejiro/mejiro_dict_update.h"
+
+LOG_MODULE_DECLARE(mejiro_core, CONFIG_ZMK_LOG_LEVEL);
+
+#define UART_NODE DT_CHOSEN(zmk_mejiro_dict_uart)
+BUILD_ASSERT(DT_NODE_EXISTS(UART_NODE), "set chosen zmk,mejiro-dict-uart for dictionary updates");
+
+static const struct device *const uart = DEVICE_DT_GET(UART_NODE);
+
+RING_BUF_DECLARE(rx_rb, CONFIG_ZMK_MEJIRO_DICT_UPDATE_RX_BUF);
+static K_SEM_DEFINE(rx_sem, 0, 1);
+
+static int uart_write(const uint8_t *data, size_t len, void *ctx) {
+    ARG_UNUSED(ctx);
+    for (size_t i = 0; i < len; i++) {
+        uart_poll_out(uart, data[i]);
+    }
+    return 0;
+}
+
+static const struct mejiro_dict_update_transport transport = {
+    .write = uart_write,
+};
+
+static void uart_isr(const struct device *dev, void *user_data) {
+    ARG_UNUSED(user_data);
+
+    while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+        if (!uart_irq_rx_ready(dev)) {
+            continue;
+        }
+        uint8_t buf[32];
+        int n = uart_fifo_read(dev, buf, sizeof(buf));
+        if (n > 0) {
+            /* 溢れた分は捨てる（フレームの CRC で弾かれ、ホストが再送する） */
+            (void)ring_buf_put(&rx_rb, buf, (uint32_t)n);
+            k_sem_give(&rx_sem);
+        }
+    }
+}
+
+static void update_thread(void *p1, void *p2, void *p3) {
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    if (!device_is_ready(uart)) {
+        LOG_ERR("MEJIRO dict update: UART not ready");
+        return;
+    }
+    mejiro_dict_update_set_transport(&transport);
+    uart_irq_callback_user_data_set(uart, uart_isr, NULL);
+    uart_irq_rx_enable(uart);
+
+    for (;;) {
+        uint8_t buf[32];
+        uint32_t n;
+
+        k_sem_take(&rx_sem, K_FOREVER);
+        while ((n = ring_buf_get(&rx_rb, buf, sizeof(buf))) > 0) {
+            mejiro_dict_update_receive(buf, n);
+        }
+    }
+}
+
+/* flash の消去・書き込みでキー入力のワークキューを止めないよう専用スレッド */
+K_THREAD_DEFINE(mejiro_dict_update, CONFIG_ZMK_MEJIRO_DICT_UPDATE_STACK_SIZE, update_thread, NULL,
+                NULL, NULL, CONFIG_ZMK_MEJIRO_DICT_UPDATE_THREAD_PRIORITY, 0, 0);
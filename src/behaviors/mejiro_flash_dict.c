@@ -0,0 +1,263 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/math_extras.h>
+#include <zephyr/sys/util.h>
+
+#include <chord/kana_pack.h>
+
+#include "mejiro/mejiro_core.h"
+#include "mejiro/mejiro_flash_dict.h"
+
+LOG_MODULE_DECLARE(mejiro_core, CONFIG_ZMK_LOG_LEVEL);
+
+#define PAGE_MAX CONFIG_ZMK_MEJIRO_FLASH_DICT_PAGE_MAX
+#define CACHE_SLOTS CONFIG_ZMK_MEJIRO_FLASH_DICT_CACHE_SLOTS
+#define TEXT_LEN CONFIG_ZMK_MEJIRO_FLASH_DICT_TEXT_LEN
+
+BUILD_ASSERT((CACHE_SLOTS & (CACHE_SLOTS - 1)) == 0, "cache slots must be a power of two");
+BUILD_ASSERT(PAGE_MAX > sizeof(struct mejiro_dict_header), "page must hold the header");
+BUILD_ASSERT(TEXT_LEN <= UINT8_MAX, "packed length is one byte");
+
+#define REC_HDR 4 /* u24 code + u8 len */
+
+struct cache_slot {
+    uint32_t code;
+    bool valid;
+    uint8_t len; /* 0 = 辞書に無いことをキャッシュ */
+    uint8_t packed[TEXT_LEN];
+};
+
+static struct {
+    const struct flash_area *fa;
+    struct mejiro_dict_header hdr;
+    uint8_t bucket_shift; /* 32 - log2(bucket_count) */
+    bool ready;
+    uint16_t hot_len;
+    uint8_t hot[PAGE_MAX - sizeof(struct mejiro_dict_header)]; /* page 0 のヘッダ以降（常駐） */
+    struct cache_slot cache[CACHE_SLOTS];
+    uint8_t page[PAGE_MAX];
+    struct mejiro_flash_dict_stats stats;
+} fd;
+
+static K_MUTEX_DEFINE(fd_lock);
+
+static inline uint32_t bucket_of(uint32_t code) {
+    return fd.bucket_shift >= 32 ? 0 : (code * 2654435761U) >> fd.bucket_shift;
+}
+
+static inline uint32_t slot_of(uint32_t code) {
+    return (code ^ (code >> MEJIRO_CODE_R_SHIFT) ^ (code >> MEJIRO_CODE_M_SHIFT)) &
+           (CACHE_SLOTS - 1);
+}
+
+/*
+ * ヘッダを読んで検査し、ヘッダの後ろから最後の bucket までの CRC を確かめる。
+ * fd には触らない（lock の外で、引いている辞書はそのまま使える）
+ */
+static int check_image(const struct flash_area *fa, struct mejiro_dict_header *h) {
+    uint8_t buf[64];
+
+    int err = flash_area_read(fa, 0, h, sizeof(*h));
+    if (err) {
+        return err;
+    }
+    if (h->magic != MEJIRO_DICT_MAGIC || h->version != MEJIRO_DICT_VERSION) {
+        return -ENOENT;
+    }
+    if (h->page_size < sizeof(*h) || h->page_size > PAGE_MAX || h->bucket_count == 0 ||
+        (h->bucket_count & (h->bucket_count - 1)) != 0 ||
+        (uint64_t)(h->bucket_count + 1) * h->page_size > fa->fa_size) {
+        return -EINVAL;
+    }
+
+    const uint32_t end = (h->bucket_count + 1) * h->page_size;
+    uint32_t crc = 0;
+    for (uint32_t off = sizeof(*h); off < end; off += sizeof(buf)) {
+        const size_t n = MIN(sizeof(buf), end - off);
+        /* 読めないのは壊れたイメージとは別（-EBADMSG にしない） */
+        err = flash_area_read(fa, off, buf, n);
+        if (err) {
+            return err;
+        }
+        crc = crc32_ieee_update(crc, buf, n);
+    }
+    return crc == h->crc32 ? 0 : -EBADMSG;
+}
+
+/*
+ * { u16 count, { u24 code; u8 len; packed }... } から code を探す。見つかれば *packed を
+ * buf の中の packed に向けて長さを返す。無ければ 0
+ */
+static uint8_t find_record(const uint8_t *buf, size_t size, uint32_t code,
+                           const uint8_t **packed) {
+    if (size < 2) {
+        return 0;
+    }
+    uint16_t count = sys_get_le16(buf);
+    size_t p = 2;
+    for (uint16_t i = 0; i < count && p + REC_HDR <= size; i++) {
+        uint32_t c = sys_get_le24(&buf[p]);
+        uint8_t len = buf[p + 3];
+        p += REC_HDR;
+        if (p + len > size) {
+            break;
+        }
+        if (c == code) {
+            if (len > TEXT_LEN) {
+                return 0;
+            }
+            *packed = &buf[p];
+            return len;
+        }
+        p += len;
+    }
+    return 0;
+}
+
+/*
+ * bucket を 1 ページ読んで code を探し、slot に入れる（無いことも）。
+ * 読めなければ slot には入れず（次はまた読む）0
+ */
+static uint8_t read_bucket(uint32_t code, struct cache_slot *slot, const uint8_t **packed) {
+    const uint16_t ps = fd.hdr.page_size;
+    off_t off = (off_t)(bucket_of(code) + 1) * ps;
+
+    fd.stats.page_reads++;
+    if (flash_area_read(fd.fa, off, fd.page, ps)) {
+        return 0;
+    }
+
+    const uint8_t len = find_record(fd.page, ps, code, packed);
+    slot->code = code;
+    slot->len = len;
+    slot->valid = true;
+    memcpy(slot->packed, *packed, len);
+    return len;
+}
+
+/* ---- public ------------------------------------------------------------ */
+
+int mejiro_flash_dict_open(uint8_t partition_id) {
+    const struct flash_area *fa;
+    struct mejiro_dict_header h;
+
+    /* 全体の CRC は長くかかるので lock の外で。ここでだめなら今の辞書のまま */
+    int err = flash_area_open(partition_id, &fa);
+    if (!err) {
+        err = check_image(fa, &h);
+        if (err) {
+            flash_area_close(fa);
+        }
+    }
+    if (err) {
+        LOG_WRN("MEJIRO flash dict: partition %u not usable (%d)", partition_id, err);
+        return err;
+    }
+
+    k_mutex_lock(&fd_lock, K_FOREVER);
+    if (fd.fa) {
+        flash_area_close(fd.fa);
+    }
+    fd.fa = fa;
+    fd.hdr = h;
+    fd.hot_len = h.page_size - sizeof(h);
+    err = flash_area_read(fa, sizeof(h), fd.hot, fd.hot_len);
+    memset(fd.cache, 0, sizeof(fd.cache));
+    fd.bucket_shift = 32 - (uint8_t)u32_count_trailing_zeros(h.bucket_count);
+    fd.ready = !err;
+    k_mutex_unlock(&fd_lock);
+
+    if (err) {
+        LOG_WRN("MEJIRO flash dict: partition %u not usable (%d)", partition_id, err);
+        return err;
+    }
+    LOG_INF("MEJIRO flash dict: %u entries, %u buckets", h.entry_count, h.bucket_count);
+    return 0;
+}
+
+bool mejiro_flash_dict_lookup(uint32_t code, char *out, size_t out_len) {
+    const uint8_t *packed = NULL;
+    uint8_t len;
+    bool found = false;
+
+    k_mutex_lock(&fd_lock, K_FOREVER);
+    if (!fd.ready) {
+        k_mutex_unlock(&fd_lock);
+        return false;
+    }
+    fd.stats.lookups++;
+
+    struct cache_slot *slot = &fd.cache[slot_of(code)];
+    if ((len = find_record(fd.hot, fd.hot_len, code, &packed)) > 0) {
+        fd.stats.hot_hits++;
+    } else if (slot->valid && slot->code == code) {
+        fd.stats.cache_hits++;
+        len = slot->len;
+        packed = slot->packed;
+    } else {
+        len = read_bucket(code, slot, &packed);
+    }
+
+    /* hot table / キャッシュ / ページから、呼び出し側のバッファへ直接展開する */
+    if (len > 0 && kana_pack_decode(packed, len, out, out_len) > 0) {
+        fd.stats.found++;
+        found = true;
+    }
+    k_mutex_unlock(&fd_lock);
+    return found;
+}
+
+void mejiro_flash_dict_get_stats(struct mejiro_flash_dict_stats *out) {
+    if (out) {
+        *out = fd.stats;
+    }
+}
+
+#if FIXED_PARTITION_EXISTS(mejiro_dict_partition)
+static int mejiro_flash_dict_init(void) {
+    (void)mejiro_flash_dict_open(FIXED_PARTITION_ID(mejiro_dict_partition));
+    return 0;
+}
+
+SYS_INIT(mejiro_flash_dict_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+#endif
+
+/* ---- shell: chord fdict ------------------------------------------------- */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static int cmd_fdict(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    struct mejiro_flash_dict_stats st;
+    mejiro_flash_dict_get_stats(&st);
+
+    if (!fd.ready) {
+        shell_print(sh, "flash dict: not loaded");
+    } else {
+        shell_print(sh, "flash dict: %u entries, %u buckets x %u bytes", fd.hdr.entry_count,
+                    fd.hdr.bucket_count, fd.hdr.page_size);
+    }
+    uint32_t ram = st.hot_hits + st.cache_hits;
+    shell_print(sh, "lookups %u, hot %u, cache hits %u (RAM %u%%), page reads %u, found %u",
+                st.lookups, st.hot_hits, st.cache_hits, st.lookups ? (ram * 100U) / st.lookups : 0,
+                st.page_reads, st.found);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((chord), fdict, NULL, "Flash dictionary status and cache hit rate", cmd_fdict,
+                 1, 0);
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Split peripheral: Mejiro half-stroke pre-aggregation (CONFIG_ZMK_MEJIRO_SPLIT_HALF).
+ *
+ * - compatible: "zmk,mejiro-half"（input デバイス。zmk,input-split の device に指定する）
+ *
+ * &mj のキーの position イベントは split に流さずここで止め、この半分だけで chord_seg に
+ * 通す。ストロークの始まりで START、確定で STROKE(code) を input_report し、ZMK の
+ * input split が central に運ぶ（mejiro_split.h）。&mj 以外のキーはそのまま流す。
+ * 窓と確定の方式は central の chord tune に合わせる（mejiro_half_tune）。
+ */
+
+#define DT_DRV_COMPAT zmk_mejiro_half
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/input/input.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/iterable_sections.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/matrix.h>
+
+#include "mejiro/mejiro_key_ids.h"
+#include "mejiro/mejiro_positions.h"
+#include "mejiro/mejiro_split.h"
+
+#include <chord/chord_seg.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) == 1, "one zmk,mejiro-half node");
+
+/* central と同じ表（keymap はこちらのビルドにも入っている） */
+MJ_POSITION_CHECKS
+
+static const uint32_t mj_position_bits[ZMK_KEYMAP_LEN] = MJ_POSITION_BITS_INIT;
+
+/*
+ * 切り方は central の &mj と同じ（30 = CONFIG_ZMK_CHORD_ROLLOVER_SPLIT_MS の既定）。
+ * central で chord tune を変えると mejiro_half_tune() で届く
+ */
+#define HALF_WINDOW_MS DT_PROP_OR(MJ_BEHAVIOR, chord_window_ms, 30)
+#define HALF_COMMIT_MODE DT_ENUM_IDX_OR(MJ_BEHAVIOR, commit_mode, CHORD_COMMIT_ROLLOVER)
+
+static const struct device *const half_dev = DEVICE_DT_INST_GET(0);
+
+static struct {
+    struct chord_seg seg;
+    uint32_t swallowed; /* 止めた押下（離上も止める） */
+    uint8_t started;    /* START を送った未確定ストローク数 */
+    bool enabled;
+    bool ordered; /* split の listener より先に呼ばれる（mejiro_half_init で確かめる） */
+} half = {.enabled = DT_INST_PROP(0, enabled_by_default)};
+
+static void report(uint16_t code, uint32_t value) {
+    int err = input_report(half_dev, MEJIRO_SPLIT_EV_TYPE, code, (int32_t)value, true, K_NO_WAIT);
+    if (err) {
+        LOG_WRN("mejiro half: report %u failed (%d)", code, err);
+    }
+}
+
+/*
+ * 新しく増えたストロークの START。離上時の切り出しでも増えるので press / release の後に
+ * 見る。value は始まってからの ms（central はそれを引いて始まりの時刻にする）。
+ */
+static void report_starts(int64_t now) {
+    while (half.started < half.seg.count) {
+        const struct chord_stroke *s = chord_seg_pending(&half.seg, half.started++);
+        report(MEJIRO_SPLIT_CODE_START, (uint32_t)MAX(now - s->first_press, 0));
+    }
+}
+
+static void on_stroke_commit(const struct chord_stroke *stroke, void *user_data) {
+    ARG_UNUSED(user_data);
+    uint32_t code = 0;
+
+    if (half.started) {
+        half.started--;
+    }
+
+    for (uint8_t i = 0; i < stroke->count; i++) {
+        code |= stroke->keys[i];
+    }
+    report(MEJIRO_SPLIT_CODE_STROKE, code);
+}
+
+void mejiro_half_set_enabled(bool enabled) {
+    if (half.enabled && !enabled) {
+        /* 押下中のキーの離上は swallowed で止まる */
+        chord_seg_flush(&half.seg);
+    }
+    half.enabled = enabled;
+}
+
+bool mejiro_half_enabled(void) { return half.enabled; }
+
+void mejiro_half_tune(uint16_t window_ms, uint8_t commit_mode) {
+    chord_seg_set_window(&half.seg, window_ms);
+    chord_seg_set_mode(&half.seg, commit_mode);
+    LOG_DBG("mejiro half: window %u ms, mode %u", window_ms, commit_mode);
+}
+
+/*
+ * HANDLED を返したイベントは、後に呼ばれる split の listener が central に送らない。
+ * ZMK は subscription を iterable section の名前順（zmk_event_sub_<listener>...）に呼ぶので、
+ * この listener の順番は名前 "mejiro_half" で決まる: activity（idle / sleep の計測）より後、
+ * split の listener（"service" / "split_peripheral"）より先。init で実際の順番を確かめ、
+ * 違えば止めずにすべて流す（central が &mj のキーを 1 つずつ受ける、merge 無しの動き）。
+ */
+static int mejiro_half_listener(const zmk_event_t *eh) {
+    const struct zmk_position_state_changed *ev = as_zmk_position_state_changed(eh);
+
+    if (!ev || ev->position >= ARRAY_SIZE(mj_position_bits)) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+    const uint32_t bit = mj_position_bits[ev->position];
+    if (!bit) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    if (ev->state) {
+        if (!half.enabled || !half.ordered) {
+            return ZMK_EV_EVENT_BUBBLE;
+        }
+        half.swallowed |= bit;
+        (void)chord_seg_press(&half.seg, bit, ev->timestamp);
+        report_starts(ev->timestamp);
+        return ZMK_EV_EVENT_HANDLED;
+    }
+
+    if (!(half.swallowed & bit)) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+    half.swallowed &= ~bit;
+    chord_seg_release(&half.seg, bit, ev->timestamp);
+    report_starts(ev->timestamp);
+    return ZMK_EV_EVENT_HANDLED;
+}
+
+ZMK_LISTENER(mejiro_half, mejiro_half_listener);
+ZMK_SUBSCRIPTION(mejiro_half, zmk_position_state_changed);
+
+/* position event を central に送る ZMK の listener（版で名前が違う。無い方は NULL） */
+extern const struct zmk_listener zmk_listener_service __weak;
+extern const struct zmk_listener zmk_listener_split_peripheral __weak;
+
+static bool listener_ordered(void) {
+    STRUCT_SECTION_FOREACH(zmk_event_subscription, sub) {
+        if (sub->event_type != &zmk_event_zmk_position_state_changed) {
+            continue;
+        }
+        if (sub->listener == &zmk_listener_mejiro_half) {
+            return true;
+        }
+        if (sub->listener == &zmk_listener_service ||
+            sub->listener == &zmk_listener_split_peripheral) {
+            return false;
+        }
+    }
+    return false;
+}
+
+static int mejiro_half_init(const struct device *dev) {
+    ARG_UNUSED(dev);
+    half.ordered = listener_ordered();
+    if (!half.ordered) {
+        LOG_ERR("mejiro half: split forwards position events first, not aggregating");
+    }
+    chord_seg_init(&half.seg, HALF_WINDOW_MS, on_stroke_commit, NULL);
+    chord_seg_set_mode(&half.seg, HALF_COMMIT_MODE);
+    return 0;
+}
+
+DEVICE_DT_INST_DEFINE(0, mejiro_half_init, NULL, NULL, NULL, POST_KERNEL,
+                      CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, NULL);
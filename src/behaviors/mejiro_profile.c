@@ -0,0 +1,219 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include "mejiro/mejiro_core.h"
+#include "mejiro/mejiro_profile.h"
+
+#include <chord/chord_power.h>
+
+LOG_MODULE_DECLARE(mejiro_core, CONFIG_ZMK_LOG_LEVEL);
+
+#define SLOTS CONFIG_ZMK_MEJIRO_PROFILE_SLOTS
+#define MAX_PROBE 8
+
+BUILD_ASSERT((SLOTS & (SLOTS - 1)) == 0, "profile slots must be a power of two");
+
+struct counter {
+    uint32_t code; /* 0 = 空き（code 0 のストロークは無い） */
+    uint32_t count;
+};
+
+static struct {
+    struct counter slots[SLOTS];
+    struct mejiro_profile_stats stats;
+} prof;
+
+/* hit は入力の経路から来るので spinlock。保存は写しを取ってから lock の外で */
+static struct k_spinlock prof_lock;
+static struct counter saving[SLOTS];
+
+/* 書き込みをまとめる: 最初のヒットから SAVE_INTERVAL 後に 1 回保存 */
+static void save_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    chord_power_wake(CHORD_WAKE_STORE);
+
+    k_spinlock_key_t key = k_spin_lock(&prof_lock);
+    memcpy(saving, prof.slots, sizeof(saving));
+    k_spin_unlock(&prof_lock, key);
+
+    int err = settings_save_one("mejiro/prof", saving, sizeof(saving));
+    if (err) {
+        LOG_WRN("MEJIRO profile: save failed (%d)", err);
+        return;
+    }
+    key = k_spin_lock(&prof_lock);
+    prof.stats.saves++;
+    k_spin_unlock(&prof_lock, key);
+}
+
+static K_WORK_DELAYABLE_DEFINE(save_work, save_work_handler);
+
+static inline uint32_t slot_of(uint32_t code) { return (code * 2654435761U) >> 16; }
+
+void mejiro_profile_hit(uint32_t code) {
+    if (code == 0) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&prof_lock);
+    for (uint32_t i = 0; i < MAX_PROBE; i++) {
+        struct counter *c = &prof.slots[(slot_of(code) + i) & (SLOTS - 1)];
+        if (c->code == 0) {
+            c->code = code;
+            prof.stats.used++;
+        }
+        if (c->code == code) {
+            if (c->count != UINT32_MAX) {
+                c->count++;
+            }
+            prof.stats.strokes++;
+            k_spin_unlock(&prof_lock, key);
+            /* 既に予約済みなら延ばさない（打ち続けても保存はされる） */
+            k_work_schedule(&save_work, K_SECONDS(CONFIG_ZMK_MEJIRO_PROFILE_SAVE_INTERVAL_S));
+            return;
+        }
+    }
+    prof.stats.dropped++;
+    k_spin_unlock(&prof_lock, key);
+}
+
+void mejiro_profile_foreach(mejiro_profile_visit_cb cb, void *user_data) {
+    if (!cb) {
+        return;
+    }
+    for (uint32_t i = 0; i < SLOTS; i++) {
+        k_spinlock_key_t key = k_spin_lock(&prof_lock);
+        const struct counter c = prof.slots[i];
+        k_spin_unlock(&prof_lock, key);
+
+        if (c.code && !cb(c.code, c.count, user_data)) {
+            break;
+        }
+    }
+}
+
+void mejiro_profile_reset(void) {
+    k_work_cancel_delayable(&save_work);
+
+    k_spinlock_key_t key = k_spin_lock(&prof_lock);
+    memset(&prof, 0, sizeof(prof));
+    k_spin_unlock(&prof_lock, key);
+    (void)settings_delete("mejiro/prof");
+}
+
+void mejiro_profile_get_stats(struct mejiro_profile_stats *out) {
+    if (out) {
+        k_spinlock_key_t key = k_spin_lock(&prof_lock);
+        *out = prof.stats;
+        k_spin_unlock(&prof_lock, key);
+    }
+}
+
+/* ---- settings ------------------------------------------------------------ */
+
+static int prof_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+                             void *cb_arg) {
+    if (name[0] != '\0') {
+        return -ENOENT;
+    }
+    if (len != sizeof(prof.slots)) {
+        /* スロット数が変わった: 古い計数は捨てる */
+        return 0;
+    }
+
+    ssize_t rc = read_cb(cb_arg, prof.slots, sizeof(prof.slots));
+    if (rc < 0) {
+        memset(prof.slots, 0, sizeof(prof.slots));
+        return (int)rc;
+    }
+
+    prof.stats.used = 0;
+    for (uint32_t i = 0; i < SLOTS; i++) {
+        if (prof.slots[i].code) {
+            prof.stats.used++;
+        }
+    }
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(mejiro_prof, "mejiro/prof", NULL, prof_settings_set, NULL, NULL);
+
+/* ---- shell: chord prof [stats|reset] --------------------------------------- */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+struct print_ctx {
+    const struct shell *sh;
+    bool first;
+};
+
+static bool print_count(uint32_t code, uint32_t count, void *user_data) {
+    struct print_ctx *ctx = user_data;
+    struct mejiro_state st = {
+        .left_mask = code & 0x1FF,
+        .right_mask = (code >> MEJIRO_CODE_R_SHIFT) & 0x1FF,
+        .mod_mask = code >> MEJIRO_CODE_M_SHIFT,
+    };
+    char stroke[64];
+
+    if (mejiro_build_stroke_string(&st, stroke, sizeof(stroke))) {
+        shell_print(ctx->sh, "%s\"%s\": %u", ctx->first ? "  " : ", ", stroke, count);
+        ctx->first = false;
+    }
+    return true;
+}
+
+/* mejiro_dictc.py --profile にそのまま渡せる JSON（JSON 以外は出さない） */
+static int cmd_prof(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    struct print_ctx ctx = {.sh = sh, .first = true};
+
+    shell_print(sh, "{");
+    mejiro_profile_foreach(print_count, &ctx);
+    shell_print(sh, "}");
+    return 0;
+}
+
+static int cmd_prof_stats(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    struct mejiro_profile_stats st;
+
+    mejiro_profile_get_stats(&st);
+    shell_print(sh, "%u strokes, %u/%u slots, %u dropped, %u saves", st.strokes, st.used, SLOTS,
+                st.dropped, st.saves);
+    return 0;
+}
+
+static int cmd_prof_reset(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    mejiro_profile_reset();
+    shell_print(sh, "profile cleared");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(prof_cmds,
+                               SHELL_CMD_ARG(stats, NULL, "strokes counted and slots used",
+                                             cmd_prof_stats, 1, 0),
+                               SHELL_CMD_ARG(reset, NULL, "clear all counters", cmd_prof_reset,
+                                             1, 0),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chord), prof, &prof_cmds, "Stroke hit counters as JSON (dictc --profile)",
+                 cmd_prof, 1, 0);
+
+#endif
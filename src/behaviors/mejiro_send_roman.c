@@ -1,45 +1,33 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-#include <zephyr/logging/log.h>
+#include <zephyr/kernel.h>
 
-#include <zmk/hid.h>
-#include <dt-bindings/zmk/keys.h>
+#include <chord/kana_out.h>
 
 #include "mejiro/mejiro_send_roman.h"
 
-
 /*
  * ここは環境差が出やすい。
- * - SEND_STRING を使える構成ならそれを使う
- * - 使えないなら ZMK の HID 送信APIに差し替え
- *
- * まずは「コンパイルが通る」最小として、ZMK側のユーティリティを使う版だけ用意。
+ * 実際の keycode 化は chord/kana_out（Naginata と共通）に任せる。
+ * テーブルの出力はローマ字でも、かな（UTF-8）でもよい。
  */
-#include <zmk/hid.h>
-#include <zmk/keys.h>
 
-#include <string.h>
+/* behavior-mejiro の inter-key-gap-ms（init で 1 回だけ設定） */
+static uint16_t tap_gap_ms;
 
-/* ASCII 1文字だけ送る最小（必要なら後で拡張） */
-static bool send_ascii_char(char c) {
-    /* printable ASCII only */
-    if (c < 0x20 || c > 0x7E) {
-        return false;
-    }
+void mejiro_send_set_tap_gap(uint16_t gap_ms) { tap_gap_ms = gap_ms; }
 
-    /* ZMK の keycode に落とすのは完全対応が必要なので、ここは後で本実装に置換前提。
-       今は「送信部の枠」を用意するだけ。*/
-    return false;
+bool mejiro_send_text(const char *text, int64_t timestamp) {
+    return kana_out_send_paced(text, tap_gap_ms, timestamp);
 }
 
-bool mejiro_send_roman(const char *text) {
-    if (!text) {
-        return false;
-    }
-
-    /* いったん「送れたことにする」ダミーでビルドを通す版（動作確認は後で実装）。 */
-    (void)text;
-    return true;
+void mejiro_send_backspaces(size_t count, int64_t timestamp) {
+    kana_out_backspaces_paced(count, tap_gap_ms, timestamp);
 }
+
+bool mejiro_send_roman(const char *text) { return mejiro_send_text(text, k_uptime_get()); }
@@ -0,0 +1,137 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "mejiro/mejiro_core.h"
+#include "mejiro/mejiro_send_roman.h"
+#include "mejiro/mejiro_spec.h"
+
+LOG_MODULE_DECLARE(mejiro_core, CONFIG_ZMK_LOG_LEVEL);
+
+static struct {
+    char journal[CONFIG_ZMK_MEJIRO_SPECULATIVE_JOURNAL_LEN]; /* いまホストに見えている推測出力 */
+    bool active;
+    int64_t started;
+    struct mejiro_spec_stats stats;
+} spec;
+
+/*
+ * 推測で送ってよいのは、1 コードポイントがホストで 1 文字になるものだけ:
+ * かな、ー・、。「」（IME が 1 文字にする）。ローマ字や ASCII を出す辞書の項目は
+ * IME の変換前の状態で見え方が変わり、BS の数が合わないので推測しない。
+ */
+static bool plain_kana(const char *s) {
+    if (!*s) {
+        return false;
+    }
+    while (*s) {
+        const uint8_t *u = (const uint8_t *)s;
+        if (u[0] != 0xE3 || (u[1] & 0xC0) != 0x80 || (u[2] & 0xC0) != 0x80) {
+            return false;
+        }
+        const uint32_t cp = 0x3000 | ((u[1] & 0x3F) << 6) | (u[2] & 0x3F);
+        if (!((cp >= 0x3041 && cp <= 0x3096) || (cp >= 0x30A1 && cp <= 0x30FC) ||
+              cp == 0x3001 || cp == 0x3002 || cp == 0x300C || cp == 0x300D)) {
+            return false;
+        }
+        s += 3;
+    }
+    return true;
+}
+
+/* ホスト側で BS 1 回に相当する単位 = UTF-8 のコードポイント数（journal は plain_kana のみ） */
+static size_t count_units(const char *s) {
+    size_t n = 0;
+    for (; *s; s++) {
+        if (((uint8_t)*s & 0xC0) != 0x80) {
+            n++;
+        }
+    }
+    return n;
+}
+
+/* journal -> next へ最小の BS + 差分で差し替える（1 回のバースト） */
+static void replace_output(const char *next, int64_t timestamp) {
+    size_t p = 0;
+    while (spec.journal[p] && spec.journal[p] == next[p]) {
+        p++;
+    }
+    /* コードポイント境界まで戻す */
+    while (p > 0 && ((uint8_t)spec.journal[p] & 0xC0) == 0x80) {
+        p--;
+    }
+
+    size_t bs = count_units(&spec.journal[p]);
+    if (bs) {
+        mejiro_send_backspaces(bs, timestamp);
+        spec.stats.rollbacks++;
+        spec.stats.rollback_chars += bs;
+    }
+    if (!mejiro_send_text(&next[p], timestamp)) {
+        /* 送れなかった（encode できない）: 見えているのは共通部分だけ */
+        spec.journal[p] = '\0';
+        return;
+    }
+
+    strncpy(spec.journal, next, sizeof(spec.journal) - 1);
+    spec.journal[sizeof(spec.journal) - 1] = '\0';
+}
+
+void mejiro_spec_update(const struct mejiro_state *partial, int64_t first_press, int64_t timestamp) {
+    char out[sizeof(spec.journal)];
+
+    if (spec.active && (timestamp - spec.started) > CONFIG_ZMK_MEJIRO_SPECULATIVE_WINDOW_MS) {
+        /* 窓を過ぎたら推測は動かさない（確定時に補正する） */
+        return;
+    }
+    if (!mejiro_lookup(partial, out, sizeof(out)) || !plain_kana(out)) {
+        /* 解釈が無い、journal に入らない、かな以外（巻き戻せない）なら直前の推測を残す */
+        return;
+    }
+
+    if (!spec.active) {
+        spec.active = true;
+        spec.started = first_press;
+        spec.journal[0] = '\0';
+    }
+    if (strcmp(out, spec.journal) == 0) {
+        return;
+    }
+
+    replace_output(out, timestamp);
+    spec.stats.speculated++;
+    LOG_DBG("MEJIRO spec: '%s'", out);
+}
+
+bool mejiro_spec_commit(const struct mejiro_state *latched, int64_t timestamp) {
+    char out[MEJIRO_OUTPUT_MAX];
+
+    if (!spec.active) {
+        return false;
+    }
+    spec.active = false;
+
+    if (!mejiro_lookup(latched, out, sizeof(out))) {
+        out[0] = '\0';
+    }
+
+    if (strcmp(out, spec.journal) == 0) {
+        spec.stats.confirmed++;
+    } else {
+        replace_output(out, timestamp);
+        LOG_DBG("MEJIRO spec: corrected to '%s' (rollbacks=%u)", out, spec.stats.rollbacks);
+    }
+
+    spec.journal[0] = '\0';
+    return true;
+}
+
+void mejiro_spec_get_stats(struct mejiro_spec_stats *out) {
+    if (out) {
+        *out = spec.stats;
+    }
+}
@@ -5,29 +5,25 @@
 
 #include <string.h>
 
-/* 最小：動作確認用。必要なら後で増やす */
+/*
+ * 例外表。通常のかなは mejiro_core.c が左右のマスクから合成するので、
+ * ここには規則で作れないもの（'#' 付きの記号、単独の '*' など）だけを置く。
+ */
 struct entry {
     const char *stroke;
     const char *out;
 };
 
 static const struct entry k_table[] = {
-    /* 例: 左だけ */
-    {"t", "t"},
-    {"k", "k"},
-    {"n", "n"},
-
-    /* 例: 右だけ（右だけは '-' 始まりのルールに合わせる） */
-    {"-t", "t"},
-    {"-k", "k"},
-    {"-n", "n"},
-
-    /* 例: 両手（'-' 挟む） */
-    {"t-k", "tk"},
-    {"k-t", "kt"},
-
-    /* 例: mod */
-    {"t#", "t"}, /* '#' は装飾扱いにしても良い。ここは仮 */
+    {"#", "ー"},
+    {"*", "っ"},
+    {"#*", "・"},
+
+    /* '#' + 右母音 = 句読点・括弧 */
+    {"#-i", "、"},
+    {"#-a", "。"},
+    {"#-ia", "「"},
+    {"#-aU", "」"},
 };
 
 bool mejiro_tables_lookup(const char *stroke, const char **out) {
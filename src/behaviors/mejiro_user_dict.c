@@ -0,0 +1,299 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include "mejiro/mejiro_core.h"
+#include "mejiro/mejiro_user_dict.h"
+
+LOG_MODULE_DECLARE(mejiro_core, CONFIG_ZMK_LOG_LEVEL);
+
+#define UD_SUBTREE "mejiro/ud"
+#define UD_MAX CONFIG_ZMK_MEJIRO_USER_DICT_MAX_ENTRIES
+#define UD_TEXT_LEN CONFIG_ZMK_MEJIRO_USER_DICT_TEXT_LEN
+#define BLOOM_BITS CONFIG_ZMK_MEJIRO_USER_DICT_BLOOM_BITS
+
+BUILD_ASSERT((BLOOM_BITS & (BLOOM_BITS - 1)) == 0, "Bloom filter size must be a power of two");
+BUILD_ASSERT(UD_TEXT_LEN <= MEJIRO_OUTPUT_MAX, "user entries must fit one stroke output");
+
+struct ud_entry {
+    uint32_t code;
+    char text[UD_TEXT_LEN];
+};
+
+static struct {
+    struct ud_entry entries[UD_MAX];
+    uint16_t count;
+    uint32_t bloom[BLOOM_BITS / 32];
+    struct mejiro_user_dict_stats stats;
+} ud;
+
+/* shell スレッドからの追加/削除と、キー入力側の検索を分ける */
+static K_MUTEX_DEFINE(ud_lock);
+
+/* ---- Bloom filter（k = 2） ------------------------------------------------ */
+
+static inline uint32_t mix(uint32_t code) {
+    code ^= code >> 16;
+    code *= 0x7feb352dU;
+    code ^= code >> 15;
+    code *= 0x846ca68bU;
+    code ^= code >> 16;
+    return code;
+}
+
+static inline void bloom_add(uint32_t code) {
+    uint32_t h = mix(code);
+    uint32_t a = h % BLOOM_BITS;
+    uint32_t b = (h >> 16) % BLOOM_BITS;
+    ud.bloom[a / 32] |= 1u << (a % 32);
+    ud.bloom[b / 32] |= 1u << (b % 32);
+}
+
+static inline bool bloom_maybe(uint32_t code) {
+    uint32_t h = mix(code);
+    uint32_t a = h % BLOOM_BITS;
+    uint32_t b = (h >> 16) % BLOOM_BITS;
+    return (ud.bloom[a / 32] & (1u << (a % 32))) && (ud.bloom[b / 32] & (1u << (b % 32)));
+}
+
+/* 削除はビットを落とせないので作り直す */
+static void bloom_rebuild(void) {
+    memset(ud.bloom, 0, sizeof(ud.bloom));
+    for (uint16_t i = 0; i < ud.count; i++) {
+        bloom_add(ud.entries[i].code);
+    }
+}
+
+static int find(uint32_t code) {
+    for (uint16_t i = 0; i < ud.count; i++) {
+        if (ud.entries[i].code == code) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* 保存はせず RAM にだけ入れる（settings の読み込みからも使う） */
+static int put(uint32_t code, const char *text, size_t len) {
+    if (len == 0 || len >= UD_TEXT_LEN) {
+        return -EINVAL;
+    }
+
+    int i = find(code);
+    if (i < 0) {
+        if (ud.count == UD_MAX) {
+            return -ENOMEM;
+        }
+        i = ud.count++;
+        ud.entries[i].code = code;
+        bloom_add(code);
+    }
+    memcpy(ud.entries[i].text, text, len);
+    ud.entries[i].text[len] = '\0';
+    ud.stats.entries = ud.count;
+    return 0;
+}
+
+/* ---- public ------------------------------------------------------------ */
+
+bool mejiro_user_dict_lookup(uint32_t code, char *out, size_t out_len) {
+    bool found = false;
+
+    /* remove の bloom_rebuild 中に覗くと、まだある code を落とすので Bloom も lock の中 */
+    k_mutex_lock(&ud_lock, K_FOREVER);
+    if (!bloom_maybe(code)) {
+        ud.stats.rejected++;
+        k_mutex_unlock(&ud_lock);
+        return false;
+    }
+
+    int i = find(code);
+    if (i >= 0 && strlen(ud.entries[i].text) < out_len) {
+        strcpy(out, ud.entries[i].text);
+        found = true;
+    }
+    if (found) {
+        ud.stats.hits++;
+    } else {
+        ud.stats.false_positives++;
+    }
+    k_mutex_unlock(&ud_lock);
+    return found;
+}
+
+int mejiro_user_dict_add(uint32_t code, const char *text) {
+    char key[sizeof(UD_SUBTREE) + 10];
+
+    if (!text) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&ud_lock, K_FOREVER);
+    int err = put(code, text, strlen(text));
+    k_mutex_unlock(&ud_lock);
+    if (err) {
+        return err;
+    }
+
+    snprintf(key, sizeof(key), UD_SUBTREE "/%08x", code);
+    return settings_save_one(key, text, strlen(text));
+}
+
+int mejiro_user_dict_remove(uint32_t code) {
+    char key[sizeof(UD_SUBTREE) + 10];
+
+    k_mutex_lock(&ud_lock, K_FOREVER);
+    int i = find(code);
+    if (i < 0) {
+        k_mutex_unlock(&ud_lock);
+        return -ENOENT;
+    }
+    ud.entries[i] = ud.entries[--ud.count];
+    ud.stats.entries = ud.count;
+    bloom_rebuild();
+    k_mutex_unlock(&ud_lock);
+
+    snprintf(key, sizeof(key), UD_SUBTREE "/%08x", code);
+    return settings_delete(key);
+}
+
+void mejiro_user_dict_foreach(mejiro_user_dict_visit_cb cb, void *user_data) {
+    if (!cb) {
+        return;
+    }
+    k_mutex_lock(&ud_lock, K_FOREVER);
+    for (uint16_t i = 0; i < ud.count; i++) {
+        if (!cb(ud.entries[i].code, ud.entries[i].text, user_data)) {
+            break;
+        }
+    }
+    k_mutex_unlock(&ud_lock);
+}
+
+void mejiro_user_dict_get_stats(struct mejiro_user_dict_stats *out) {
+    if (out) {
+        k_mutex_lock(&ud_lock, K_FOREVER);
+        *out = ud.stats;
+        k_mutex_unlock(&ud_lock);
+    }
+}
+
+/* ---- settings: mejiro/ud/<code hex> = かな ------------------------------ */
+
+static int ud_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg) {
+    char text[UD_TEXT_LEN];
+    char *end;
+
+    uint32_t code = strtoul(name, &end, 16);
+    if (end == name || (*end != '\0' && *end != '/')) {
+        return -ENOENT;
+    }
+    if (len == 0 || len >= sizeof(text)) {
+        LOG_WRN("MEJIRO user dict: skip %s (len %u)", name, (unsigned)len);
+        return 0;
+    }
+
+    ssize_t rc = read_cb(cb_arg, text, len);
+    if (rc < 0) {
+        return (int)rc;
+    }
+
+    k_mutex_lock(&ud_lock, K_FOREVER);
+    int err = put(code, text, (size_t)rc);
+    k_mutex_unlock(&ud_lock);
+    if (err) {
+        LOG_WRN("MEJIRO user dict: drop %08x (%d)", code, err);
+    }
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(mejiro_user_dict, UD_SUBTREE, NULL, ud_settings_set, NULL, NULL);
+
+/* ---- shell: chord dict add|rm|list --------------------------------------- */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static bool parse_code(const struct shell *sh, const char *stroke, uint32_t *code) {
+    struct mejiro_state st;
+    if (!mejiro_parse_stroke_string(stroke, &st)) {
+        shell_error(sh, "bad stroke '%s' (keys: s t k N n y i a U, '-' between hands, # *)",
+                    stroke);
+        return false;
+    }
+    *code = mejiro_stroke_code(&st);
+    return true;
+}
+
+static int cmd_add(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    uint32_t code;
+
+    if (!parse_code(sh, argv[1], &code)) {
+        return -EINVAL;
+    }
+    int err = mejiro_user_dict_add(code, argv[2]);
+    if (err) {
+        shell_error(sh, "add failed (%d)", err);
+    }
+    return err;
+}
+
+static int cmd_rm(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    uint32_t code;
+
+    if (!parse_code(sh, argv[1], &code)) {
+        return -EINVAL;
+    }
+    int err = mejiro_user_dict_remove(code);
+    if (err) {
+        shell_error(sh, "remove failed (%d)", err);
+    }
+    return err;
+}
+
+static bool print_entry(uint32_t code, const char *text, void *user_data) {
+    const struct shell *sh = user_data;
+    struct mejiro_state st;
+    char stroke[64];
+
+    mejiro_state_reset(&st);
+    mejiro_state_from_code(&st, code);
+    if (!mejiro_build_stroke_string(&st, stroke, sizeof(stroke))) {
+        snprintf(stroke, sizeof(stroke), "%08x", code);
+    }
+    shell_print(sh, "%-12s %s", stroke, text);
+    return true;
+}
+
+static int cmd_list(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    struct mejiro_user_dict_stats st;
+    mejiro_user_dict_foreach(print_entry, (void *)sh);
+    mejiro_user_dict_get_stats(&st);
+    shell_print(sh, "%u/%u entries, rejected %u, hits %u, false positives %u", st.entries,
+                UD_MAX, st.rejected, st.hits, st.false_positives);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(dict_cmds,
+                               SHELL_CMD_ARG(add, NULL, "add <stroke> <kana>", cmd_add, 3, 0),
+                               SHELL_CMD_ARG(rm, NULL, "rm <stroke>", cmd_rm, 2, 0),
+                               SHELL_CMD_ARG(list, NULL, "list entries and stats", cmd_list, 1, 0),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chord), dict, &dict_cmds, "Mejiro user dictionary", NULL, 1, 0);
+
+#endif
@@ -0,0 +1,533 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+#include <zephyr/settings/settings.h>
+#endif
+
+#include <chord/chord_companion.h>
+#include <chord/chord_persist.h>
+#include <chord/chord_power.h>
+#include <chord/kana_out.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#ifdef CONFIG_ZMK_CHORD_COMPANION_FRAME_MAX
+#define FRAME_MAX CONFIG_ZMK_CHORD_COMPANION_FRAME_MAX
+#else
+#define FRAME_MAX 192
+#endif
+#ifdef CONFIG_ZMK_CHORD_COMPANION_LEASE_MS
+#define LEASE_MS CONFIG_ZMK_CHORD_COMPANION_LEASE_MS
+#else
+#define LEASE_MS 2000
+#endif
+#ifdef CONFIG_ZMK_CHORD_COMPANION_ACK_TIMEOUT_MS
+#define ACK_TIMEOUT_MS CONFIG_ZMK_CHORD_COMPANION_ACK_TIMEOUT_MS
+#else
+#define ACK_TIMEOUT_MS 200
+#endif
+
+/* TEXT の payload は seq の後ろに utf8 */
+#define TEXT_MAX (FRAME_MAX - 1)
+
+/*
+ * 受信はトランスポートのスレッド、送信は system work queue から来るので状態は lock の下。
+ * inflight: 返事待ちのフレームの文字（入力していないと確かめてから keycode で送り直す）
+ * batch:    返事待ちの間に確定した文字（次のフレーム）
+ * 送る側は返事を待たない。その間の keycode は kana_out が queue に並べておき、
+ * 返事（か give_up）で空になったら kana_out_resume() で流させる。
+ */
+static K_MUTEX_DEFINE(lock);
+static K_SEM_DEFINE(ack_sem, 0, 1);
+
+static struct {
+    const struct chord_companion_transport *transport;
+    int64_t lease_until; /* HELLO / 返事で延びる */
+    uint8_t seq;
+    bool inflight;
+    bool cancelling; /* 返事が無いので CANCEL を送り、その返事を待っている */
+    uint16_t inflight_len;
+    uint16_t batch_len;
+    char inflight_text[TEXT_MAX];
+    char batch[TEXT_MAX];
+    uint8_t mode; /* enum chord_companion_mode */
+    struct chord_companion_stats stats;
+} comp;
+
+/* 受信中のフレーム */
+static struct {
+    enum { S_SYNC0, S_SYNC1, S_TYPE, S_LEN0, S_LEN1, S_PAYLOAD, S_CRC0, S_CRC1 } st;
+    uint8_t type;
+    uint16_t len;
+    uint16_t pos;
+    uint16_t crc;
+    uint8_t buf[8]; /* host -> kbd は短いものだけ */
+} rx;
+
+static void ack_work_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(ack_work, ack_work_handler);
+
+/* ---- frames -------------------------------------------------------------- */
+
+static void write_frame(uint8_t type, const uint8_t *head, uint16_t head_len, const char *text,
+                        uint16_t text_len) {
+    const uint16_t len = head_len + text_len;
+    uint8_t frame[5 + 3 + FRAME_MAX + 2];
+    uint16_t n = 0;
+
+    if (!comp.transport || len > FRAME_MAX) {
+        return;
+    }
+    frame[n++] = CHORD_COMP_SYNC0;
+    frame[n++] = CHORD_COMP_SYNC1;
+    frame[n++] = type;
+    frame[n++] = (uint8_t)len;
+    frame[n++] = (uint8_t)(len >> 8);
+    memcpy(&frame[n], head, head_len);
+    n += head_len;
+    memcpy(&frame[n], text, text_len);
+    n += text_len;
+
+    const uint16_t crc = crc16_itu_t(0, &frame[2], n - 2);
+    frame[n++] = (uint8_t)crc;
+    frame[n++] = (uint8_t)(crc >> 8);
+
+    int err = comp.transport->write(frame, n, comp.transport->ctx);
+    if (err) {
+        LOG_DBG("companion: write failed (%d)", err);
+    }
+}
+
+/* batch を次の TEXT にする。lock 済み、inflight 無しで呼ぶ */
+static void send_batch(void) {
+    if (!comp.batch_len) {
+        return;
+    }
+    memcpy(comp.inflight_text, comp.batch, comp.batch_len);
+    comp.inflight_len = comp.batch_len;
+    comp.batch_len = 0;
+    comp.inflight = true;
+    comp.seq++;
+    comp.stats.frames++;
+    comp.stats.bytes += comp.inflight_len;
+
+    const uint8_t seq = comp.seq;
+    write_frame(CHORD_COMP_TEXT, &seq, 1, comp.inflight_text, comp.inflight_len);
+
+    /* loopback は write の中で返事が来る */
+    if (comp.inflight) {
+        (void)k_work_reschedule(&ack_work, K_MSEC(ACK_TIMEOUT_MS));
+    }
+}
+
+/* 返事待ちのフレームが入力された。lock 済みで呼ぶ。次のフレームを送ったら false */
+static bool acked(int64_t now) {
+    (void)k_work_cancel_delayable(&ack_work);
+    comp.inflight = false;
+    comp.cancelling = false;
+    comp.lease_until = now + LEASE_MS;
+    comp.stats.acks++;
+    k_sem_give(&ack_sem);
+    send_batch();
+    return !comp.inflight;
+}
+
+/*
+ * keycode に戻し、batch（まだ送っていない）の文字を keycode で送る。retype なら
+ * 返事待ちの文字も（companion が入力していないと答えた時だけ。入力されたか分からない
+ * 文字を送り直すと、遅れて入力された時に二重になる）。
+ * lock は外して呼ぶ（kana_out から戻ってくるので）。
+ */
+static void give_up(bool retype) {
+    char text[2 * TEXT_MAX + 1];
+    size_t len = 0;
+
+    k_mutex_lock(&lock, K_FOREVER);
+    if (comp.inflight && retype) {
+        memcpy(text, comp.inflight_text, comp.inflight_len);
+        len = comp.inflight_len;
+    }
+    memcpy(&text[len], comp.batch, comp.batch_len);
+    len += comp.batch_len;
+    comp.inflight = false;
+    comp.cancelling = false;
+    comp.inflight_len = comp.batch_len = 0;
+    comp.lease_until = 0;
+    comp.stats.fallbacks++;
+    k_sem_give(&ack_sem);
+    k_mutex_unlock(&lock);
+
+    LOG_WRN("companion: no answer, back to keycodes");
+    text[len] = '\0';
+    if (len) {
+        (void)kana_out_send_keys(text, k_uptime_get());
+    }
+    kana_out_resume();
+}
+
+/*
+ * ack_timeout_ms 返事が無い。1 回目は CANCEL で companion に確かめる（答えは
+ * handle_frame）。それにも返事が無ければ companion はいないものとし、返事待ちの
+ * 文字は捨てて log に残す。
+ */
+static void no_answer(void) {
+    k_mutex_lock(&lock, K_FOREVER);
+    if (!comp.inflight) {
+        k_mutex_unlock(&lock);
+        return;
+    }
+    if (!comp.cancelling) {
+        const uint8_t seq = comp.seq;
+
+        comp.cancelling = true;
+        write_frame(CHORD_COMP_CANCEL, &seq, 1, NULL, 0);
+        /* loopback は write の中で答える */
+        if (comp.inflight && comp.cancelling) {
+            (void)k_work_reschedule(&ack_work, K_MSEC(ACK_TIMEOUT_MS));
+        }
+        k_mutex_unlock(&lock);
+        return;
+    }
+    comp.stats.dropped++;
+    LOG_WRN("companion: cancel of seq %u not answered, dropped %u bytes", comp.seq,
+            comp.inflight_len);
+    k_mutex_unlock(&lock);
+    give_up(false);
+}
+
+static void ack_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    chord_power_wake(CHORD_WAKE_OUTPUT);
+    no_answer();
+}
+
+static void handle_frame(uint8_t type, const uint8_t *payload, uint16_t len) {
+    const int64_t now = k_uptime_get();
+    bool idle = false;
+    bool fallback = false;
+
+    k_mutex_lock(&lock, K_FOREVER);
+    switch (type) {
+    case CHORD_COMP_HELLO: {
+        const uint8_t resp[3] = {CHORD_COMP_VERSION, (uint8_t)FRAME_MAX,
+                                 (uint8_t)(FRAME_MAX >> 8)};
+        comp.lease_until = now + LEASE_MS;
+        write_frame(CHORD_COMP_HELLO | CHORD_COMP_RESP, resp, sizeof(resp), NULL, 0);
+        break;
+    }
+    case CHORD_COMP_TEXT | CHORD_COMP_RESP:
+        /* CANCEL の後に届いた返事も同じ（入力された） */
+        if (len < 1 || !comp.inflight || payload[0] != comp.seq) {
+            break;
+        }
+        idle = acked(now);
+        break;
+    case CHORD_COMP_CANCEL | CHORD_COMP_RESP:
+        if (len < 2 || !comp.cancelling || payload[0] != comp.seq) {
+            break;
+        }
+        if (payload[1]) {
+            /* 入力済みで、返事だけが落ちた */
+            idle = acked(now);
+        } else {
+            (void)k_work_cancel_delayable(&ack_work);
+            fallback = true;
+        }
+        break;
+    case CHORD_COMP_BYE:
+        comp.lease_until = 0;
+        break;
+    default:
+        break;
+    }
+    k_mutex_unlock(&lock);
+
+    if (fallback) {
+        /* companion はこの seq を捨てた: keycode で送り直す */
+        give_up(true);
+    } else if (idle) {
+        /* 後ろに並んでいた keycode の番 */
+        kana_out_resume();
+    }
+}
+
+static void rx_byte(uint8_t b) {
+    switch (rx.st) {
+    case S_SYNC0:
+        rx.st = b == CHORD_COMP_SYNC0 ? S_SYNC1 : S_SYNC0;
+        break;
+    case S_SYNC1:
+        rx.st = b == CHORD_COMP_SYNC1 ? S_TYPE : (b == CHORD_COMP_SYNC0 ? S_SYNC1 : S_SYNC0);
+        break;
+    case S_TYPE:
+        rx.type = b;
+        rx.crc = crc16_itu_t(0, &b, 1);
+        rx.st = S_LEN0;
+        break;
+    case S_LEN0:
+        rx.len = b;
+        rx.crc = crc16_itu_t(rx.crc, &b, 1);
+        rx.st = S_LEN1;
+        break;
+    case S_LEN1:
+        rx.len |= (uint16_t)b << 8;
+        rx.crc = crc16_itu_t(rx.crc, &b, 1);
+        rx.pos = 0;
+        if (rx.len > sizeof(rx.buf)) {
+            rx.st = S_SYNC0;
+        } else {
+            rx.st = rx.len ? S_PAYLOAD : S_CRC0;
+        }
+        break;
+    case S_PAYLOAD:
+        rx.buf[rx.pos++] = b;
+        rx.crc = crc16_itu_t(rx.crc, &b, 1);
+        if (rx.pos == rx.len) {
+            rx.st = S_CRC0;
+        }
+        break;
+    case S_CRC0:
+        rx.crc ^= b;
+        rx.st = S_CRC1;
+        break;
+    case S_CRC1:
+        rx.crc ^= (uint16_t)b << 8;
+        rx.st = S_SYNC0;
+        if (rx.crc == 0) {
+            handle_frame(rx.type, rx.buf, rx.len);
+        }
+        break;
+    }
+}
+
+/* ---- public -------------------------------------------------------------- */
+
+void chord_companion_set_transport(const struct chord_companion_transport *transport) {
+    k_mutex_lock(&lock, K_FOREVER);
+    comp.transport = transport;
+    k_mutex_unlock(&lock);
+}
+
+void chord_companion_receive(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        rx_byte(data[i]);
+    }
+}
+
+static bool active_locked(void) {
+    switch (comp.mode) {
+    case CHORD_COMP_MODE_KEYCODE:
+        return false;
+    case CHORD_COMP_MODE_COMPANION:
+        return comp.transport != NULL;
+    default:
+        return comp.transport &&
+               (comp.inflight || comp.batch_len || k_uptime_get() < comp.lease_until);
+    }
+}
+
+bool chord_companion_active(void) {
+    k_mutex_lock(&lock, K_FOREVER);
+    const bool active = active_locked();
+    k_mutex_unlock(&lock);
+    return active;
+}
+
+bool chord_companion_busy(void) {
+    k_mutex_lock(&lock, K_FOREVER);
+    const bool busy = comp.inflight || comp.batch_len;
+    k_mutex_unlock(&lock);
+    return busy;
+}
+
+/*
+ * 返事待ちの間に 1 フレーム分たまったら false（待たない）。呼んだ側は keycode に
+ * して、kana_out が companion の後ろに並べる。
+ */
+static bool queue_text(const char *utf8, size_t len) {
+    bool queued = false;
+
+    k_mutex_lock(&lock, K_FOREVER);
+    if (active_locked() && comp.batch_len + len <= TEXT_MAX) {
+        memcpy(&comp.batch[comp.batch_len], utf8, len);
+        comp.batch_len += len;
+        if (!comp.inflight) {
+            send_batch();
+        }
+        queued = true;
+    }
+    k_mutex_unlock(&lock);
+    return queued;
+}
+
+bool chord_companion_send(const char *utf8, int64_t timestamp) {
+    ARG_UNUSED(timestamp);
+    if (!utf8) {
+        return false;
+    }
+    const size_t len = strlen(utf8);
+    return len <= TEXT_MAX && queue_text(utf8, len);
+}
+
+bool chord_companion_backspaces(size_t count, int64_t timestamp) {
+    ARG_UNUSED(timestamp);
+    char bs[TEXT_MAX];
+
+    /* 一部だけ送って残りを keycode にすると二重に消すので、全部入る時だけ */
+    if (!count || count > sizeof(bs)) {
+        return false;
+    }
+    memset(bs, '\b', count);
+    return queue_text(bs, count);
+}
+
+void chord_companion_flush(void) {
+    for (;;) {
+        k_mutex_lock(&lock, K_FOREVER);
+        const bool waiting = comp.inflight;
+        const uint8_t seq = comp.seq;
+        k_mutex_unlock(&lock);
+
+        if (!waiting) {
+            return;
+        }
+        if (k_sem_take(&ack_sem, K_MSEC(ACK_TIMEOUT_MS)) != 0) {
+            k_mutex_lock(&lock, K_FOREVER);
+            const bool stuck = comp.inflight && comp.seq == seq;
+            k_mutex_unlock(&lock);
+            if (stuck) {
+                /* work queue を待たずに CANCEL を送る（2 回目は捨てる） */
+                (void)k_work_cancel_delayable(&ack_work);
+                no_answer();
+            }
+        }
+    }
+}
+
+/* ---- mode: chord/companion ----------------------------------------------- */
+
+#define MODE_KEY "chord/companion"
+
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+static uint8_t stored_mode;
+static struct chord_persist_item mode_item = CHORD_PERSIST_ITEM_INIT(MODE_KEY, stored_mode);
+#endif
+
+void chord_companion_set_mode(enum chord_companion_mode mode) {
+    if (mode > CHORD_COMP_MODE_COMPANION) {
+        return;
+    }
+    k_mutex_lock(&lock, K_FOREVER);
+    comp.mode = mode;
+    k_mutex_unlock(&lock);
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+    const uint8_t value = mode;
+    chord_persist_set(&mode_item, &value);
+#endif
+}
+
+enum chord_companion_mode chord_companion_get_mode(void) {
+    k_mutex_lock(&lock, K_FOREVER);
+    const enum chord_companion_mode mode = comp.mode;
+    k_mutex_unlock(&lock);
+    return mode;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+
+static int mode_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+                             void *cb_arg) {
+    uint8_t mode;
+
+    if (name[0] != '\0') {
+        return -ENOENT;
+    }
+    if (len != sizeof(mode)) {
+        return 0;
+    }
+
+    ssize_t rc = read_cb(cb_arg, &mode, sizeof(mode));
+    if (rc < 0) {
+        return (int)rc;
+    }
+    if (rc != sizeof(mode) || mode > CHORD_COMP_MODE_COMPANION) {
+        LOG_WRN("companion: ignore saved mode");
+        return 0;
+    }
+    k_mutex_lock(&lock, K_FOREVER);
+    comp.mode = mode;
+    k_mutex_unlock(&lock);
+    chord_persist_loaded(&mode_item, &mode);
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(chord_companion, MODE_KEY, NULL, mode_settings_set, NULL, NULL);
+
+#endif
+
+void chord_companion_get_stats(struct chord_companion_stats *out) {
+    if (!out) {
+        return;
+    }
+    k_mutex_lock(&lock, K_FOREVER);
+    *out = comp.stats;
+    k_mutex_unlock(&lock);
+}
+
+/* ---- shell: chord companion ---------------------------------------------- */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static const char *const mode_names[] = {
+    [CHORD_COMP_MODE_AUTO] = "auto",
+    [CHORD_COMP_MODE_KEYCODE] = "keycode",
+    [CHORD_COMP_MODE_COMPANION] = "companion",
+};
+
+static int cmd_companion(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+    struct chord_companion_stats st;
+
+    chord_companion_get_stats(&st);
+    shell_print(sh, "companion %s, mode %s",
+                chord_companion_active() ? "active" : "absent (keycodes)",
+                mode_names[chord_companion_get_mode()]);
+    shell_print(sh, "frames %u (%u bytes, %u acked, %u dropped), fallbacks %u", st.frames, st.bytes,
+                st.acks, st.dropped, st.fallbacks);
+    return 0;
+}
+
+static int cmd_mode(const struct shell *sh, size_t argc, char **argv) {
+    for (uint8_t m = 0; m < ARRAY_SIZE(mode_names); m++) {
+        if (strcmp(argv[1], mode_names[m]) == 0) {
+            chord_companion_set_mode(m);
+            return cmd_companion(sh, argc, argv);
+        }
+    }
+    shell_error(sh, "mode is auto, keycode or companion");
+    return -EINVAL;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(companion_cmds,
+                               SHELL_CMD_ARG(mode, NULL, "mode auto|keycode|companion", cmd_mode,
+                                             2, 0),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chord), companion, &companion_cmds, "Host companion text output",
+                 cmd_companion, 1, 0);
+
+#endif
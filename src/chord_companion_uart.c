@@ -0,0 +1,84 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * chord_companion over UART / USB CDC-ACM (chosen zmk,chord-companion-uart).
+ */
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/sys/util.h>
+
+#include <chord/chord_companion.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define UART_NODE DT_CHOSEN(zmk_chord_companion_uart)
+BUILD_ASSERT(DT_NODE_EXISTS(UART_NODE), "set chosen zmk,chord-companion-uart for the companion");
+
+static const struct device *const uart = DEVICE_DT_GET(UART_NODE);
+
+RING_BUF_DECLARE(rx_rb, CONFIG_ZMK_CHORD_COMPANION_RX_BUF);
+static K_SEM_DEFINE(rx_sem, 0, 1);
+
+/* companion がいない（ポートが開かれていない）間は CDC-ACM が捨てる */
+static int uart_write(const uint8_t *data, size_t len, void *ctx) {
+    ARG_UNUSED(ctx);
+    for (size_t i = 0; i < len; i++) {
+        uart_poll_out(uart, data[i]);
+    }
+    return 0;
+}
+
+static const struct chord_companion_transport transport = {
+    .write = uart_write,
+};
+
+static void uart_isr(const struct device *dev, void *user_data) {
+    ARG_UNUSED(user_data);
+
+    while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+        if (!uart_irq_rx_ready(dev)) {
+            continue;
+        }
+        uint8_t buf[16];
+        int n = uart_fifo_read(dev, buf, sizeof(buf));
+        if (n > 0) {
+            /* 溢れた分は捨てる（CRC で弾かれ、companion の次の HELLO で戻る） */
+            (void)ring_buf_put(&rx_rb, buf, (uint32_t)n);
+            k_sem_give(&rx_sem);
+        }
+    }
+}
+
+static void companion_rx_thread(void *p1, void *p2, void *p3) {
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    if (!device_is_ready(uart)) {
+        LOG_ERR("companion: UART not ready");
+        return;
+    }
+    chord_companion_set_transport(&transport);
+    uart_irq_callback_user_data_set(uart, uart_isr, NULL);
+    uart_irq_rx_enable(uart);
+
+    for (;;) {
+        uint8_t buf[16];
+        uint32_t n;
+
+        k_sem_take(&rx_sem, K_FOREVER);
+        while ((n = ring_buf_get(&rx_rb, buf, sizeof(buf))) > 0) {
+            chord_companion_receive(buf, n);
+        }
+    }
+}
+
+/*
+ * kana_out_flush() は system work queue で返事を待つので、受信はその外のスレッドで。
+ * 返事を受けて次のフレームを送るのもここ。
+ */
+K_THREAD_DEFINE(chord_companion_rx, CONFIG_ZMK_CHORD_COMPANION_STACK_SIZE, companion_rx_thread,
+                NULL, NULL, NULL, CONFIG_ZMK_CHORD_COMPANION_THREAD_PRIORITY, 0, 0);
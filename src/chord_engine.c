@@ -0,0 +1,200 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+
+#include <chord/chord_engine.h>
+#include <chord/chord_power.h>
+#include <chord/kana_out.h>
+#include <chord/chord_seg.h>
+#include <chord/chord_tune.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define MAX_ENGINES 2 /* Mejiro + Naginata */
+
+#if IS_ENABLED(CONFIG_SHELL)
+static struct chord_engine *engines[MAX_ENGINES];
+static uint8_t engine_count;
+#endif
+
+static void add_ms(uint32_t *sum, uint32_t *max, int64_t ms) {
+    const uint32_t v = ms > 0 ? (uint32_t)MIN(ms, (int64_t)UINT32_MAX) : 0;
+
+    *sum += v;
+    *max = MAX(*max, v);
+}
+
+/* chord_seg の確定 -> 方式の resolver */
+static void on_commit(const struct chord_stroke *stroke, void *user_data) {
+    struct chord_engine *engine = user_data;
+
+    if (engine->started) {
+        engine->started--;
+    }
+    engine->stats.strokes++;
+    engine->ops->commit(engine, stroke);
+    /* 読んでから commit が返るまで。queue に積んで後から出る分は kana_out の統計 */
+    add_ms(&engine->stats.commit_ms_sum, &engine->stats.commit_ms_max,
+           k_uptime_get() - stroke->first_press);
+}
+
+/* 呼ばれた時刻とキーを読んだ時刻の差 */
+static void note_event(struct chord_engine *engine, int64_t timestamp) {
+    chord_power_wake(CHORD_WAKE_KEY);
+    engine->timestamp = timestamp;
+    add_ms(&engine->stats.queue_ms_sum, &engine->stats.queue_ms_max,
+           k_uptime_get() - timestamp);
+}
+
+/* press / release の後: 新しく増えたストローク（離上時の切り出しを含む）の始まりを渡す */
+static void announce_starts(struct chord_engine *engine) {
+    if (!engine->ops->stroke_start) {
+        return;
+    }
+    while (engine->started < engine->seg.count) {
+        engine->ops->stroke_start(engine, chord_seg_pending(&engine->seg, engine->started++));
+    }
+}
+
+static void timer_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct chord_engine *engine = CONTAINER_OF(dwork, struct chord_engine, timer);
+
+    chord_power_wake(CHORD_WAKE_KEY);
+    if (engine->ops->expire) {
+        engine->ops->expire(engine, k_uptime_get());
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_CHORD_TUNE)
+
+/* chord tune は &tune.params を渡してくる */
+static void apply_tune(const struct chord_tune_params *params) {
+    struct chord_tune_engine *tune = CONTAINER_OF(params, struct chord_tune_engine, params);
+    struct chord_engine *engine = CONTAINER_OF(tune, struct chord_engine, tune);
+
+    chord_seg_set_window(&engine->seg, params->window_ms);
+    chord_seg_set_mode(&engine->seg, params->commit_mode);
+    if (engine->ops->set_gap) {
+        engine->ops->set_gap(params->gap_ms);
+    }
+    if (engine->ops->tuned) {
+        engine->ops->tuned(engine, params);
+    }
+}
+
+#endif
+
+void chord_engine_init(struct chord_engine *engine, const struct chord_engine_ops *ops,
+                       const struct chord_engine_config *cfg) {
+    engine->ops = ops;
+    engine->started = 0;
+    engine->timestamp = 0;
+    engine->stats = (struct chord_engine_stats){0};
+    k_work_init_delayable(&engine->timer, timer_handler);
+    chord_seg_init(&engine->seg, cfg->window_ms, on_commit, engine);
+    chord_seg_set_mode(&engine->seg, cfg->commit_mode);
+
+#if IS_ENABLED(CONFIG_ZMK_CHORD_TUNE)
+    engine->tune = (struct chord_tune_engine){
+        .name = ops->name,
+        .defaults =
+            {
+                .window_ms = cfg->window_ms,
+                .gap_ms = cfg->gap_ms,
+                .commit_mode = cfg->commit_mode,
+            },
+        .apply = apply_tune,
+    };
+    engine->tune.params = engine->tune.defaults;
+    (void)chord_tune_register(&engine->tune);
+#endif
+
+#if IS_ENABLED(CONFIG_SHELL)
+    if (engine_count < MAX_ENGINES) {
+        engines[engine_count++] = engine;
+    }
+#endif
+}
+
+void chord_engine_press(struct chord_engine *engine, uint32_t key, int64_t timestamp) {
+    note_event(engine, timestamp);
+    engine->stats.presses++;
+
+    if (engine->ops->intercept_press &&
+        engine->ops->intercept_press(engine, key, timestamp)) {
+        engine->stats.intercepted++;
+        return;
+    }
+
+    /* 確定は離上（commit）。ここではストロークへの割り当てだけ */
+    const struct chord_stroke *stroke = chord_seg_press(&engine->seg, key, timestamp);
+    announce_starts(engine);
+    if (engine->ops->pressed) {
+        engine->ops->pressed(engine, stroke, timestamp);
+    }
+}
+
+void chord_engine_release(struct chord_engine *engine, uint32_t key, int64_t timestamp) {
+    note_event(engine, timestamp);
+    engine->stats.releases++;
+
+    if (engine->ops->intercept_release &&
+        engine->ops->intercept_release(engine, key, timestamp)) {
+        return;
+    }
+    chord_seg_release(&engine->seg, key, timestamp);
+    announce_starts(engine);
+}
+
+void chord_engine_flush(struct chord_engine *engine) { chord_seg_flush(&engine->seg); }
+
+void chord_engine_arm(struct chord_engine *engine, int64_t deadline) {
+    if (deadline < 0) {
+        (void)k_work_cancel_delayable(&engine->timer);
+        return;
+    }
+    (void)k_work_reschedule(&engine->timer, K_MSEC(MAX(deadline - k_uptime_get(), 0)));
+}
+
+/* ---- shell: chord engine ------------------------------------------------- */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static int cmd_engine(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    for (uint8_t i = 0; i < engine_count; i++) {
+        const struct chord_engine *e = engines[i];
+
+        shell_print(sh, "%-9s presses %u (%u intercepted), strokes %u, pending %u", e->ops->name,
+                    e->stats.presses, e->stats.intercepted, e->stats.strokes,
+                    chord_engine_pending(e));
+        shell_print(sh, "%-9s rollover splits %u, forced commits %u", "", e->seg.stats.splits,
+                    e->seg.stats.forced);
+        const uint32_t events = MAX(e->stats.presses + e->stats.releases, 1U);
+        shell_print(sh, "%-9s event queue avg %u ms max %u ms, scan to commit avg %u ms max %u ms",
+                    "", e->stats.queue_ms_sum / events, e->stats.queue_ms_max,
+                    e->stats.commit_ms_sum / MAX(e->stats.strokes, 1U), e->stats.commit_ms_max);
+    }
+
+    struct kana_out_stats out;
+
+    kana_out_get_stats(&out);
+    shell_print(sh, "%-9s %u taps, scan to HID avg %u ms max %u ms", "output", out.taps,
+                out.hid_ms_sum / MAX(out.taps, 1U), out.hid_ms_max);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((chord), engine, NULL, "Key and stroke counters of each chord engine",
+                 cmd_engine, 1, 0);
+
+#endif
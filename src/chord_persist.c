@@ -0,0 +1,254 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#include <chord/chord_persist.h>
+#include <chord/chord_power.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define MAX_ITEMS CONFIG_ZMK_CHORD_PERSIST_MAX_ITEMS
+#define ITEM_MAX_LEN 64 /* 書く前に値をここへ写す */
+
+static struct {
+    struct chord_persist_item *pending[MAX_ITEMS];
+    uint8_t pending_count;
+    int64_t first_mark; /* 今の書き込み待ちの最初の set（0 = 無し） */
+    bool started;       /* work queue が動いているか（SYS_INIT 前の set は溜めておく） */
+    struct chord_persist_stats stats;
+} ps;
+
+/* set は入力の経路からも来るので spinlock。flush 同士は mutex */
+static struct k_spinlock ps_lock;
+static K_MUTEX_DEFINE(flush_lock);
+
+static K_THREAD_STACK_DEFINE(persist_stack, CONFIG_ZMK_CHORD_PERSIST_STACK_SIZE);
+static struct k_work_q persist_q;
+
+static void persist_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    chord_power_wake(CHORD_WAKE_STORE);
+    (void)chord_persist_flush();
+}
+
+static K_WORK_DELAYABLE_DEFINE(persist_work, persist_work_handler);
+
+void chord_persist_set(struct chord_persist_item *item, const void *value) {
+    k_spinlock_key_t key = k_spin_lock(&ps_lock);
+    int64_t now = k_uptime_get();
+    int64_t delay = CONFIG_ZMK_CHORD_PERSIST_DELAY_MS;
+
+    ps.stats.marks++;
+    memcpy(item->data, value, item->len);
+    if (!item->dirty) {
+        if (ps.pending_count == MAX_ITEMS || item->len > ITEM_MAX_LEN) {
+            /* MAX_ITEMS（Kconfig）が足りないか、値が大きすぎる */
+            ps.stats.errors++;
+            k_spin_unlock(&ps_lock, key);
+            LOG_WRN("chord persist: no slot for %s", item->key);
+            return;
+        }
+        item->dirty = true;
+        ps.pending[ps.pending_count++] = item;
+    }
+    if (ps.first_mark == 0) {
+        ps.first_mark = now;
+    } else {
+        /* 変更が止まらなくても、最初の set から MAX_DELAY_MS を過ぎては延ばさない */
+        delay = MIN(delay, MAX(ps.first_mark + CONFIG_ZMK_CHORD_PERSIST_MAX_DELAY_MS - now, 0));
+    }
+    const bool started = ps.started;
+    k_spin_unlock(&ps_lock, key);
+
+    if (started) {
+        /* reschedule は近くなる方にも動かす（schedule は予約済みなら何もしない） */
+        k_work_reschedule_for_queue(&persist_q, &persist_work, K_MSEC(delay));
+    }
+}
+
+void chord_persist_loaded(struct chord_persist_item *item, const void *value) {
+    k_spinlock_key_t key = k_spin_lock(&ps_lock);
+    memcpy(item->data, value, item->len);
+    item->crc = crc32_ieee(item->data, item->len);
+    item->stored = true;
+    k_spin_unlock(&ps_lock, key);
+}
+
+static void count(uint32_t *counter) {
+    k_spinlock_key_t key = k_spin_lock(&ps_lock);
+    (*counter)++;
+    k_spin_unlock(&ps_lock, key);
+}
+
+/* pending から 1 つ取り出し、値を buf に写す。無ければ NULL */
+static struct chord_persist_item *take(uint8_t *buf) {
+    k_spinlock_key_t key = k_spin_lock(&ps_lock);
+    struct chord_persist_item *item = NULL;
+
+    if (ps.pending_count) {
+        item = ps.pending[--ps.pending_count];
+        item->dirty = false;
+        memcpy(buf, item->data, item->len);
+    }
+    if (ps.pending_count == 0) {
+        ps.first_mark = 0;
+    }
+    k_spin_unlock(&ps_lock, key);
+    return item;
+}
+
+/*
+ * 書けなかったものを pending に戻し、DELAY_MS 後にもう一度書く。書いている間に set
+ * された（もう pending にある）ものはそのまま
+ */
+static void retry(struct chord_persist_item **failed, uint8_t n) {
+    k_spinlock_key_t key = k_spin_lock(&ps_lock);
+
+    for (uint8_t i = 0; i < n; i++) {
+        if (!failed[i]->dirty && ps.pending_count < MAX_ITEMS) {
+            failed[i]->dirty = true;
+            ps.pending[ps.pending_count++] = failed[i];
+        }
+    }
+    if (ps.first_mark == 0) {
+        ps.first_mark = k_uptime_get();
+    }
+    const bool started = ps.started;
+    k_spin_unlock(&ps_lock, key);
+
+    if (started) {
+        k_work_reschedule_for_queue(&persist_q, &persist_work,
+                                    K_MSEC(CONFIG_ZMK_CHORD_PERSIST_DELAY_MS));
+    }
+}
+
+int chord_persist_flush(void) {
+    uint8_t buf[ITEM_MAX_LEN];
+    struct chord_persist_item *item;
+    struct chord_persist_item *failed[MAX_ITEMS];
+    uint8_t failed_count = 0;
+    int ret = 0;
+
+    k_mutex_lock(&flush_lock, K_FOREVER);
+    while ((item = take(buf)) != NULL) {
+        uint32_t crc = crc32_ieee(buf, item->len);
+
+        if (item->stored && item->crc == crc) {
+            count(&ps.stats.skipped);
+            continue;
+        }
+        int err = settings_save_one(item->key, buf, item->len);
+        if (err) {
+            LOG_WRN("chord persist: save %s failed (%d), will retry", item->key, err);
+            count(&ps.stats.errors);
+            ret = ret ? ret : err;
+            /* ここで戻すと take() がすぐまた取るので、最後にまとめて戻す */
+            if (failed_count < MAX_ITEMS) {
+                failed[failed_count++] = item;
+            }
+            continue;
+        }
+        item->crc = crc;
+        item->stored = true;
+        count(&ps.stats.writes);
+    }
+    if (failed_count) {
+        retry(failed, failed_count);
+    }
+    k_mutex_unlock(&flush_lock);
+    return ret;
+}
+
+int chord_persist_forget(struct chord_persist_item *item) {
+    k_mutex_lock(&flush_lock, K_FOREVER);
+
+    k_spinlock_key_t key = k_spin_lock(&ps_lock);
+    for (uint8_t i = 0; i < ps.pending_count; i++) {
+        if (ps.pending[i] == item) {
+            ps.pending[i] = ps.pending[--ps.pending_count];
+            break;
+        }
+    }
+    item->dirty = false;
+    item->stored = false;
+    k_spin_unlock(&ps_lock, key);
+
+    int err = settings_delete(item->key);
+    k_mutex_unlock(&flush_lock);
+    return err;
+}
+
+void chord_persist_get_stats(struct chord_persist_stats *out) {
+    if (out) {
+        k_spinlock_key_t key = k_spin_lock(&ps_lock);
+        *out = ps.stats;
+        out->pending = ps.pending_count;
+        k_spin_unlock(&ps_lock, key);
+    }
+}
+
+static int chord_persist_init(void) {
+    k_work_queue_start(&persist_q, persist_stack, K_THREAD_STACK_SIZEOF(persist_stack),
+                       CONFIG_ZMK_CHORD_PERSIST_THREAD_PRIORITY, NULL);
+    k_thread_name_set(&persist_q.thread, "chord_persist");
+
+    k_spinlock_key_t key = k_spin_lock(&ps_lock);
+    ps.started = true;
+    const bool pending = ps.pending_count > 0;
+    k_spin_unlock(&ps_lock, key);
+
+    if (pending) {
+        k_work_reschedule_for_queue(&persist_q, &persist_work,
+                                    K_MSEC(CONFIG_ZMK_CHORD_PERSIST_DELAY_MS));
+    }
+    return 0;
+}
+
+SYS_INIT(chord_persist_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+/* ---- shell: chord persist [flush] ---------------------------------------- */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static int cmd_persist(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    struct chord_persist_stats st;
+    chord_persist_get_stats(&st);
+
+    shell_print(sh, "writes %u, skipped %u (unchanged), marks %u, errors %u, pending %u",
+                st.writes, st.skipped, st.marks, st.errors, st.pending);
+    shell_print(sh, "delay %u ms after the last change, at most %u ms",
+                CONFIG_ZMK_CHORD_PERSIST_DELAY_MS, CONFIG_ZMK_CHORD_PERSIST_MAX_DELAY_MS);
+    return 0;
+}
+
+static int cmd_flush(const struct shell *sh, size_t argc, char **argv) {
+    int err = chord_persist_flush();
+    if (err) {
+        shell_error(sh, "flush failed (%d)", err);
+    }
+    return cmd_persist(sh, argc, argv);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(persist_cmds,
+                               SHELL_CMD_ARG(flush, NULL, "write pending changes now", cmd_flush,
+                                             1, 0),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chord), persist, &persist_cmds, "Settings write-back counters (flash wear)",
+                 cmd_persist, 1, 0);
+
+#endif
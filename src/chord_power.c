@@ -0,0 +1,133 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+#if IS_ENABLED(CONFIG_ZMK_CHORD_POWER_AUTO) && IS_ENABLED(CONFIG_ZMK_USB)
+#include <zmk/usb.h>
+#endif
+
+#include <chord/chord_power.h>
+
+#ifdef CONFIG_ZMK_CHORD_POWER_BATTERY_BURST
+#define BATTERY_BURST CONFIG_ZMK_CHORD_POWER_BATTERY_BURST
+#else
+#define BATTERY_BURST 4
+#endif
+
+bool chord_power_on_battery(void) {
+#if IS_ENABLED(CONFIG_ZMK_CHORD_POWER_BATTERY)
+    return true;
+#elif IS_ENABLED(CONFIG_ZMK_CHORD_POWER_AUTO) && IS_ENABLED(CONFIG_ZMK_USB)
+    return !zmk_usb_is_powered();
+#elif IS_ENABLED(CONFIG_ZMK_CHORD_POWER_AUTO)
+    /* USB が無い BLE だけのボードは常に電池 */
+    return IS_ENABLED(CONFIG_ZMK_BLE);
+#else
+    return false;
+#endif
+}
+
+struct chord_power_pacing chord_power_pacing(uint16_t gap_ms) {
+    if (gap_ms == 0 || !chord_power_on_battery()) {
+        return (struct chord_power_pacing){.burst = 1, .gap_ms = gap_ms};
+    }
+    /* 平均の速さは同じまま、起きる回数を 1/BATTERY_BURST に */
+    return (struct chord_power_pacing){
+        .burst = BATTERY_BURST,
+        .gap_ms = (uint16_t)MIN((uint32_t)gap_ms * BATTERY_BURST, UINT16_MAX),
+    };
+}
+
+/* ---- wakeup counters --------------------------------------------------- */
+
+#ifdef CONFIG_ZMK_CHORD_POWER_STATS
+
+/* 数え落としがあっても困らないのでロックしない */
+static struct chord_power_stats stats;
+
+void chord_power_wake(enum chord_wake src) {
+    if (src < CHORD_WAKE_COUNT) {
+        stats.wakeups[src]++;
+    }
+}
+
+void chord_power_chars(uint32_t count) { stats.chars += count; }
+
+void chord_power_get_stats(struct chord_power_stats *out) {
+    if (out) {
+        *out = stats;
+    }
+}
+
+void chord_power_reset_stats(void) { stats = (struct chord_power_stats){0}; }
+
+#endif
+
+/* ---- shell: chord power [reset] ---------------------------------------- */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static const char *profile_name(void) {
+    if (IS_ENABLED(CONFIG_ZMK_CHORD_POWER_BATTERY)) {
+        return "battery";
+    }
+    if (IS_ENABLED(CONFIG_ZMK_CHORD_POWER_AUTO)) {
+        return "auto";
+    }
+    return "latency";
+}
+
+static int cmd_power(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    shell_print(sh, "profile %s, now %s (output burst %u)", profile_name(),
+                chord_power_on_battery() ? "battery" : "latency",
+                chord_power_pacing(1).burst);
+#ifdef CONFIG_ZMK_CHORD_POWER_STATS
+    struct chord_power_stats st;
+    uint32_t total = 0;
+
+    chord_power_get_stats(&st);
+    for (int i = 0; i < CHORD_WAKE_COUNT; i++) {
+        total += st.wakeups[i];
+    }
+    shell_print(sh, "wakeups %u (key %u, output %u, store %u), chars %u", total,
+                st.wakeups[CHORD_WAKE_KEY], st.wakeups[CHORD_WAKE_OUTPUT],
+                st.wakeups[CHORD_WAKE_STORE], st.chars);
+    if (st.chars) {
+        /* 小数 2 桁 */
+        const uint32_t per100 = (uint32_t)((uint64_t)total * 100 / st.chars);
+        shell_print(sh, "wakeups per char %u.%02u", per100 / 100, per100 % 100);
+    }
+#endif
+    return 0;
+}
+
+#ifdef CONFIG_ZMK_CHORD_POWER_STATS
+static int cmd_reset(const struct shell *sh, size_t argc, char **argv) {
+    chord_power_reset_stats();
+    return cmd_power(sh, argc, argv);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(power_cmds,
+                               SHELL_CMD_ARG(reset, NULL, "clear the wakeup counters", cmd_reset,
+                                             1, 0),
+                               SHELL_SUBCMD_SET_END);
+#define POWER_CMDS (&power_cmds)
+#else
+#define POWER_CMDS NULL
+#endif
+
+SHELL_SUBCMD_ADD((chord), power, POWER_CMDS, "Power profile and wakeups per typed character",
+                 cmd_power, 1, 0);
+
+#endif
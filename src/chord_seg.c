@@ -0,0 +1,217 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+
+#include <zephyr/toolchain.h>
+#include <zephyr/sys/util.h>
+
+#include <chord/chord_seg.h>
+#include <chord/chord_timing.h>
+
+BUILD_ASSERT(CHORD_STROKE_MAX_KEYS <= 16, "held mask is 16 bits");
+BUILD_ASSERT(CHORD_SEG_MAX_PENDING >= 2, "rollover needs at least two pending strokes");
+
+/* ---- ring helpers ------------------------------------------------------ */
+
+static inline struct chord_stroke *stroke_at(struct chord_seg *seg, uint8_t i) {
+    return &seg->ring[(seg->head + i) % CHORD_SEG_MAX_PENDING];
+}
+
+static inline struct chord_stroke *newest(struct chord_seg *seg) {
+    return seg->count ? stroke_at(seg, seg->count - 1) : NULL;
+}
+
+static struct chord_stroke *push_stroke(struct chord_seg *seg) {
+    struct chord_stroke *s = stroke_at(seg, seg->count);
+    memset(s, 0, sizeof(*s));
+    seg->count++;
+    return s;
+}
+
+static void add_key(struct chord_stroke *s, uint32_t key, int64_t ts) {
+    if (s->count == 0) {
+        s->first_press = ts;
+    }
+    s->keys[s->count] = key;
+    s->pressed_at[s->count] = ts;
+    s->held |= (uint16_t)(1u << s->count);
+    s->count++;
+}
+
+/* 先頭ストロークを確定して取り除く */
+static void commit_oldest(struct chord_seg *seg) {
+    struct chord_stroke *s = stroke_at(seg, 0);
+
+    if (s->held) {
+        seg->stats.forced++;
+    }
+    seg->stats.strokes++;
+
+    /* callback 中に press が来ても ring を壊さないよう先に外す */
+    struct chord_stroke done = *s;
+    seg->head = (seg->head + 1) % CHORD_SEG_MAX_PENDING;
+    seg->count--;
+
+    if (seg->commit) {
+        seg->commit(&done, seg->user_data);
+    }
+}
+
+/*
+ * 最初の離上時: 離上直前に遅れて押されたキーは次のストロークの先頭とみなす。
+ * s は最新ストロークであること（古いストロークは既に released なので来ない）。
+ */
+static void split_late_keys(struct chord_seg *seg, struct chord_stroke *s, uint8_t released_idx,
+                            int64_t ts) {
+    uint16_t late = 0;
+
+    for (uint8_t i = 0; i < s->count; i++) {
+        if (i == released_idx || !(s->held & (1u << i))) {
+            continue;
+        }
+        if ((s->pressed_at[i] - s->first_press) >= seg->split_ms &&
+            (ts - s->pressed_at[i]) < seg->split_ms) {
+            late |= (uint16_t)(1u << i);
+        }
+    }
+    if (!late) {
+        return;
+    }
+
+    if (seg->count == CHORD_SEG_MAX_PENDING) {
+        /* 空きが無ければ分割しない（混ざる方が落とすよりまし） */
+        return;
+    }
+
+    struct chord_stroke *next = push_stroke(seg);
+    uint8_t keep = 0;
+    uint16_t held = 0;
+
+    for (uint8_t i = 0; i < s->count; i++) {
+        if (late & (1u << i)) {
+            add_key(next, s->keys[i], s->pressed_at[i]);
+            continue;
+        }
+        s->keys[keep] = s->keys[i];
+        s->pressed_at[keep] = s->pressed_at[i];
+        if (s->held & (1u << i)) {
+            held |= (uint16_t)(1u << keep);
+        }
+        keep++;
+    }
+    s->count = keep;
+    s->held = held;
+    seg->stats.splits++;
+}
+
+/* ---- public ------------------------------------------------------------ */
+
+void chord_seg_init(struct chord_seg *seg, uint16_t split_ms, chord_seg_commit_cb commit,
+                    void *user_data) {
+    if (!seg) return;
+    memset(seg, 0, sizeof(*seg));
+    seg->split_ms = split_ms;
+    seg->commit = commit;
+    seg->user_data = user_data;
+}
+
+void chord_seg_set_mode(struct chord_seg *seg, enum chord_commit_mode mode) {
+    if (!seg) return;
+    seg->mode = (uint8_t)mode;
+}
+
+void chord_seg_set_window(struct chord_seg *seg, uint16_t split_ms) {
+    if (!seg) return;
+    seg->split_ms = split_ms;
+}
+
+const struct chord_stroke *chord_seg_press(struct chord_seg *seg, uint32_t key, int64_t ts) {
+    if (!seg) return NULL;
+
+    struct chord_stroke *s = newest(seg);
+    /* all-released では押下中のキーが残っている間は同じストローク */
+    const bool closed = s && s->released && seg->mode == CHORD_COMMIT_ROLLOVER;
+
+    if (!s || closed || s->count >= CHORD_STROKE_MAX_KEYS) {
+        if (seg->count == CHORD_SEG_MAX_PENDING) {
+            commit_oldest(seg);
+        }
+        s = push_stroke(seg);
+#if IS_ENABLED(CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW)
+        chord_timing_stroke_start(ts);
+        seg->split_ms = chord_timing_window();
+#endif
+    }
+
+    add_key(s, key, ts);
+    return s;
+}
+
+void chord_seg_release(struct chord_seg *seg, uint32_t key, int64_t ts) {
+    if (!seg) return;
+
+    /* 押下中のキーを古い順に探す（強制確定済みのキーは見つからないので無視） */
+    int found = -1;
+    uint8_t idx = 0;
+
+    for (uint8_t n = 0; n < seg->count && found < 0; n++) {
+        struct chord_stroke *s = stroke_at(seg, n);
+        for (uint8_t i = 0; i < s->count; i++) {
+            if (s->keys[i] == key && (s->held & (1u << i))) {
+                found = n;
+                idx = i;
+                break;
+            }
+        }
+    }
+    if (found < 0) {
+        return;
+    }
+
+    struct chord_stroke *s = stroke_at(seg, (uint8_t)found);
+
+    if (!s->released) {
+        s->released = true;
+        s->first_release = ts;
+        if (s == newest(seg) && seg->mode == CHORD_COMMIT_ROLLOVER) {
+            split_late_keys(seg, s, idx, ts);
+        }
+        /* split で並びが変わるので引き直す */
+        for (uint8_t i = 0; i < s->count; i++) {
+            if (s->keys[i] == key && (s->held & (1u << i))) {
+                idx = i;
+                break;
+            }
+        }
+    }
+    s->held &= (uint16_t)~(1u << idx);
+    s->last_release = ts;
+#if IS_ENABLED(CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW)
+    chord_timing_key_hold((uint32_t)(ts - s->pressed_at[idx]));
+#endif
+
+    /* 全離上した最も新しいストロークまでを順に確定する */
+    int last_done = -1;
+    for (uint8_t n = 0; n < seg->count; n++) {
+        struct chord_stroke *p = stroke_at(seg, n);
+        if (p->released && p->held == 0) {
+            last_done = n;
+        }
+    }
+    for (int n = 0; n <= last_done; n++) {
+        commit_oldest(seg);
+    }
+}
+
+const struct chord_stroke *chord_seg_pending(const struct chord_seg *seg, uint8_t i) {
+    if (!seg || i >= seg->count) return NULL;
+    return &seg->ring[(seg->head + i) % CHORD_SEG_MAX_PENDING];
+}
+
+void chord_seg_flush(struct chord_seg *seg) {
+    if (!seg) return;
+    while (seg->count) {
+        commit_oldest(seg);
+    }
+}
@@ -0,0 +1,14 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * "chord" シェルコマンドのルート。サブコマンドは各モジュールが SHELL_SUBCMD_ADD で足す。
+ */
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+SHELL_SUBCMD_SET_CREATE(chord_cmds, (chord));
+SHELL_CMD_REGISTER(chord, &chord_cmds, "Chord engine status and tuning", NULL);
+
+#endif
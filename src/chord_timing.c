@@ -0,0 +1,115 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include <chord/chord_timing.h>
+
+/* EWMA は ms * 16 の固定小数、係数 1/8 */
+#define EWMA_SHIFT 3
+#define FIX 16
+
+/* これより長い間隔は「手を止めた」とみなして学習しない */
+#define PAUSE_MS 1000
+
+BUILD_ASSERT(CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW_MIN_MS <= CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW_MAX_MS,
+             "adaptive window: MIN_MS must not exceed MAX_MS");
+
+static struct {
+    uint32_t interval_x16;
+    uint32_t hold_x16;
+    uint32_t interval_samples;
+    uint32_t hold_samples;
+    int64_t last_start;
+    uint16_t window_ms;
+} tm = {
+    .window_ms = CONFIG_ZMK_CHORD_ROLLOVER_SPLIT_MS,
+};
+
+static inline void ewma(uint32_t *avg, uint32_t sample_ms, uint32_t n) {
+    uint32_t x = sample_ms * FIX;
+    if (n == 0) {
+        *avg = x;
+        return;
+    }
+    *avg = (uint32_t)((int32_t)*avg + (((int32_t)x - (int32_t)*avg) >> EWMA_SHIFT));
+}
+
+/*
+ * 窓 = min(ストローク間隔 / 3, 押下時間 / 2)
+ * - 間隔の 1/3 以下なら、次のストロークの先頭キーを前のストロークに取り込みにくい
+ * - 押下時間の半分以下なら、同時に押したつもりのキーのずれは十分吸収できる
+ */
+static void update_window(void) {
+    if (tm.interval_samples == 0 || tm.hold_samples == 0) {
+        return;
+    }
+    uint32_t by_interval = tm.interval_x16 / (FIX * 3);
+    uint32_t by_hold = tm.hold_x16 / (FIX * 2);
+    uint32_t w = MIN(by_interval, by_hold);
+
+    tm.window_ms = (uint16_t)CLAMP(w, CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW_MIN_MS,
+                                   CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW_MAX_MS);
+}
+
+void chord_timing_stroke_start(int64_t ts) {
+    if (tm.last_start != 0) {
+        int64_t d = ts - tm.last_start;
+        if (d > 0 && d < PAUSE_MS) {
+            ewma(&tm.interval_x16, (uint32_t)d, tm.interval_samples);
+            tm.interval_samples++;
+            update_window();
+        }
+    }
+    tm.last_start = ts;
+}
+
+void chord_timing_key_hold(uint32_t hold_ms) {
+    if (hold_ms == 0 || hold_ms >= PAUSE_MS) {
+        return;
+    }
+    ewma(&tm.hold_x16, hold_ms, tm.hold_samples);
+    tm.hold_samples++;
+    update_window();
+}
+
+uint16_t chord_timing_window(void) { return tm.window_ms; }
+
+void chord_timing_get_stats(struct chord_timing_stats *out) {
+    if (!out) {
+        return;
+    }
+    out->window_ms = tm.window_ms;
+    out->min_ms = CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW_MIN_MS;
+    out->max_ms = CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW_MAX_MS;
+    out->interval_ms = (uint16_t)(tm.interval_x16 / FIX);
+    out->hold_ms = (uint16_t)(tm.hold_x16 / FIX);
+    out->interval_samples = tm.interval_samples;
+    out->hold_samples = tm.hold_samples;
+}
+
+/* ---- shell: chord timing ------------------------------------------------ */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static int cmd_timing(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    struct chord_timing_stats st;
+    chord_timing_get_stats(&st);
+
+    shell_print(sh, "window   : %u ms (min %u, max %u)", st.window_ms, st.min_ms, st.max_ms);
+    shell_print(sh, "interval : %u ms avg (%u samples)", st.interval_ms, st.interval_samples);
+    shell_print(sh, "hold     : %u ms avg (%u samples)", st.hold_ms, st.hold_samples);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((chord), timing, NULL, "Show adaptive chord window and typing rhythm",
+                 cmd_timing, 1, 0);
+
+#endif
@@ -0,0 +1,297 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include <chord/chord_persist.h>
+#include <chord/chord_seg.h>
+#include <chord/chord_tune.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define TUNE_SUBTREE "chord/tune"
+#define MAX_ENGINES 2 /* Mejiro + Naginata */
+
+/* settings の値の大きさは ABI によらない（padding が入ると CRC も揺れる） */
+BUILD_ASSERT(sizeof(struct chord_tune_params) == 6, "chord_tune_params must have no padding");
+
+static struct chord_tune_engine *engines[MAX_ENGINES];
+static uint8_t engine_count;
+
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+
+/* engine ごとの chord/tune/<name>。書くのは chord_persist がまとめて後で */
+static char keys[MAX_ENGINES][sizeof(TUNE_SUBTREE) + 16];
+static struct chord_tune_params stored[MAX_ENGINES];
+static struct chord_persist_item items[MAX_ENGINES];
+
+static int index_of(const struct chord_tune_engine *engine) {
+    for (uint8_t i = 0; i < engine_count; i++) {
+        if (engines[i] == engine) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+#endif
+
+int chord_tune_register(struct chord_tune_engine *engine) {
+    if (engine_count == MAX_ENGINES) {
+        return -ENOMEM;
+    }
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+    snprintf(keys[engine_count], sizeof(keys[0]), TUNE_SUBTREE "/%s", engine->name);
+    items[engine_count] = (struct chord_persist_item)CHORD_PERSIST_ITEM_INIT(
+        keys[engine_count], stored[engine_count]);
+#endif
+    engines[engine_count++] = engine;
+    return 0;
+}
+
+struct chord_tune_engine *chord_tune_find(const char *name) {
+    for (uint8_t i = 0; i < engine_count; i++) {
+        if (strcmp(engines[i]->name, name) == 0) {
+            return engines[i];
+        }
+    }
+    return NULL;
+}
+
+static void apply(struct chord_tune_engine *engine, const struct chord_tune_params *params) {
+    engine->params = *params;
+    engine->params.reserved = 0;
+    engine->apply(&engine->params);
+}
+
+void chord_tune_set(struct chord_tune_engine *engine, const struct chord_tune_params *params) {
+    apply(engine, params);
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+    int i = index_of(engine);
+    if (i >= 0) {
+        chord_persist_set(&items[i], &engine->params);
+    }
+#endif
+}
+
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+
+int chord_tune_save(void) { return chord_persist_flush(); }
+
+int chord_tune_reset(void) {
+    int ret = 0;
+
+    for (uint8_t i = 0; i < engine_count; i++) {
+        apply(engines[i], &engines[i]->defaults);
+        int err = chord_persist_forget(&items[i]);
+        if (err && !ret) {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+/*
+ * settings_load は behavior の init（= register）より後に来るので、
+ * 読んだ値はそのまま engine に反映できる
+ */
+static int tune_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+                             void *cb_arg) {
+    struct chord_tune_params params;
+    struct chord_tune_engine *engine = chord_tune_find(name);
+
+    if (!engine) {
+        return -ENOENT;
+    }
+    if (len != sizeof(params)) {
+        /* 形が変わった: devicetree の値のまま */
+        return 0;
+    }
+
+    ssize_t rc = read_cb(cb_arg, &params, sizeof(params));
+    if (rc < 0) {
+        return (int)rc;
+    }
+    if (rc != sizeof(params)) {
+        LOG_WRN("chord tune: ignore saved %s (%d bytes)", name, (int)rc);
+        return 0;
+    }
+    /* reserved が無かった頃の値は、ここが padding のままのことがある */
+    params.reserved = 0;
+    apply(engine, &params);
+    chord_persist_loaded(&items[index_of(engine)], &params);
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(chord_tune, TUNE_SUBTREE, NULL, tune_settings_set, NULL, NULL);
+
+#else
+
+int chord_tune_save(void) { return -ENOTSUP; }
+
+int chord_tune_reset(void) {
+    for (uint8_t i = 0; i < engine_count; i++) {
+        apply(engines[i], &engines[i]->defaults);
+    }
+    return 0;
+}
+
+#endif
+
+/* ---- shell: chord tune [window|mode|gap|save|reset] ---------------------- */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static const char *const mode_names[] = {
+    [CHORD_COMMIT_ROLLOVER] = "rollover",
+    [CHORD_COMMIT_ALL_RELEASED] = "all-released",
+};
+
+static void print_engine(const struct shell *sh, const struct chord_tune_engine *e) {
+    const struct chord_tune_params *p = &e->params;
+    const char *mode = "?";
+
+    if (p->commit_mode < ARRAY_SIZE(mode_names)) {
+        mode = mode_names[p->commit_mode];
+    }
+
+    shell_print(sh, "%-9s window %3u ms%s  mode %-12s  gap %3u ms", e->name, p->window_ms,
+                IS_ENABLED(CONFIG_ZMK_CHORD_ADAPTIVE_WINDOW) ? " (adaptive start)" : "", mode,
+                p->gap_ms);
+}
+
+static int cmd_tune(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    if (engine_count == 0) {
+        shell_print(sh, "no chord engine");
+    }
+    for (uint8_t i = 0; i < engine_count; i++) {
+        print_engine(sh, engines[i]);
+    }
+    return 0;
+}
+
+static struct chord_tune_engine *engine_arg(const struct shell *sh, const char *name) {
+    struct chord_tune_engine *e = chord_tune_find(name);
+    if (!e) {
+        shell_error(sh, "unknown engine '%s'", name);
+    }
+    return e;
+}
+
+static bool ms_arg(const struct shell *sh, const char *arg, uint16_t *out) {
+    char *end;
+    unsigned long v = strtoul(arg, &end, 10);
+
+    if (end == arg || *end != '\0' || v > 1000) {
+        shell_error(sh, "bad value '%s' (0..1000 ms)", arg);
+        return false;
+    }
+    *out = (uint16_t)v;
+    return true;
+}
+
+static int cmd_window(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    struct chord_tune_engine *e = engine_arg(sh, argv[1]);
+    struct chord_tune_params p;
+
+    if (!e) {
+        return -EINVAL;
+    }
+    p = e->params;
+    if (!ms_arg(sh, argv[2], &p.window_ms)) {
+        return -EINVAL;
+    }
+    chord_tune_set(e, &p);
+    print_engine(sh, e);
+    return 0;
+}
+
+static int cmd_gap(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    struct chord_tune_engine *e = engine_arg(sh, argv[1]);
+    struct chord_tune_params p;
+
+    if (!e) {
+        return -EINVAL;
+    }
+    p = e->params;
+    if (!ms_arg(sh, argv[2], &p.gap_ms)) {
+        return -EINVAL;
+    }
+    chord_tune_set(e, &p);
+    print_engine(sh, e);
+    return 0;
+}
+
+static int cmd_mode(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    struct chord_tune_engine *e = engine_arg(sh, argv[1]);
+    struct chord_tune_params p;
+
+    if (!e) {
+        return -EINVAL;
+    }
+    p = e->params;
+    for (uint8_t m = 0; m < ARRAY_SIZE(mode_names); m++) {
+        if (strcmp(argv[2], mode_names[m]) == 0) {
+            p.commit_mode = m;
+            chord_tune_set(e, &p);
+            print_engine(sh, e);
+            return 0;
+        }
+    }
+    shell_error(sh, "mode is rollover or all-released");
+    return -EINVAL;
+}
+
+static int cmd_save(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    int err = chord_tune_save();
+    if (err) {
+        shell_error(sh, "save failed (%d)", err);
+        return err;
+    }
+    shell_print(sh, "saved");
+    return 0;
+}
+
+static int cmd_reset(const struct shell *sh, size_t argc, char **argv) {
+    int err = chord_tune_reset();
+    if (err) {
+        shell_warn(sh, "saved values not deleted (%d)", err);
+    }
+    return cmd_tune(sh, argc, argv);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(tune_cmds,
+                               SHELL_CMD_ARG(window, NULL, "window <engine> <ms>", cmd_window, 3,
+                                             0),
+                               SHELL_CMD_ARG(mode, NULL, "mode <engine> rollover|all-released",
+                                             cmd_mode, 3, 0),
+                               SHELL_CMD_ARG(gap, NULL, "gap <engine> <ms> (between output taps)",
+                                             cmd_gap, 3, 0),
+                               SHELL_CMD_ARG(save, NULL, "write to settings now (else debounced)",
+                                             cmd_save, 1, 0),
+                               SHELL_CMD_ARG(reset, NULL, "back to devicetree values", cmd_reset,
+                                             1, 0),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chord), tune, &tune_cmds, "Live chord window, commit mode and output pacing",
+                 cmd_tune, 1, 0);
+
+#endif
@@ -0,0 +1,697 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/keycode_state_changed.h>
+#include <dt-bindings/zmk/keys.h>
+#include <dt-bindings/zmk/modifiers.h>
+
+#include <chord/chord_companion.h>
+#include <chord/chord_power.h>
+#include <chord/chord_seg.h>
+#include <chord/kana_out.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+/* ---- kana -> romaji ---------------------------------------------------- */
+
+#define HIRA_FIRST 0x3041 /* ぁ */
+#define HIRA_LAST 0x3096  /* ゖ */
+#define KATA_OFFSET 0x60  /* ァ - ぁ */
+
+/* ぁ..ゖ の順。IME に入れたときに確実にその文字になる綴り */
+static const char *const hira_roman[HIRA_LAST - HIRA_FIRST + 1] = {
+    "xa", "a", "xi", "i", "xu", "u", "xe", "e", "xo", "o",
+    "ka", "ga", "ki", "gi", "ku", "gu", "ke", "ge", "ko", "go",
+    "sa", "za", "si", "zi", "su", "zu", "se", "ze", "so", "zo",
+    "ta", "da", "ti", "di", "xtu", "tu", "du", "te", "de", "to",
+    "do", "na", "ni", "nu", "ne", "no", "ha", "ba", "pa", "hi",
+    "bi", "pi", "hu", "bu", "pu", "he", "be", "pe", "ho", "bo",
+    "po", "ma", "mi", "mu", "me", "mo", "xya", "ya", "xyu", "yu",
+    "xyo", "yo", "ra", "ri", "ru", "re", "ro", "xwa", "wa", "wyi",
+    "wye", "wo", "nn", "vu", "xka", "xke",
+};
+
+/*
+ * 2 文字で 1 つの綴りになる組み合わせ。い段 + ゃゅょ（ki+xya -> kya）は規則で作り、
+ * ここにあるものはそれより短いか、規則では作れないもの。
+ */
+static const struct {
+    uint16_t first;
+    uint16_t second;
+    const char *roman;
+} digraphs[] = {
+    {0x3058, 0x3083, "ja"},  /* じゃ（zya より 1 つ短い） */
+    {0x3058, 0x3085, "ju"},  /* じゅ */
+    {0x3058, 0x3087, "jo"},  /* じょ */
+    {0x3058, 0x3047, "je"},  /* じぇ */
+    {0x3044, 0x3047, "ye"},  /* いぇ */
+    {0x3046, 0x3043, "wi"},  /* うぃ */
+    {0x3046, 0x3047, "we"},  /* うぇ */
+    {0x3057, 0x3047, "sye"}, /* しぇ */
+    {0x3061, 0x3047, "tye"}, /* ちぇ */
+    {0x304F, 0x3041, "kwa"}, /* くぁ */
+    {0x3050, 0x3041, "gwa"}, /* ぐぁ */
+    {0x3064, 0x3041, "tsa"}, /* つぁ */
+    {0x3068, 0x3045, "twu"}, /* とぅ */
+    {0x3069, 0x3045, "dwu"}, /* どぅ */
+    {0x3075, 0x3041, "fa"},  /* ふぁ */
+    {0x3075, 0x3043, "fi"},  /* ふぃ */
+    {0x3075, 0x3047, "fe"},  /* ふぇ */
+    {0x3075, 0x3049, "fo"},  /* ふぉ */
+    {0x3075, 0x3085, "fyu"}, /* ふゅ */
+    {0x3066, 0x3043, "thi"}, /* てぃ */
+    {0x3066, 0x3085, "thu"}, /* てゅ */
+    {0x3067, 0x3043, "dhi"}, /* でぃ */
+    {0x3067, 0x3085, "dhu"}, /* でゅ */
+    {0x3094, 0x3041, "va"},  /* ゔぁ */
+    {0x3094, 0x3043, "vi"},  /* ゔぃ */
+    {0x3094, 0x3047, "ve"},  /* ゔぇ */
+    {0x3094, 0x3049, "vo"},  /* ゔぉ */
+};
+
+/* 子音 + i のい段。ゃゅょ と 1 つの綴りにできる（ぃ ゐ い は xi / wyi / i のまま） */
+static const uint16_t yoon_bases[] = {
+    0x304D, 0x3057, 0x3061, 0x306B, 0x3072, 0x307F, /* き し ち に ひ み */
+    0x308A, 0x304E, 0x3058, 0x3062, 0x3073, 0x3074, /* り ぎ じ ぢ び ぴ */
+};
+
+static bool yoon_base(uint32_t cp) {
+    for (size_t i = 0; i < ARRAY_SIZE(yoon_bases); i++) {
+        if (yoon_bases[i] == cp) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#define SOKUON 0x3063  /* っ */
+#define HATSUON 0x3093 /* ん */
+
+/*
+ * っ / ん の後に来る綴りの先頭の文字で決まること（a..z）:
+ *  F_DOUBLE: っ をその子音の重ねで書ける（っか -> kka）
+ *  F_N:      ん を n 1 つで書ける（んか -> nka）。母音・n・y・x の前は nn のまま
+ */
+#define F_DOUBLE 0x1
+#define F_N 0x2
+
+static const uint8_t follow[26] = {
+    ['b' - 'a'] = F_DOUBLE | F_N, ['c' - 'a'] = F_DOUBLE | F_N, ['d' - 'a'] = F_DOUBLE | F_N,
+    ['f' - 'a'] = F_DOUBLE | F_N, ['g' - 'a'] = F_DOUBLE | F_N, ['h' - 'a'] = F_DOUBLE | F_N,
+    ['j' - 'a'] = F_DOUBLE | F_N, ['k' - 'a'] = F_DOUBLE | F_N, ['m' - 'a'] = F_DOUBLE | F_N,
+    ['p' - 'a'] = F_DOUBLE | F_N, ['r' - 'a'] = F_DOUBLE | F_N, ['s' - 'a'] = F_DOUBLE | F_N,
+    ['t' - 'a'] = F_DOUBLE | F_N, ['v' - 'a'] = F_DOUBLE | F_N, ['w' - 'a'] = F_DOUBLE | F_N,
+    ['y' - 'a'] = F_DOUBLE,       ['z' - 'a'] = F_DOUBLE | F_N,
+};
+
+static inline uint8_t follow_flags(char c) {
+    return (c >= 'a' && c <= 'z') ? follow[c - 'a'] : 0;
+}
+
+static uint32_t decode_utf8(const char **p) {
+    const uint8_t *s = (const uint8_t *)*p;
+    uint32_t cp;
+    int extra;
+
+    if (s[0] < 0x80) {
+        cp = s[0];
+        extra = 0;
+    } else if ((s[0] & 0xE0) == 0xC0) {
+        cp = s[0] & 0x1F;
+        extra = 1;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        cp = s[0] & 0x0F;
+        extra = 2;
+    } else {
+        cp = s[0] & 0x07;
+        extra = 3;
+    }
+    s++;
+    for (int i = 0; i < extra; i++) {
+        if ((*s & 0xC0) != 0x80) {
+            *p = (const char *)s;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (*s & 0x3F);
+        s++;
+    }
+    *p = (const char *)s;
+    return cp;
+}
+
+static inline uint32_t to_hiragana(uint32_t cp) {
+    if (cp >= HIRA_FIRST + KATA_OFFSET && cp <= HIRA_LAST + KATA_OFFSET) {
+        return cp - KATA_OFFSET;
+    }
+    return cp;
+}
+
+static const char *single_roman(uint32_t cp) {
+    cp = to_hiragana(cp);
+    if (cp >= HIRA_FIRST && cp <= HIRA_LAST) {
+        return hira_roman[cp - HIRA_FIRST];
+    }
+    switch (cp) {
+    case 0x30FC: /* ー */
+        return "-";
+    case 0x3001: /* 、 */
+        return ",";
+    case 0x3002: /* 。 */
+        return ".";
+    case 0x300C: /* 「 */
+        return "[";
+    case 0x300D: /* 」 */
+        return "]";
+    case 0x30FB: /* ・ */
+        return "/";
+    default:
+        return NULL;
+    }
+}
+
+static bool append(char *out, size_t out_len, size_t *pos, const char *s, size_t n) {
+    if (*pos + n + 1 > out_len) {
+        return false;
+    }
+    memcpy(&out[*pos], s, n);
+    *pos += n;
+    out[*pos] = '\0';
+    return true;
+}
+
+/*
+ * 次の 1 単位（かな 1〜2 文字、または ASCII 1 文字）の綴りを unit に入れて長さを返す。
+ * unit は NUL 終端しない。0 なら綴れない文字。
+ */
+static size_t next_unit(const char **p, uint32_t *cp_out, char unit[4]) {
+    uint32_t cp = decode_utf8(p);
+
+    *cp_out = to_hiragana(cp);
+    if (cp < 0x80) {
+        unit[0] = (char)cp;
+        return 1;
+    }
+
+    const char *r = single_roman(cp);
+    if (!r) {
+        LOG_DBG("kana_out: no romaji for U+%04x", cp);
+        return 0;
+    }
+
+    /* 次の文字が小書きなら 2 文字まとめられるか見る */
+    const char *q = *p;
+    const uint32_t next = *q ? to_hiragana(decode_utf8(&q)) : 0;
+    const uint32_t cur = *cp_out;
+    const size_t rl = strlen(r);
+
+    /* 2 文字目はどれも小書き（ぁ..ぉ、ゃゅょ）。それ以外なら表を見ない */
+    const bool small = (next >= 0x3041 && next <= 0x3049 && (next & 1)) ||
+                       next == 0x3083 || next == 0x3085 || next == 0x3087;
+    for (size_t i = 0; small && i < ARRAY_SIZE(digraphs); i++) {
+        if (digraphs[i].first == cur && digraphs[i].second == next) {
+            *p = q;
+            const size_t n = strlen(digraphs[i].roman);
+            memcpy(unit, digraphs[i].roman, n);
+            return n;
+        }
+    }
+
+    /* 子音 + i + ゃゅょ -> 末尾の i を y + 母音に (ki+xya -> kya) */
+    if (small && next >= 0x3083 && yoon_base(cur)) {
+        *p = q;
+        memcpy(unit, r, rl - 1);
+        unit[rl - 1] = 'y';
+        unit[rl] = hira_roman[next - HIRA_FIRST][2]; /* "xya" -> 'a' */
+        return rl + 1;
+    }
+
+    memcpy(unit, r, rl);
+    return rl;
+}
+
+/*
+ * っ と ん は次の単位を見るまで決めない（pending）。1 回の呼び出しの外は見えないので、
+ * 末尾に残ったものは単独でも崩れない xtu / nn で書く。
+ */
+size_t kana_roman_encode(const char *utf8, char *out, size_t out_len) {
+    size_t pos = 0;
+    uint8_t sokuon = 0; /* まだ書いていない っ の数 */
+    bool hatsuon = false;
+
+    if (!out || out_len == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+    if (!utf8) {
+        return 0;
+    }
+
+    const char *p = utf8;
+    for (;;) {
+        uint32_t cp = 0;
+        char unit[4];
+        size_t n = 0;
+
+        if (*p) {
+            n = next_unit(&p, &cp, unit);
+            if (n == 0) {
+                return 0;
+            }
+            if (cp == SOKUON && !hatsuon) {
+                sokuon++;
+                continue;
+            }
+            if (cp == HATSUON && !sokuon && !hatsuon) {
+                hatsuon = true;
+                continue;
+            }
+        }
+
+        /* ASCII の前は IME がどう繋げるか分からないので単独の綴りのまま */
+        const uint8_t f = (n && cp >= 0x80) ? follow_flags(unit[0]) : 0;
+        if (hatsuon) {
+            if (!append(out, out_len, &pos, "nn", (f & F_N) ? 1 : 2)) {
+                return 0;
+            }
+            hatsuon = false;
+        }
+        for (; sokuon; sokuon--) {
+            /* 重ねられるのは直前の 1 つだけ（っっか -> xtukka） */
+            const bool dbl = sokuon == 1 && (f & F_DOUBLE);
+            if (!append(out, out_len, &pos, dbl ? unit : "xtu", dbl ? 1 : 3)) {
+                return 0;
+            }
+        }
+        if (n == 0) {
+            break;
+        }
+        if (cp == SOKUON || cp == HATSUON) {
+            /* ん の後の っ / ん（pending を書いた後なので、ここから数え直す） */
+            sokuon = cp == SOKUON;
+            hatsuon = cp == HATSUON;
+            continue;
+        }
+        if (!append(out, out_len, &pos, unit, n)) {
+            return 0;
+        }
+    }
+    return pos;
+}
+
+/* ---- romaji -> keycode taps -------------------------------------------- */
+
+/* ASCII 1文字 -> encoded keycode。0 なら送れない（記号は US 配列前提の最小限） */
+static uint32_t ascii_to_keycode(char c) {
+    if (c >= 'a' && c <= 'z') {
+        return A + (uint32_t)(c - 'a');
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return LS(A + (uint32_t)(c - 'A'));
+    }
+    if (c >= '1' && c <= '9') {
+        return N1 + (uint32_t)(c - '1');
+    }
+
+    switch (c) {
+    case '0':
+        return N0;
+    case '-':
+        return MINUS;
+    case ' ':
+        return SPACE;
+    case ',':
+        return COMMA;
+    case '.':
+        return DOT;
+    case '/':
+        return SLASH;
+    case '[':
+        return LBKT;
+    case ']':
+        return RBKT;
+    case '\'':
+        return SQT;
+    case '\b': /* companion に送れなかった Backspace */
+        return BSPC;
+    case '\n': /* 改行（薙刀式の 、{Enter} など） */
+        return ENTER;
+    default:
+        return 0;
+    }
+}
+
+static struct kana_out_stats stats;
+
+/* キーを読んだ時刻から HID に出すまで（queue で待った分も入る） */
+static void tap(uint32_t keycode, int64_t timestamp) {
+    const int64_t ms = k_uptime_get() - timestamp;
+    const uint32_t v = ms > 0 ? (uint32_t)MIN(ms, (int64_t)UINT32_MAX) : 0;
+
+    raise_zmk_keycode_state_changed_from_encoded(keycode, true, timestamp);
+    raise_zmk_keycode_state_changed_from_encoded(keycode, false, timestamp);
+    stats.taps++;
+    stats.hid_ms_sum += v;
+    stats.hid_ms_max = MAX(stats.hid_ms_max, v);
+}
+
+void kana_out_get_stats(struct kana_out_stats *out) {
+    if (out) {
+        *out = stats;
+    }
+}
+
+/* UTF-8 の文字数（継続バイト以外を数える） */
+static uint32_t utf8_chars(const char *s) {
+    uint32_t n = 0;
+    for (; *s; s++) {
+        n += (((uint8_t)*s & 0xC0) != 0x80);
+    }
+    return n;
+}
+
+/* ---- paced output ------------------------------------------------------ */
+
+/*
+ * gap_ms > 0 の tap は queue に積み、one-shot の delayable work で流す。入力の
+ * スレッドを k_msleep で止めず、queue が空になったら work は張り直さないので、
+ * 打っていない間に起きることは無い。最初の burst はその場で送る（従来どおり
+ * 最初の tap の前は待たない）。send も work も system work queue で動く前提。
+ *
+ * kana_out を通さない出力（薙刀式の type_keys など）は kana_out_call() で同じ
+ * queue に印（keycode 0）を積み、その順番が来たら work から呼ぶ。呼ばれた call が
+ * 積むものは、その後ろに並んでいる（call より新しい）ものより前に入れる。
+ * companion が返事待ちの間も keycode は queue に並べて止めておき、返事が来たら
+ * kana_out_resume() で流す（companion に渡した文字の方が先）。
+ */
+#ifdef CONFIG_ZMK_CHORD_OUTPUT_QUEUE_LEN
+#define OUT_QUEUE_LEN CONFIG_ZMK_CHORD_OUTPUT_QUEUE_LEN
+#else
+#define OUT_QUEUE_LEN 64
+#endif
+
+#define OUT_CALL 0 /* keycode 0: calls の先頭を呼ぶ */
+#define CALL_QUEUE_LEN 8
+
+/*
+ * 後から送る tap も、元のキーを読んだ時刻（send に渡された timestamp）で送る。
+ * 下位 32 bit だけ持ち、送る時に今の時刻から戻す（49 日より長く並ぶことは無い）。
+ */
+struct out_tap {
+    uint32_t keycode;
+    uint32_t stamp;
+    uint16_t gap_ms; /* この tap の後に空ける時間 */
+};
+
+static struct {
+    struct out_tap q[OUT_QUEUE_LEN];
+    uint16_t head;
+    uint16_t count;
+} out;
+
+struct out_call {
+    kana_out_call_cb fn;
+    uint32_t args[CHORD_STROKE_MAX_KEYS];
+    uint8_t count;
+};
+
+static struct {
+    struct out_call q[CALL_QUEUE_LEN];
+    uint8_t head;
+    uint8_t count;
+} calls;
+
+/* drain の中から呼んだ call が send しても、drain を入れ子にしない */
+static bool draining;
+
+/* run() が呼んでいる call の中: 積んだものは先頭から taps / calls 個目に入れる */
+static struct call_ctx {
+    bool active;
+    uint16_t taps;
+    uint8_t calls;
+} in_call;
+
+/* これから積むものより前に並んでいる数（call の中ならその call が積んだ分だけ） */
+static inline uint16_t ahead(void) {
+    return in_call.active ? in_call.taps : out.count;
+}
+
+static inline bool companion_busy(void) {
+#if IS_ENABLED(CONFIG_ZMK_CHORD_COMPANION)
+    return chord_companion_busy();
+#else
+    return false;
+#endif
+}
+
+static void drain_work_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(drain_work, drain_work_handler);
+
+static int64_t tap_time(const struct out_tap *t) {
+    const int64_t now = k_uptime_get();
+    return now - (uint32_t)((uint32_t)now - t->stamp);
+}
+
+static struct out_tap pop(void) {
+    struct out_tap t = out.q[out.head];
+    out.head = (out.head + 1) % OUT_QUEUE_LEN;
+    out.count--;
+    return t;
+}
+
+/* call は fn の中でまた kana_out_call() されてもいいよう、外してから呼ぶ */
+static void run(const struct out_tap *t) {
+    if (t->keycode != OUT_CALL) {
+        tap(t->keycode, tap_time(t));
+        return;
+    }
+
+    struct out_call c = calls.q[calls.head];
+    const struct call_ctx outer = in_call;
+
+    calls.head = (calls.head + 1) % CALL_QUEUE_LEN;
+    calls.count--;
+    in_call.active = true;
+    in_call.taps = 0;
+    in_call.calls = 0;
+    c.fn(c.args, c.count, tap_time(t));
+    in_call = outer;
+}
+
+/* 1 burst 送り、残っていれば次を予約する */
+static void drain(void) {
+    if (!out.count || draining || companion_busy()) {
+        return;
+    }
+
+    struct chord_power_pacing pacing = chord_power_pacing(out.q[out.head].gap_ms);
+    uint16_t gap_ms = pacing.gap_ms;
+
+    draining = true;
+    for (uint8_t i = 0; i < pacing.burst && out.count; i++) {
+        struct out_tap t = pop();
+        run(&t);
+        gap_ms = MAX(gap_ms, t.gap_ms);
+        if (companion_busy()) {
+            /* call が companion に送った: 続きは kana_out_resume() から */
+            break;
+        }
+    }
+    draining = false;
+    if (out.count && !companion_busy()) {
+        k_work_schedule(&drain_work, K_MSEC(gap_ms));
+    }
+}
+
+static void drain_work_handler(struct k_work *work) {
+    ARG_UNUSED(work);
+    chord_power_wake(CHORD_WAKE_OUTPUT);
+    drain();
+}
+
+void kana_out_flush(void) {
+#if IS_ENABLED(CONFIG_ZMK_CHORD_COMPANION)
+    chord_companion_flush();
+#endif
+    if (!out.count) {
+        return;
+    }
+    (void)k_work_cancel_delayable(&drain_work);
+    while (out.count) {
+        struct out_tap t = pop();
+        run(&t);
+#if IS_ENABLED(CONFIG_ZMK_CHORD_COMPANION)
+        chord_companion_flush();
+#endif
+        if (out.count && t.gap_ms) {
+            k_msleep(t.gap_ms);
+        }
+    }
+}
+
+void kana_out_resume(void) {
+    (void)k_work_schedule(&drain_work, K_NO_WAIT);
+}
+
+/*
+ * n 個積む場所があるか。溢れる時は待たずに（system work queue で眠らない）その分を捨て、
+ * 流れていなければ流し始める。一部だけ積むと途中で切れるので、まとめて見る
+ */
+static bool room(size_t n) {
+    if (n <= (size_t)(OUT_QUEUE_LEN - out.count)) {
+        return true;
+    }
+    LOG_WRN("kana_out: output queue full, dropped %u tap(s)", (unsigned)n);
+    if (!k_work_delayable_is_pending(&drain_work)) {
+        (void)k_work_schedule(&drain_work, K_NO_WAIT);
+    }
+    return false;
+}
+
+/* room() を見てから呼ぶ。call の中なら、後ろに並んでいるものをずらして前に入れる */
+static void push(uint32_t keycode, uint16_t gap_ms, int64_t timestamp) {
+    uint16_t at = out.count;
+
+    if (in_call.active) {
+        at = in_call.taps++;
+        for (uint16_t i = out.count; i > at; i--) {
+            out.q[(out.head + i) % OUT_QUEUE_LEN] = out.q[(out.head + i - 1) % OUT_QUEUE_LEN];
+        }
+    }
+    out.q[(out.head + at) % OUT_QUEUE_LEN] = (struct out_tap){
+        .keycode = keycode,
+        .stamp = (uint32_t)timestamp,
+        .gap_ms = gap_ms,
+    };
+    out.count++;
+}
+
+/* 積み終わったら流し始める（既に流れている間は work に任せる） */
+static void start(void) {
+    if (!k_work_delayable_is_pending(&drain_work)) {
+        drain();
+    }
+}
+
+void kana_out_call(kana_out_call_cb fn, const uint32_t *args, uint8_t count, int64_t timestamp) {
+    if (!fn) {
+        return;
+    }
+    if (!ahead() && !companion_busy()) {
+        fn(args, count, timestamp);
+        return;
+    }
+    if (calls.count == CALL_QUEUE_LEN || !room(1)) {
+        LOG_WRN("kana_out: call queue full, dropped a call");
+        return;
+    }
+
+    struct out_call *c;
+    uint8_t at = calls.count;
+
+    count = MIN(count, CHORD_STROKE_MAX_KEYS);
+    push(OUT_CALL, 0, timestamp);
+    if (in_call.active) {
+        at = in_call.calls++;
+        for (uint8_t i = calls.count; i > at; i--) {
+            calls.q[(calls.head + i) % CALL_QUEUE_LEN] =
+                calls.q[(calls.head + i - 1) % CALL_QUEUE_LEN];
+        }
+    }
+    c = &calls.q[(calls.head + at) % CALL_QUEUE_LEN];
+    c->fn = fn;
+    memcpy(c->args, args, count * sizeof(args[0]));
+    c->count = count;
+    calls.count++;
+    start();
+}
+
+bool kana_out_send(const char *utf8, int64_t timestamp) {
+    return kana_out_send_paced(utf8, 0, timestamp);
+}
+
+/* now: queue に並んでいるものより先に、その場で tap する */
+static bool send_keys(const char *utf8, uint16_t gap_ms, bool now, int64_t timestamp) {
+    char roman[96];
+
+    if (!utf8) {
+        return false;
+    }
+    roman[0] = '\0';
+    if (*utf8 && kana_roman_encode(utf8, roman, sizeof(roman)) == 0) {
+        return false;
+    }
+
+    /* 流している途中か companion の返事待ちなら、間隔 0 でも後ろに並べる */
+    const bool queued = !now && (gap_ms || ahead() || companion_busy());
+    bool all = true;
+
+    if (queued && !room(strlen(roman))) {
+        return false;
+    }
+
+    for (const char *p = roman; *p; p++) {
+        uint32_t keycode = ascii_to_keycode(*p);
+        if (keycode == 0) {
+            LOG_DBG("kana_out: skip 0x%02x", (uint8_t)*p);
+            all = false;
+            continue;
+        }
+        if (queued) {
+            push(keycode, gap_ms, timestamp);
+        } else {
+            tap(keycode, timestamp);
+        }
+    }
+    if (queued) {
+        start();
+    }
+    chord_power_chars(utf8_chars(utf8));
+    return all;
+}
+
+bool kana_out_send_keys(const char *utf8, int64_t timestamp) {
+    return send_keys(utf8, 0, true, timestamp);
+}
+
+bool kana_out_send_paced(const char *utf8, uint16_t gap_ms, int64_t timestamp) {
+#if IS_ENABLED(CONFIG_ZMK_CHORD_COMPANION)
+    /* keycode がまだ流れている間は、順番を崩さないよう後ろに並べる */
+    if (utf8 && !ahead() && chord_companion_send(utf8, timestamp)) {
+        chord_power_chars(utf8_chars(utf8));
+        return true;
+    }
+#endif
+    return send_keys(utf8, gap_ms, false, timestamp);
+}
+
+void kana_out_backspaces(size_t count, int64_t timestamp) {
+    kana_out_backspaces_paced(count, 0, timestamp);
+}
+
+void kana_out_backspaces_paced(size_t count, uint16_t gap_ms, int64_t timestamp) {
+#if IS_ENABLED(CONFIG_ZMK_CHORD_COMPANION)
+    if (!ahead() && chord_companion_backspaces(count, timestamp)) {
+        return;
+    }
+#endif
+    if (!gap_ms && !ahead() && !companion_busy()) {
+        for (size_t i = 0; i < count; i++) {
+            tap(BSPC, timestamp);
+        }
+        return;
+    }
+    if (!room(count)) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        push(BSPC, gap_ms, timestamp);
+    }
+    start();
+}
@@ -0,0 +1,98 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+
+#include <chord/kana_pack.h>
+
+#define TOK_ESC 0x7F
+#define TOK_HIRA 0x80 /* ..0xD5 */
+#define TOK_PUNCT 0xD6 /* ..0xDB */
+#define TOK_KATA 0xDC
+#define TOK_BIGRAM 0xDD /* ..0xFF */
+
+#define HIRA_FIRST 0x3041
+#define HIRA_COUNT 86
+#define KATA_OFFSET 0x60
+
+static const uint16_t punct[] = {0x30FC, 0x3001, 0x3002, 0x300C, 0x300D, 0x30FB};
+
+/* mejiro_dictc.py の BIGRAMS と同じ順（変えるとイメージの互換が切れる） */
+static const char *const bigrams[0x100 - TOK_BIGRAM] = {
+    "ょう", "ゅう", "った", "って", "ます", "した", "する", "です", "ない",
+    "こと", "いる", "ある", "れる", "から", "まし", "その", "この", "ため",
+    "もの", "よう", "しょ", "しゅ", "きょ", "ちょ", "じょ", "じゅ", "りょ",
+    "せい", "とう", "こう", "しい", "ける", "いう", "なる", "られ",
+};
+
+static size_t put_cp(uint32_t cp, char *out, size_t out_len, size_t pos) {
+    /* ここに来るのは U+3000 台だけ（3 bytes） */
+    if (pos + 3 >= out_len) {
+        return 0;
+    }
+    out[pos] = (char)(0xE0 | (cp >> 12));
+    out[pos + 1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[pos + 2] = (char)(0x80 | (cp & 0x3F));
+    return pos + 3;
+}
+
+size_t kana_pack_decode(const uint8_t *in, size_t len, char *out, size_t out_len) {
+    size_t pos = 0;
+    size_t i = 0;
+
+    if (!out || out_len == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+    if (!in) {
+        return 0;
+    }
+
+    while (i < len) {
+        uint8_t t = in[i++];
+
+        if (t >= 0x01 && t < TOK_ESC) {
+            if (pos + 1 >= out_len) {
+                goto fail;
+            }
+            out[pos++] = (char)t;
+        } else if (t == TOK_ESC) {
+            if (i >= len || i + 1 + in[i] > len || pos + in[i] >= out_len) {
+                goto fail;
+            }
+            memcpy(&out[pos], &in[i + 1], in[i]);
+            pos += in[i];
+            i += 1 + in[i];
+        } else if (t >= TOK_HIRA && t < TOK_PUNCT) {
+            pos = put_cp(HIRA_FIRST + (t - TOK_HIRA), out, out_len, pos);
+        } else if (t >= TOK_PUNCT && t < TOK_KATA) {
+            pos = put_cp(punct[t - TOK_PUNCT], out, out_len, pos);
+        } else if (t == TOK_KATA) {
+            if (i >= len || in[i] < TOK_HIRA || in[i] >= TOK_PUNCT) {
+                goto fail;
+            }
+            pos = put_cp(HIRA_FIRST + KATA_OFFSET + (in[i++] - TOK_HIRA), out, out_len, pos);
+        } else if (t >= TOK_BIGRAM) {
+            const char *b = bigrams[t - TOK_BIGRAM];
+            size_t n = strlen(b);
+            if (pos + n >= out_len) {
+                goto fail;
+            }
+            memcpy(&out[pos], b, n);
+            pos += n;
+        } else {
+            goto fail; /* 0x00 */
+        }
+
+        if (pos == 0) {
+            goto fail; /* put_cp の out 不足 */
+        }
+    }
+
+    out[pos] = '\0';
+    return pos;
+
+fail:
+    out[0] = '\0';
+    return 0;
+}
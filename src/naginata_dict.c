@@ -0,0 +1,343 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * 薙刀式 v16 の同時押し判定（無シフト面・シフト面・濁音 / 拗音 / 外来音・編集モード）。
+ * 表は naginata_zmk_v16.rb の出力から、かなを UTF-8 で持つ形にしたもの（綴りは kana_out）。
+ * 親指先行シフト面は naginata_shift.c。
+ */
+#include <stddef.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <chord/kana_out.h>
+#include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_keys.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+struct ng_entry {
+    uint32_t keys;                   /* 同時に押すキー（B_*、シフトキーも含む） */
+    const char *kana;                /* かな（UTF-8） */
+    void (*func)(int64_t timestamp); /* kana の後に呼ぶ（NULL 可） */
+};
+
+/* 親指シフト（ng SPACE / ng SQT）。ストロークの中で一度押されたら、残りのキーにも効く */
+#define B_THUMBS (B_SPACE | B_SQT)
+
+static const struct ng_entry ngmap[] = {
+    /* 単打・シフトの記号と編集キー（tanda / shifted の {…}） */
+    {B_SPACE, " "},
+    {B_T, NULL, ng_T},
+    {B_Y, NULL, ng_Y},
+    {B_U, "\b"},
+    {B_SPACE | B_T, NULL, ng_ST},
+    {B_SPACE | B_Y, NULL, ng_SY},
+    {B_SPACE | B_V, "、\n"},
+    {B_SPACE | B_M, "。\n"},
+    {B_V | B_M, "\n"},
+    /* 清音 */
+    {B_J, "あ"},
+    {B_K, "い"},
+    {B_L, "う"},
+    {B_SPACE | B_O, "え"},
+    {B_SPACE | B_N, "お"},
+    {B_F, "か"},
+    {B_W, "き"},
+    {B_H, "く"},
+    {B_S, "け"},
+    {B_V, "こ"},
+    {B_SPACE | B_U, "さ"},
+    {B_R, "し"},
+    {B_O, "す"},
+    {B_SPACE | B_A, "せ"},
+    {B_B, "そ"},
+    {B_N, "た"},
+    {B_SPACE | B_G, "ち"},
+    {B_SPACE | B_L, "つ"},
+    {B_E, "て"},
+    {B_D, "と"},
+    {B_M, "な"},
+    {B_SPACE | B_D, "に"},
+    {B_SPACE | B_W, "ぬ"},
+    {B_SPACE | B_COMMA, "ね"},
+    {B_SPACE | B_J, "の"},
+    {B_C, "は"},
+    {B_X, "ひ"},
+    {B_SPACE | B_X, "ひ"},
+    {B_SPACE | B_SEMI, "ふ"},
+    {B_P, "へ"},
+    {B_Z, "ほ"},
+    {B_SPACE | B_Z, "ほ"},
+    {B_SPACE | B_F, "ま"},
+    {B_SPACE | B_S, "み"},
+    {B_SPACE | B_B, "む"},
+    {B_SPACE | B_R, "め"},
+    {B_SPACE | B_K, "も"},
+    {B_SPACE | B_H, "や"},
+    {B_SPACE | B_P, "ゆ"},
+    {B_SPACE | B_I, "よ"},
+    {B_DOT, "ら"},
+    {B_SPACE | B_E, "り"},
+    {B_I, "る"},
+    {B_SLASH, "れ"},
+    {B_SPACE | B_SLASH, "れ"},
+    {B_A, "ろ"},
+    {B_SPACE | B_DOT, "わ"},
+    {B_SPACE | B_C, "を"},
+    {B_COMMA, "ん"},
+    {B_SEMI, "ー"},
+    /* 濁音（F+L は づ。v16 の表では ゔ と重なっていて先の づ が勝つ。ゔ は先行シフト面） */
+    {B_J | B_F, "が"},
+    {B_J | B_W, "ぎ"},
+    {B_F | B_H, "ぐ"},
+    {B_J | B_S, "げ"},
+    {B_J | B_V, "ご"},
+    {B_F | B_U, "ざ"},
+    {B_J | B_R, "じ"},
+    {B_F | B_O, "ず"},
+    {B_J | B_A, "ぜ"},
+    {B_J | B_B, "ぞ"},
+    {B_F | B_N, "だ"},
+    {B_J | B_G, "ぢ"},
+    {B_F | B_L, "づ"},
+    {B_J | B_E, "で"},
+    {B_J | B_D, "ど"},
+    {B_J | B_C, "ば"},
+    {B_J | B_X, "び"},
+    {B_F | B_SEMI, "ぶ"},
+    {B_F | B_P, "べ"},
+    {B_J | B_Z, "ぼ"},
+    /* 半濁音 */
+    {B_M | B_C, "ぱ"},
+    {B_M | B_X, "ぴ"},
+    {B_V | B_SEMI, "ぷ"},
+    {B_V | B_P, "ぺ"},
+    {B_M | B_Z, "ぽ"},
+    /* 小書き */
+    {B_Q | B_H, "ゃ"},
+    {B_Q | B_P, "ゅ"},
+    {B_Q | B_I, "ょ"},
+    {B_Q | B_J, "ぁ"},
+    {B_Q | B_K, "ぃ"},
+    {B_Q | B_L, "ぅ"},
+    {B_Q | B_O, "ぇ"},
+    {B_Q | B_N, "ぉ"},
+    {B_Q | B_DOT, "ゎ"},
+    {B_G, "っ"},
+    {B_Q | B_S, "ヶ"},
+    {B_Q | B_F, "ヵ"},
+    /* 清音拗音 濁音拗音 半濁拗音 */
+    {B_R | B_H, "しゃ"},
+    {B_R | B_P, "しゅ"},
+    {B_R | B_I, "しょ"},
+    {B_J | B_R | B_H, "じゃ"},
+    {B_J | B_R | B_P, "じゅ"},
+    {B_J | B_R | B_I, "じょ"},
+    {B_W | B_H, "きゃ"},
+    {B_W | B_P, "きゅ"},
+    {B_W | B_I, "きょ"},
+    {B_J | B_W | B_H, "ぎゃ"},
+    {B_J | B_W | B_P, "ぎゅ"},
+    {B_J | B_W | B_I, "ぎょ"},
+    {B_G | B_H, "ちゃ"},
+    {B_G | B_P, "ちゅ"},
+    {B_G | B_I, "ちょ"},
+    {B_J | B_G | B_H, "ぢゃ"},
+    {B_J | B_G | B_P, "ぢゅ"},
+    {B_J | B_G | B_I, "ぢょ"},
+    {B_D | B_H, "にゃ"},
+    {B_D | B_P, "にゅ"},
+    {B_D | B_I, "にょ"},
+    {B_X | B_H, "ひゃ"},
+    {B_X | B_P, "ひゅ"},
+    {B_X | B_I, "ひょ"},
+    {B_J | B_X | B_H, "びゃ"},
+    {B_J | B_X | B_P, "びゅ"},
+    {B_J | B_X | B_I, "びょ"},
+    {B_M | B_X | B_H, "ぴゃ"},
+    {B_M | B_X | B_P, "ぴゅ"},
+    {B_M | B_X | B_I, "ぴょ"},
+    {B_S | B_H, "みゃ"},
+    {B_S | B_P, "みゅ"},
+    {B_S | B_I, "みょ"},
+    {B_E | B_H, "りゃ"},
+    {B_E | B_P, "りゅ"},
+    {B_E | B_I, "りょ"},
+    /* 清音外来音 濁音外来音 */
+    {B_M | B_E | B_K, "てぃ"},
+    {B_M | B_E | B_P, "てゅ"},
+    {B_J | B_E | B_K, "でぃ"},
+    {B_J | B_E | B_P, "でゅ"},
+    {B_M | B_D | B_L, "とぅ"},
+    {B_J | B_D | B_L, "どぅ"},
+    {B_M | B_R | B_O, "しぇ"},
+    {B_M | B_G | B_O, "ちぇ"},
+    {B_J | B_R | B_O, "じぇ"},
+    {B_J | B_G | B_O, "ぢぇ"},
+    {B_V | B_SEMI | B_J, "ふぁ"},
+    {B_V | B_SEMI | B_K, "ふぃ"},
+    {B_V | B_SEMI | B_O, "ふぇ"},
+    {B_V | B_SEMI | B_N, "ふぉ"},
+    {B_V | B_SEMI | B_P, "ふゅ"},
+    {B_V | B_K | B_O, "いぇ"},
+    {B_V | B_L | B_K, "うぃ"},
+    {B_V | B_L | B_O, "うぇ"},
+    {B_V | B_L | B_N, "うぉ"},
+    {B_F | B_L | B_J, "ゔぁ"},
+    {B_F | B_L | B_K, "ゔぃ"},
+    {B_F | B_L | B_O, "ゔぇ"},
+    {B_F | B_L | B_N, "ゔぉ"},
+    {B_F | B_L | B_P, "ゔゅ"},
+    {B_V | B_H | B_J, "くぁ"},
+    {B_V | B_H | B_K, "くぃ"},
+    {B_V | B_H | B_O, "くぇ"},
+    {B_V | B_H | B_N, "くぉ"},
+    {B_V | B_H | B_DOT, "くゎ"},
+    {B_F | B_H | B_J, "ぐぁ"},
+    {B_F | B_H | B_K, "ぐぃ"},
+    {B_F | B_H | B_O, "ぐぇ"},
+    {B_F | B_H | B_N, "ぐぉ"},
+    {B_F | B_H | B_DOT, "ぐゎ"},
+    {B_V | B_L | B_J, "つぁ"},
+#if IS_ENABLED(CONFIG_ZMK_NAGINATA_EDIT)
+    /* 編集モード（J+K+E は上の でぃ が取るので ngh_JKE は置かない） */
+    {B_J | B_K | B_Q, NULL, ngh_JKQ}, /* ^{End} */
+    {B_J | B_K | B_W, NULL, ngh_JKW}, /* ／{改行} */
+    {B_J | B_K | B_R, NULL, ngh_JKR}, /* ^s */
+    {B_J | B_K | B_T, NULL, ngh_JKT}, /* ・ */
+    {B_J | B_K | B_A, NULL, ngh_JKA}, /* ……{改行} */
+    {B_J | B_K | B_S, NULL, ngh_JKS}, /* 『{改行} */
+    {B_J | B_K | B_D, NULL, ngh_JKD}, /* ？{改行} */
+    {B_J | B_K | B_F, NULL, ngh_JKF}, /* 「{改行} */
+    {B_J | B_K | B_G, NULL, ngh_JKG}, /* ({改行} */
+    {B_J | B_K | B_Z, NULL, ngh_JKZ}, /* ――{改行} */
+    {B_J | B_K | B_X, NULL, ngh_JKX}, /* 』{改行} */
+    {B_J | B_K | B_C, NULL, ngh_JKC}, /* ！{改行} */
+    {B_J | B_K | B_V, NULL, ngh_JKV}, /* 」{改行} */
+    {B_J | B_K | B_B, NULL, ngh_JKB}, /* ){改行} */
+    {B_D | B_F | B_Y, NULL, ngh_DFY}, /* {Home} */
+    {B_D | B_F | B_U, NULL, ngh_DFU}, /* +{End}{BS} */
+    {B_D | B_F | B_I, NULL, ngh_DFI}, /* {vk1Csc079} */
+    {B_D | B_F | B_O, NULL, ngh_DFO}, /* {Del} */
+    {B_D | B_F | B_P, NULL, ngh_DFP}, /* +{Esc 2} */
+    {B_D | B_F | B_H, NULL, ngh_DFH}, /* {Enter}{End} */
+    {B_D | B_F | B_J, NULL, ngh_DFJ}, /* {↑} */
+    {B_D | B_F | B_K, NULL, ngh_DFK}, /* +{↑} */
+    {B_D | B_F | B_L, NULL, ngh_DFL}, /* +{↑ 7} */
+    {B_D | B_F | B_SEMI, NULL, ngh_DFSCLN}, /* ^i */
+    {B_D | B_F | B_N, NULL, ngh_DFN}, /* {End} */
+    {B_D | B_F | B_M, NULL, ngh_DFM}, /* {↓} */
+    {B_D | B_F | B_COMMA, NULL, ngh_DFCOMM}, /* +{↓} */
+    {B_D | B_F | B_DOT, NULL, ngh_DFDOT}, /* +{↓ 7} */
+    {B_D | B_F | B_SLASH, NULL, ngh_DFSLSH}, /* ^u */
+    {B_M | B_COMMA | B_Q, NULL, ngh_MCQ}, /* ｜{改行} */
+    {B_M | B_COMMA | B_W, NULL, ngh_MCW}, /* ×　　　×　　　×{改行 2} */
+    {B_M | B_COMMA | B_E, NULL, ngh_MCE}, /* {Home}{→}{End}{Del 2}{←} */
+    {B_M | B_COMMA | B_R, NULL, ngh_MCR}, /* {Home}{改行}{Space 1}{←} */
+    {B_M | B_COMMA | B_T, NULL, ngh_MCT}, /* 〇{改行} */
+    {B_M | B_COMMA | B_A, NULL, ngh_MCA}, /* 《{改行} */
+    {B_M | B_COMMA | B_S, NULL, ngh_MCS}, /* 【{改行} */
+    {B_M | B_COMMA | B_D, NULL, ngh_MCD}, /* {Home}{→}{End}{Del 4}{←} */
+    {B_M | B_COMMA | B_F, NULL, ngh_MCF}, /* {Home}{改行}{Space 3}{←} */
+    {B_M | B_COMMA | B_G, NULL, ngh_MCG}, /* {Space 3} */
+    {B_M | B_COMMA | B_Z, NULL, ngh_MCZ}, /* 》{改行} */
+    {B_M | B_COMMA | B_X, NULL, ngh_MCX}, /* 】{改行} */
+    {B_M | B_COMMA | B_C, NULL, ngh_MCC}, /* 」{改行}{改行} */
+    {B_M | B_COMMA | B_V, NULL, ngh_MCV}, /* 」{改行}{改行}「{改行} */
+    {B_M | B_COMMA | B_B, NULL, ngh_MCB}, /* 」{改行}{改行}{Space} */
+    {B_C | B_V | B_Y, NULL, ngh_CVY}, /* +{Home} */
+    {B_C | B_V | B_U, NULL, ngh_CVU}, /* ^x */
+    {B_C | B_V | B_I, NULL, ngh_CVI}, /* {vk1Csc079} */
+    {B_C | B_V | B_O, NULL, ngh_CVO}, /* ^v */
+    {B_C | B_V | B_P, NULL, ngh_CVP}, /* ^z */
+    {B_C | B_V | B_H, NULL, ngh_CVH}, /* ^c */
+    {B_C | B_V | B_J, NULL, ngh_CVJ}, /* {←} */
+    {B_C | B_V | B_K, NULL, ngh_CVK}, /* {→} */
+    {B_C | B_V | B_L, NULL, ngh_CVL}, /* {改行}{Space}+{Home}^x{BS} */
+    {B_C | B_V | B_SEMI, NULL, ngh_CVSCLN}, /* ^y */
+    {B_C | B_V | B_N, NULL, ngh_CVN}, /* +{End} */
+    {B_C | B_V | B_M, NULL, ngh_CVM}, /* +{←} */
+    {B_C | B_V | B_COMMA, NULL, ngh_CVCOMM}, /* +{→} */
+    {B_C | B_V | B_DOT, NULL, ngh_CVDOT}, /* +{← 7} */
+    {B_C | B_V | B_SLASH, NULL, ngh_CVSLSH}, /* +{→ 7} */
+#endif
+};
+
+static const struct ng_entry *lookup(uint32_t keys) {
+    for (size_t i = 0; i < ARRAY_SIZE(ngmap); i++) {
+        if (ngmap[i].keys == keys) {
+            return &ngmap[i];
+        }
+    }
+    return NULL;
+}
+
+/* kana_out_call() から、並んだ順番で ngmap[args[0]].func を呼ぶ */
+static void run_func(const uint32_t *args, uint8_t count, int64_t timestamp) {
+    ARG_UNUSED(count);
+    ngmap[args[0]].func(timestamp);
+}
+
+/*
+ * 1 ストローク（押下順の keycode）を表で引く。全体が 1 つの組み合わせならそれ、
+ * そうでなければ先頭から一番長く一致するものを取り、残りを続けて引く（重なった
+ * ロールオーバー）。どれにも当たらないキーは捨てる。
+ */
+static bool type_stroke(const NGList *stroke, int64_t timestamp) {
+    const uint16_t gap_ms = naginata_get_timing()->inter_key_gap_ms;
+    uint32_t thumbs = 0;
+    bool typed = false;
+
+    for (int i = 0; i < stroke->size;) {
+        const struct ng_entry *hit = NULL;
+        uint32_t keys = 0;
+        int len = 0;
+
+        for (int j = i; j < stroke->size; j++) {
+            const uint8_t idx = naginata_key_index(stroke->elements[j]);
+            if (idx == NG_K_NONE) {
+                break;
+            }
+            keys |= 1UL << idx;
+
+            /* 先に押した親指シフトを足したものを優先する（連続シフト） */
+            const struct ng_entry *e = thumbs ? lookup(keys | thumbs) : NULL;
+            if (!e) {
+                e = lookup(keys);
+            }
+            if (e) {
+                hit = e;
+                len = j - i + 1;
+            }
+        }
+        if (!hit) {
+            LOG_DBG("naginata: no entry for key 0x%x", stroke->elements[i]);
+            i++;
+            continue;
+        }
+
+        if (hit->kana) {
+            (void)kana_out_send_paced(hit->kana, gap_ms, timestamp);
+        }
+        if (hit->func) {
+            /* func は kana_out を通さずに送るので、先に並んだかなの後ろで呼ぶ */
+            uint32_t arg = (uint32_t)(hit - ngmap);
+            kana_out_call(run_func, &arg, 1, timestamp);
+        }
+        thumbs |= hit->keys & B_THUMBS;
+        typed = true;
+        i += len;
+    }
+    return typed;
+}
+
+bool naginata_type_from_nglistarray(NGListArray *keys, int64_t timestamp) {
+    bool typed = false;
+
+    for (int i = 0; i < keys->size; i++) {
+        typed |= type_stroke(&keys->elements[i], timestamp);
+    }
+    initializeListArray(keys);
+    return typed;
+}
@@ -8,23 +8,79 @@
 #include <zmk/behavior.h>
 #include <zmk/behavior_queue.h>
 #include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_settings.h>
 
-int64_t timestamp;
-
-#define NG_WINDOWS (uint8_t)0
-#define NG_MACOS (uint8_t)1
-#define NG_LINUX (uint8_t)2
-#define NG_IOS (uint8_t)3
-
-typedef union {
+// union だと os と tategaki が同じ bit を共有してしまう
+typedef struct {
     uint8_t os : 2;
     bool tategaki : true;
 } user_config_t;
 
 user_config_t naginata_config;
 
+// dts/bindings/behaviors/zmk,behavior-naginata.yaml の default と揃える
+static const struct naginata_timing ng_timing_default = {
+    .inter_key_gap_ms = 0,
+    .key_delay_ms = {10, 10, 10, 10},
+    .modifier_delay_ms = {20, 20, 20, 20},
+    .sequence_delay_ms = {50, 50, 50, 50},
+    .launcher_delay_ms = {350, 350, 350, 350},
+};
+
+// 実行時に変えられるようにコピーを持つ（chord ng）。base は devicetree の値
+static const struct naginata_timing *ng_timing_base = &ng_timing_default;
+static struct naginata_timing ng_timing_live = ng_timing_default;
+static const struct naginata_timing *const ng_timing = &ng_timing_live;
+
+void naginata_set_timing(const struct naginata_timing *timing) {
+    ng_timing_base = timing ? timing : &ng_timing_default;
+    ng_timing_live = *ng_timing_base;
+}
+
+void naginata_update_timing(const struct naginata_timing *timing) {
+    ng_timing_live = timing ? *timing : *ng_timing_base;
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+    naginata_settings_changed();
+#endif
+}
+
+const struct naginata_timing *naginata_get_timing(void) { return ng_timing; }
+
+uint8_t naginata_get_os(void) { return naginata_config.os; }
+
+void naginata_set_os(uint8_t os) {
+    if (os >= NG_OS_COUNT || os == naginata_config.os) {
+        return;
+    }
+    naginata_config.os = os;
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+    naginata_settings_changed();
+#endif
+}
+
+bool naginata_get_tategaki(void) { return naginata_config.tategaki; }
+
+void naginata_set_tategaki(bool tategaki) {
+    if (tategaki == naginata_config.tategaki) {
+        return;
+    }
+    naginata_config.tategaki = tategaki;
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+    naginata_settings_changed();
+#endif
+}
+
+static inline void ng_wait(uint16_t ms) {
+    if (ms) {
+        k_msleep(ms);
+    }
+}
+
+// 今の OS の値で待つ（field は struct naginata_timing の *_ms[]）
+#define NG_DELAY(field) ng_wait(ng_timing->field[naginata_config.os])
+
 // 薙刀式をオン
-void naginata_on(void) {
+void naginata_on(int64_t timestamp) {
     raise_zmk_keycode_state_changed_from_encoded(LANG1, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LANG1, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(INT4, true, timestamp);
@@ -39,17 +95,20 @@ void naginata_on(void) {
 //     raise_zmk_keycode_state_changed_from_encoded(INT5, false, timestamp);
 // }
 
-void nofunc() {}
+void nofunc(int64_t timestamp) {}
+
+#if IS_ENABLED(CONFIG_ZMK_NAGINATA_UNICODE_HEX)
 
-void switch_to_hex_input() {
+// Unicode 16 進入力（naginata_zmk_v16.rb が記号の出力に使う）
+void switch_to_hex_input(int64_t timestamp) {
     switch (naginata_config.os) {
         case NG_MACOS:
             raise_zmk_keycode_state_changed_from_encoded(LANG2, true, timestamp);  // 未確定文字を確定する
             raise_zmk_keycode_state_changed_from_encoded(LANG2, false, timestamp);
-            k_sleep(K_MSEC(10));
+            NG_DELAY(key_delay_ms);
             raise_zmk_keycode_state_changed_from_encoded(LC(F20), true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(LC(F20), false, timestamp);
-            k_sleep(K_MSEC(50));
+            NG_DELAY(sequence_delay_ms);
             return;
         case NG_WINDOWS:
             return;
@@ -59,12 +118,12 @@ void switch_to_hex_input() {
     }
 }
 
-void return_to_kana_input() {
+void return_to_kana_input(int64_t timestamp) {
     switch (naginata_config.os) {
         case NG_MACOS:
             raise_zmk_keycode_state_changed_from_encoded(LS(LANG1), true, timestamp);  // 未確定文字を確定する
             raise_zmk_keycode_state_changed_from_encoded(LS(LANG1), false, timestamp);
-            k_sleep(K_MSEC(10));
+            NG_DELAY(key_delay_ms);
             raise_zmk_keycode_state_changed_from_encoded(LANG1, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(LANG1, false, timestamp);
             return;
@@ -74,119 +133,140 @@ void return_to_kana_input() {
     }
 }
 
-void press_compose_key() {
+void press_compose_key(int64_t timestamp) {
     switch (naginata_config.os) {
         case NG_MACOS:
             raise_zmk_keycode_state_changed_from_encoded(LEFT_ALT, true, timestamp);
-            k_sleep(K_MSEC(50));
+            NG_DELAY(sequence_delay_ms);
             return;
         case NG_WINDOWS:
             raise_zmk_keycode_state_changed_from_encoded(RIGHT_ALT, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(RIGHT_ALT, false, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(U, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(U, false, timestamp);
-            k_sleep(K_MSEC(50));
+            NG_DELAY(sequence_delay_ms);
             return;
         case NG_LINUX:
             raise_zmk_keycode_state_changed_from_encoded(LC(LS(U)), true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(LC(LS(U)), false, timestamp);
-            k_sleep(K_MSEC(50));
+            NG_DELAY(sequence_delay_ms);
             return;
         case NG_IOS:
     }
 }
 
-void release_compose_key() {
+void release_compose_key(int64_t timestamp) {
     switch (naginata_config.os) {
         case NG_MACOS:
             raise_zmk_keycode_state_changed_from_encoded(LEFT_ALT, false, timestamp);
-            k_sleep(K_MSEC(50));
+            NG_DELAY(sequence_delay_ms);
             return;
         case NG_WINDOWS:
             raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
-            k_sleep(K_MSEC(50));
+            NG_DELAY(sequence_delay_ms);
             return;
         case NG_LINUX:
             raise_zmk_keycode_state_changed_from_encoded(LC(LS(U)), true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(LC(LS(U)), false, timestamp);
-            k_sleep(K_MSEC(50));
+            NG_DELAY(sequence_delay_ms);
             return;
         case NG_IOS:
     }
 }
 
-void input_unicode_hex(int n1, int n2, int n3, int n4) {
+void input_unicode_hex(int n1, int n2, int n3, int n4, int64_t timestamp) {
     switch (naginata_config.os) {
         case NG_MACOS:
-            switch_to_hex_input();
-            press_compose_key();
+            switch_to_hex_input(timestamp);
+            press_compose_key(timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n1, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n1, false, timestamp);
-            k_sleep(K_MSEC(10));
+            NG_DELAY(key_delay_ms);
             raise_zmk_keycode_state_changed_from_encoded(n2, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n2, false, timestamp);
-            k_sleep(K_MSEC(10));
+            NG_DELAY(key_delay_ms);
             raise_zmk_keycode_state_changed_from_encoded(n3, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n3, false, timestamp);
-            k_sleep(K_MSEC(10));
+            NG_DELAY(key_delay_ms);
             raise_zmk_keycode_state_changed_from_encoded(n4, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n4, false, timestamp);
-            k_sleep(K_MSEC(10));
-            release_compose_key();
-            return_to_kana_input();
+            NG_DELAY(key_delay_ms);
+            release_compose_key(timestamp);
+            return_to_kana_input(timestamp);
             return;
         case NG_WINDOWS:
         case NG_LINUX:
-            press_compose_key();
+            press_compose_key(timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n1, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n1, false, timestamp);
-            k_sleep(K_MSEC(10));
+            NG_DELAY(key_delay_ms);
             raise_zmk_keycode_state_changed_from_encoded(n2, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n2, false, timestamp);
-            k_sleep(K_MSEC(10));
+            NG_DELAY(key_delay_ms);
             raise_zmk_keycode_state_changed_from_encoded(n3, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n3, false, timestamp);
-            k_sleep(K_MSEC(10));
+            NG_DELAY(key_delay_ms);
             raise_zmk_keycode_state_changed_from_encoded(n4, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(n4, false, timestamp);
-            k_sleep(K_MSEC(10));
-            release_compose_key();
+            NG_DELAY(key_delay_ms);
+            release_compose_key(timestamp);
             raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
             raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
-            return_to_kana_input();
+            return_to_kana_input(timestamp);
             return;
     }
 }
 
-void ng_T() { ng_left(1); }
+#endif // CONFIG_ZMK_NAGINATA_UNICODE_HEX
+
+// シフト面（naginata_shift.c）からも使うのでいつも入れる
+void ng_left(uint8_t c, int64_t timestamp) {
+    for (uint8_t i = 0; i < c; i++) {
+        raise_zmk_keycode_state_changed_from_encoded(LEFT, true, timestamp);
+        raise_zmk_keycode_state_changed_from_encoded(LEFT, false, timestamp);
+    }
+}
+
+void ng_right(uint8_t c, int64_t timestamp) {
+    for (uint8_t i = 0; i < c; i++) {
+        raise_zmk_keycode_state_changed_from_encoded(RIGHT, true, timestamp);
+        raise_zmk_keycode_state_changed_from_encoded(RIGHT, false, timestamp);
+    }
+}
+
+void ng_T(int64_t timestamp) { ng_left(1, timestamp); }
 
-void ng_Y() { ng_right(1); }
+void ng_Y(int64_t timestamp) { ng_right(1, timestamp); }
 
-void ng_ST() {
+void ng_ST(int64_t timestamp) {
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    ng_left(1);
+    ng_left(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 }
 
-void ng_SY() {
+void ng_SY(int64_t timestamp) {
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    ng_right(1);
+    ng_right(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 }
-void ngh_JKQ() { // ^{End}
-    //ng_eof();
+
+#if IS_ENABLED(CONFIG_ZMK_NAGINATA_EDIT)
+
+// 編集モード（JK / DF / M, / CV の同時押し）とその下請け
+void ngh_JKQ(int64_t timestamp) { // ^{End}
+    //ng_eof(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(END), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(END), false, timestamp);
 }
 
-void ngh_JKW() { // ／{改行}
-    //input_unicode_hex(F, F, N0, F);
+void ngh_JKW(int64_t timestamp) { // ／{改行}
+    //input_unicode_hex(F, F, N0, F, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(F10, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(F10, false, timestamp);
 }
 
-void ngh_JKE() { // /*ディ*/// ^s
+void ngh_JKE(int64_t timestamp) { // /*ディ*/// ^s
     //raise_zmk_keycode_state_changed_from_encoded(D, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(D, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(H, true, timestamp);
@@ -197,20 +277,20 @@ void ngh_JKE() { // /*ディ*/// ^s
     raise_zmk_keycode_state_changed_from_encoded(LC(S), false, timestamp);
 }
 
-void ngh_JKR() { // ^s
-    //ng_save();
+void ngh_JKR(int64_t timestamp) { // ^s
+    //ng_save(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(HOME, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(HOME, false, timestamp);
 }
 
-void ngh_JKT() { // ・
+void ngh_JKT(int64_t timestamp) { // ・
     raise_zmk_keycode_state_changed_from_encoded(SLASH, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, false, timestamp);
 }
 
-void ngh_JKA() { // ……{改行}
-    //input_unicode_hex(N2, N0, N2, N6);
-    //input_unicode_hex(N2, N0, N2, N6);
+void ngh_JKA(int64_t timestamp) { // ……{改行}
+    //input_unicode_hex(N2, N0, N2, N6, timestamp);
+    //input_unicode_hex(N2, N0, N2, N6, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SLASH, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SLASH, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SLASH, true, timestamp);
@@ -228,20 +308,20 @@ void ngh_JKA() { // ……{改行}
     //k_msleep(50);    
     raise_zmk_keycode_state_changed_from_encoded(BSLH, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(BSLH, false, timestamp);
-    k_msleep(50);    
+    NG_DELAY(sequence_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     //k_msleep(50);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
-    k_msleep(50);
+    NG_DELAY(sequence_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(LEFT, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LEFT, false, timestamp);    
 }
 
-//void ngh_JKS() { // 『{改行}
-//    input_unicode_hex(N3, N0, N0, E);
+//void ngh_JKS(timestamp) { // 『{改行}
+//    input_unicode_hex(N3, N0, N0, E, timestamp);
 //}
 
-void ngh_JKS() { // 『{改行}
+void ngh_JKS(int64_t timestamp) { // 『{改行}
     //raise_zmk_keycode_state_changed_from_encoded(LS(N8), true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LS(N8), false, timestamp);
     
@@ -276,19 +356,19 @@ void ngh_JKS() { // 『{改行}
     //raise_zmk_keycode_state_changed_from_encoded(LEFT, false, timestamp);
     //k_msleep(20);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    k_msleep(20);    
+    NG_DELAY(modifier_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(N8, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(N8, false, timestamp);
-    k_msleep(20);   
+    NG_DELAY(modifier_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(N9, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(N9, false, timestamp);
-    k_msleep(20);
+    NG_DELAY(modifier_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
-    k_msleep(20); 
+    NG_DELAY(modifier_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
-    k_msleep(20); 
+    NG_DELAY(modifier_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
-    k_msleep(20);    
+    NG_DELAY(modifier_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     //k_msleep(50);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
@@ -302,30 +382,30 @@ void ngh_JKS() { // 『{改行}
 
 
 
-void ngh_JKD() { // ？{改行}
+void ngh_JKD(int64_t timestamp) { // ？{改行}
     raise_zmk_keycode_state_changed_from_encoded(LS(SLASH), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LS(SLASH), false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
 }
 
-void ngh_JKF() { // 「{改行} kakuteiEnd
-    //input_unicode_hex(N3, N0, N0, C);
+void ngh_JKF(int64_t timestamp) { // 「{改行} kakuteiEnd
+    //input_unicode_hex(N3, N0, N0, C, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, false, timestamp);
 }
 
-void ngh_JKG() { // ({改行}
-    //input_unicode_hex(F, F, N0, N8);
+void ngh_JKG(int64_t timestamp) { // ({改行}
+    //input_unicode_hex(F, F, N0, N8, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(F8, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(F8, false, timestamp);    
 }
 
-void ngh_JKZ() { // ――{改行}
-    //input_unicode_hex(N2, N0, N1, N5);
-    //input_unicode_hex(N2, N0, N1, N5);
+void ngh_JKZ(int64_t timestamp) { // ――{改行}
+    //input_unicode_hex(N2, N0, N1, N5, timestamp);
+    //input_unicode_hex(N2, N0, N1, N5, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LS(MINUS), true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LS(MINUS), false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LS(N8), true, timestamp);
@@ -336,8 +416,8 @@ void ngh_JKZ() { // ――{改行}
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
 }
 
-void ngh_JKX() { // 』{改行}
-    //input_unicode_hex(N3, N0, N0, F);
+void ngh_JKX(int64_t timestamp) { // 』{改行}
+    //input_unicode_hex(N3, N0, N0, F, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LS(N8), true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LS(N8), false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LS(N9), true, timestamp);
@@ -346,39 +426,39 @@ void ngh_JKX() { // 』{改行}
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
 }
 
-void ngh_JKC() { // ！{改行}
+void ngh_JKC(int64_t timestamp) { // ！{改行}
     raise_zmk_keycode_state_changed_from_encoded(LS(N1), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LS(N1), false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
 }
 
-void ngh_JKV() { // 」{改行} End
-    //input_unicode_hex(N3, N0, N0, D);
+void ngh_JKV(int64_t timestamp) { // 」{改行} End
+    //input_unicode_hex(N3, N0, N0, D, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, false, timestamp);
 }
 
-void ngh_JKB() { // ){改行}
-    //input_unicode_hex(F, F, N0, N9);
+void ngh_JKB(int64_t timestamp) { // ){改行}
+    //input_unicode_hex(F, F, N0, N9, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
 }
 
-void ngh_DFY() { // {Home}
-    //ng_home();
+void ngh_DFY(int64_t timestamp) { // {Home}
+    //ng_home(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(HOME, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(HOME, false, timestamp);
 }
 
-void ngh_DFU() { // +{End}{BS}
+void ngh_DFU(int64_t timestamp) { // +{End}{BS}
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_end();
+    //ng_end(timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(BSPC, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(BSPC, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_end();
+    //ng_end(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
@@ -386,8 +466,8 @@ void ngh_DFU() { // +{End}{BS}
     raise_zmk_keycode_state_changed_from_encoded(BSPC, false, timestamp);
 }
 
-void ngh_DFI() { // {vk1Csc079}
-    //ng_saihenkan();
+void ngh_DFI(int64_t timestamp) { // {vk1Csc079}
+    //ng_saihenkan(timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LEFT_WIN, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SLASH, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SLASH, false, timestamp);
@@ -400,7 +480,7 @@ void ngh_DFI() { // {vk1Csc079}
     //raise_zmk_keycode_state_changed_from_encoded(LEFT_WIN, true, now);
     raise_zmk_keycode_state_changed_from_encoded(LEFT_WIN, true, timestamp);
     // 30〜80ms ほど待つ（環境により最適値は変わる）
-    k_msleep(350);
+    NG_DELAY(launcher_delay_ms);
     // 「/」をタップ（押してすぐ離す）
     //now = k_uptime_get_32();
     //raise_zmk_keycode_state_changed_from_encoded(SLASH, true, now);
@@ -412,18 +492,18 @@ void ngh_DFI() { // {vk1Csc079}
     //raise_zmk_keycode_state_changed_from_encoded(LEFT_WIN, false, now);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, false, timestamp);
-    k_msleep(50);
+    NG_DELAY(sequence_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(LEFT_WIN, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LEFT_WIN, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LEFT_WIN, false, timestamp);
 }
 
-void ngh_DFO() { // {Del}
+void ngh_DFO(int64_t timestamp) { // {Del}
     raise_zmk_keycode_state_changed_from_encoded(DELETE, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DELETE, false, timestamp);
 }
 
-void ngh_DFP() { // +{Esc 2}
+void ngh_DFP(int64_t timestamp) { // +{Esc 2}
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ESC, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ESC, false, timestamp);
@@ -433,28 +513,28 @@ void ngh_DFP() { // +{Esc 2}
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);//20251008
 }
 
-void ngh_DFH() { // {Enter}{End}
+void ngh_DFH(int64_t timestamp) { // {Enter}{End}
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, false, timestamp);
-    //ng_end();
+    //ng_end(timestamp);
 }
 
-void ngh_DFJ() { // {↑} LEFT
-    //ng_up(1);
+void ngh_DFJ(int64_t timestamp) { // {↑} LEFT
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LEFT, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LEFT, false, timestamp);
 }
 
-void ngh_DFK() { // +{↑} +LEFT
+void ngh_DFK(int64_t timestamp) { // +{↑} +LEFT
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 
     
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LEFT, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LEFT, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
@@ -464,20 +544,20 @@ void ngh_DFK() { // +{↑} +LEFT
     //raise_zmk_keycode_state_changed_from_encoded(LS(LEFT), false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LEFT, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LEFT, false, timestamp);
-    k_msleep(50);
+    NG_DELAY(sequence_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 }
 
-void ngh_DFL() { // +{↑ 7} +LEFT7
+void ngh_DFL(int64_t timestamp) { // +{↑ 7} +LEFT7
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(7);
+    //ng_up(7, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     
     
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LEFT, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LEFT, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LEFT, true, timestamp);
@@ -526,30 +606,30 @@ void ngh_DFL() { // +{↑ 7} +LEFT7
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 }
 
-void ngh_DFSCLN() { // ^i
-    ng_katakana();
+void ngh_DFSCLN(int64_t timestamp) { // ^i
+    ng_katakana(timestamp);
 }
 
-void ngh_DFN() { // {End}
-    //ng_end();
+void ngh_DFN(int64_t timestamp) { // {End}
+    //ng_end(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, false, timestamp);
 }
 
-void ngh_DFM() { // {↓} RIGHT
-    //ng_down(1);
+void ngh_DFM(int64_t timestamp) { // {↓} RIGHT
+    //ng_down(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(RIGHT, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(RIGHT, false, timestamp);
 }
 
-void ngh_DFCOMM() { // +{↓}  +RIGHT
+void ngh_DFCOMM(int64_t timestamp) { // +{↓}  +RIGHT
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_down(1);
+    //ng_down(1, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 
     
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(RIGHT, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(RIGHT, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
@@ -562,21 +642,21 @@ void ngh_DFCOMM() { // +{↓}  +RIGHT
 
     raise_zmk_keycode_state_changed_from_encoded(RIGHT, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(RIGHT, false, timestamp);
-    k_msleep(50);
+    NG_DELAY(sequence_delay_ms);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     
 }
 
-void ngh_DFDOT() { // +{↓ 7} +RIGHT7
+void ngh_DFDOT(int64_t timestamp) { // +{↓ 7} +RIGHT7
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_down(7);
+    //ng_down(7, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 
     
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(RIGHT, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(RIGHT, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(RIGHT, true, timestamp);
@@ -612,26 +692,26 @@ void ngh_DFDOT() { // +{↓ 7} +RIGHT7
     
 }
 
-void ngh_DFSLSH() { // ^u
-    //ng_hiragana();
+void ngh_DFSLSH(int64_t timestamp) { // ^u
+    //ng_hiragana(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(U), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(U), false, timestamp);
 }
 
-void ngh_MCQ() { // ｜{改行}
-    //input_unicode_hex(F, F, N5, C);
+void ngh_MCQ(int64_t timestamp) { // ｜{改行}
+    //input_unicode_hex(F, F, N5, C, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
 }
 
-void ngh_MCW() { // 　　　×　　　×　　　×{改行 2}
+void ngh_MCW(int64_t timestamp) { // 　　　×　　　×　　　×{改行 2}
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
-    //input_unicode_hex(N0, N0, D, N7);
+    //input_unicode_hex(N0, N0, D, N7, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
@@ -640,7 +720,7 @@ void ngh_MCW() { // 　　　×　　　×　　　×{改行 2}
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
-    //input_unicode_hex(N0, N0, D, N7);
+    //input_unicode_hex(N0, N0, D, N7, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
@@ -649,59 +729,59 @@ void ngh_MCW() { // 　　　×　　　×　　　×{改行 2}
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
-    //input_unicode_hex(N0, N0, D, N7);
+    //input_unicode_hex(N0, N0, D, N7, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
 }
 
-void ngh_MCE() { // {Home}{→}{End}{Del 2}{←}
-    //ng_home();
-    //ng_prev_row();
-    //ng_end();
+void ngh_MCE(int64_t timestamp) { // {Home}{→}{End}{Del 2}{←}
+    //ng_home(timestamp);
+    //ng_prev_row(timestamp);
+    //ng_end(timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, false, timestamp);
-    //ng_next_row();
+    //ng_next_row(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
 }
 
-void ngh_MCR() { // {Home}{改行}{Space 1}{←}
-    //ng_home();
+void ngh_MCR(int64_t timestamp) { // {Home}{改行}{Space 1}{←}
+    //ng_home(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(HOME, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(HOME, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
-    //ng_next_row();
+    //ng_next_row(timestamp);
 }
 
-void ngh_MCT() { // 〇{改行}
-    //input_unicode_hex(N3, N0, N0, N7);
+void ngh_MCT(int64_t timestamp) { // 〇{改行}
+    //input_unicode_hex(N3, N0, N0, N7, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
 }
 
-void ngh_MCA() { // 《{改行}
-    //input_unicode_hex(N3, N0, N0, A);
+void ngh_MCA(int64_t timestamp) { // 《{改行}
+    //input_unicode_hex(N3, N0, N0, A, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
 }
 
-void ngh_MCS() { // 【{改行}
-    //input_unicode_hex(N3, N0, N1, N0);
+void ngh_MCS(int64_t timestamp) { // 【{改行}
+    //input_unicode_hex(N3, N0, N1, N0, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
 }
 
-void ngh_MCD() { // {Home}{→}{End}{Del 4}{←}
-    //ng_home();
-    //ng_prev_row();
-    //ng_end();
+void ngh_MCD(int64_t timestamp) { // {Home}{→}{End}{Del 4}{←}
+    //ng_home(timestamp);
+    //ng_prev_row(timestamp);
+    //ng_end(timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, true, timestamp);
@@ -710,13 +790,13 @@ void ngh_MCD() { // {Home}{→}{End}{Del 4}{←}
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(DELETE, false, timestamp);
-    //ng_next_row();
+    //ng_next_row(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
 }
 
-void ngh_MCF() { // {Home}{改行}{Space 3}{←}
-    //ng_home();
+void ngh_MCF(int64_t timestamp) { // {Home}{改行}{Space 3}{←}
+    //ng_home(timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
@@ -725,12 +805,12 @@ void ngh_MCF() { // {Home}{改行}{Space 3}{←}
     //raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
-    //ng_next_row();
+    //ng_next_row(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(F), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(F), false, timestamp);
 }
 
-void ngh_MCG() { // {Space 3}
+void ngh_MCG(int64_t timestamp) { // {Space 3}
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
@@ -739,39 +819,39 @@ void ngh_MCG() { // {Space 3}
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
 }
 
-void ngh_MCZ() { // 》{改行}
-    //input_unicode_hex(N3, N0, N0, B);
+void ngh_MCZ(int64_t timestamp) { // 》{改行}
+    //input_unicode_hex(N3, N0, N0, B, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
 }
 
-void ngh_MCX() { // 】{改行}
-    //input_unicode_hex(N3, N0, N1, N1);
+void ngh_MCX(int64_t timestamp) { // 】{改行}
+    //input_unicode_hex(N3, N0, N1, N1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
 }
 
-void ngh_MCC() { // 」{改行}{改行}
-    //input_unicode_hex(N3, N0, N0, D);
+void ngh_MCC(int64_t timestamp) { // 」{改行}{改行}
+    //input_unicode_hex(N3, N0, N0, D, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
 }
 
-void ngh_MCV() { // 」{改行}{改行}「{改行}
-    //input_unicode_hex(N3, N0, N0, D);
+void ngh_MCV(int64_t timestamp) { // 」{改行}{改行}「{改行}
+    //input_unicode_hex(N3, N0, N0, D, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(SLASH, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
-    //input_unicode_hex(N3, N0, N0, C);
+    //input_unicode_hex(N3, N0, N0, C, timestamp);
 }
 
-void ngh_MCB() { // 」{改行}{改行}{Space}
-    //input_unicode_hex(N3, N0, N0, D);
+void ngh_MCB(int64_t timestamp) { // 」{改行}{改行}{Space}
+    //input_unicode_hex(N3, N0, N0, D, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(MINUS, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
@@ -780,77 +860,77 @@ void ngh_MCB() { // 」{改行}{改行}{Space}
     raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
 }
 
-void ngh_CVY() { // +{Home}
+void ngh_CVY(int64_t timestamp) { // +{Home}
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_home();
+    //ng_home(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(HOME, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(HOME, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 }
 
-void ngh_CVU() { // ^x
-    //ng_cut();
+void ngh_CVU(int64_t timestamp) { // ^x
+    //ng_cut(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(X), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(X), false, timestamp);
 }
 
-void ngh_CVI() { // {vk1Csc079} V15 paste ^v
-    //ng_saihenkan();
+void ngh_CVI(int64_t timestamp) { // {vk1Csc079} V15 paste ^v
+    //ng_saihenkan(timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LG(SLASH), true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LG(SLASH), false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(V), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(V), false, timestamp);    
 }
 
-void ngh_CVO() { // ^v redo
-    //ng_paste();
+void ngh_CVO(int64_t timestamp) { // ^v redo
+    //ng_paste(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(Y), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(Y), false, timestamp);    
 }
 
-void ngh_CVP() { // ^z undo
-    //ng_undo();
+void ngh_CVP(int64_t timestamp) { // ^z undo
+    //ng_undo(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(Z), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(Z), false, timestamp);
 }
 
-void ngh_CVH() { // ^c
-    //ng_copy();
+void ngh_CVH(int64_t timestamp) { // ^c
+    //ng_copy(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(C), true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LC(C), false, timestamp);
 }
 
-void ngh_CVJ() { // {←}
-    //ng_left(1);
+void ngh_CVJ(int64_t timestamp) { // {←}
+    //ng_left(1, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 }
 
-void ngh_CVK() { // {→}
-    //ng_right(1);
+void ngh_CVK(int64_t timestamp) { // {→}
+    //ng_right(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 }
 
-void ngh_CVL() { // {改行}{Space}+{Home}^x{BS} UP5
+void ngh_CVL(int64_t timestamp) { // {改行}{Space}+{Home}^x{BS} UP5
     //raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SPACE, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(SPACE, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_home();
+    //ng_home(timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
-    //ng_cut();
+    //ng_cut(timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(BSPC, true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(BSPC, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, true, timestamp);
@@ -864,10 +944,10 @@ void ngh_CVL() { // {改行}{Space}+{Home}^x{BS} UP5
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);    
 }
 
-void ngh_CVSCLN() { // ^y shift up5
-    //ng_redo();
+void ngh_CVSCLN(int64_t timestamp) { // ^y shift up5
+    //ng_redo(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(UP, true, timestamp);
@@ -881,42 +961,42 @@ void ngh_CVSCLN() { // ^y shift up5
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);    
 }
 
-void ngh_CVN() { // +{End}
+void ngh_CVN(int64_t timestamp) { // +{End}
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_end();
+    //ng_end(timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(END, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
 }
 
-void ngh_CVM() { // +{←} down
+void ngh_CVM(int64_t timestamp) { // +{←} down
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_left(1);
+    //ng_left(1, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);   
 }
 
-void ngh_CVCOMM() { // +{→} shift down
+void ngh_CVCOMM(int64_t timestamp) { // +{→} shift down
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_right(1);
+    //ng_right(1, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp); 
 }
 
-void ngh_CVDOT() { // +{← 7} down5
+void ngh_CVDOT(int64_t timestamp) { // +{← 7} down5
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_left(7);
+    //ng_left(7, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, true, timestamp);
@@ -930,12 +1010,12 @@ void ngh_CVDOT() { // +{← 7} down5
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp); 
 }
 
-void ngh_CVSLSH() { // +{→ 7} shift down5
+void ngh_CVSLSH(int64_t timestamp) { // +{→ 7} shift down5
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_right(7);
+    //ng_right(7, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, true, timestamp);
-    //ng_up(1);
+    //ng_up(1, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, true, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, false, timestamp);
     raise_zmk_keycode_state_changed_from_encoded(DOWN, true, timestamp);
@@ -949,7 +1029,7 @@ void ngh_CVSLSH() { // +{→ 7} shift down5
     raise_zmk_keycode_state_changed_from_encoded(LSHIFT, false, timestamp); 
 }
 
-void ng_cut() {
+void ng_cut(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -963,7 +1043,7 @@ void ng_cut() {
     }
 }
 
-void ng_copy() {
+void ng_copy(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -977,7 +1057,7 @@ void ng_copy() {
     }
 }
 
-void ng_paste() {
+void ng_paste(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -991,42 +1071,28 @@ void ng_paste() {
     }
 }
 
-void ng_up(uint8_t c) {
+void ng_up(uint8_t c, int64_t timestamp) {
     for (uint8_t i = 0; i < c; i++) {
         raise_zmk_keycode_state_changed_from_encoded(UP, true, timestamp);
         raise_zmk_keycode_state_changed_from_encoded(UP, false, timestamp);
     }
 }
 
-void ng_down(uint8_t c) {
+void ng_down(uint8_t c, int64_t timestamp) {
     for (uint8_t i = 0; i < c; i++) {
         raise_zmk_keycode_state_changed_from_encoded(DOWN, true, timestamp);
         raise_zmk_keycode_state_changed_from_encoded(DOWN, false, timestamp);
     }
 }
 
-void ng_left(uint8_t c) {
-    for (uint8_t i = 0; i < c; i++) {
-        raise_zmk_keycode_state_changed_from_encoded(LEFT, true, timestamp);
-        raise_zmk_keycode_state_changed_from_encoded(LEFT, false, timestamp);
-    }
-}
-
-void ng_right(uint8_t c) {
-    for (uint8_t i = 0; i < c; i++) {
-        raise_zmk_keycode_state_changed_from_encoded(RIGHT, true, timestamp);
-        raise_zmk_keycode_state_changed_from_encoded(RIGHT, false, timestamp);
-    }
-}
-
-void ng_next_row() {
+void ng_next_row(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
         if (naginata_config.tategaki) {
-            ng_left(1);
+            ng_left(1, timestamp);
         } else{
-            ng_down(1);
+            ng_down(1, timestamp);
         }
         break;
     case NG_MACOS:
@@ -1036,14 +1102,14 @@ void ng_next_row() {
     }
 }
 
-void ng_prev_row() {
+void ng_prev_row(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
         if (naginata_config.tategaki) {
-            ng_right(1);
+            ng_right(1, timestamp);
         } else {
-            ng_up(1);
+            ng_up(1, timestamp);
         }
         break;
     case NG_MACOS:
@@ -1053,14 +1119,14 @@ void ng_prev_row() {
     }
 }
 
-void ng_next_char() {
+void ng_next_char(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
         if (naginata_config.tategaki) {
-            ng_down(1);
+            ng_down(1, timestamp);
         } else {
-            ng_right(1);
+            ng_right(1, timestamp);
         }
         break;
     case NG_MACOS:
@@ -1070,14 +1136,14 @@ void ng_next_char() {
     }
 }
 
-void ng_prev_char() {
+void ng_prev_char(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
         if (naginata_config.tategaki) {
-            ng_up(1);
+            ng_up(1, timestamp);
         } else {
-            ng_left(1);
+            ng_left(1, timestamp);
         }
         break;
     case NG_MACOS:
@@ -1087,7 +1153,7 @@ void ng_prev_char() {
     }
 }
 
-void ng_home() {
+void ng_home(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -1101,7 +1167,7 @@ void ng_home() {
     }
 }
 
-void ng_end() {
+void ng_end(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -1115,7 +1181,7 @@ void ng_end() {
     }
 }
 
-void ng_katakana() {
+void ng_katakana(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -1129,7 +1195,7 @@ void ng_katakana() {
     }
 }
 
-void ng_save() {
+void ng_save(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -1143,7 +1209,7 @@ void ng_save() {
     }
 }
 
-void ng_hiragana() {
+void ng_hiragana(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -1157,7 +1223,7 @@ void ng_hiragana() {
     }
 }
 
-void ng_redo() {
+void ng_redo(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -1171,7 +1237,7 @@ void ng_redo() {
     }
 }
 
-void ng_undo() {
+void ng_undo(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -1185,7 +1251,7 @@ void ng_undo() {
     }
 }
 
-void ng_saihenkan() {
+void ng_saihenkan(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -1201,7 +1267,7 @@ void ng_saihenkan() {
     }
 }
 
-void ng_eof() {
+void ng_eof(int64_t timestamp) {
     switch (naginata_config.os) {
     case NG_WINDOWS:
     case NG_LINUX:
@@ -1214,3 +1280,5 @@ void ng_eof() {
         break;
     }
 }
+
+#endif // CONFIG_ZMK_NAGINATA_EDIT
@@ -0,0 +1,44 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <dt-bindings/zmk/keys.h>
+
+#include <zmk_naginata/naginata_keys.h>
+
+uint8_t naginata_key_index(uint32_t keycode) {
+    switch (keycode) {
+    case Q: return NG_K_Q;
+    case W: return NG_K_W;
+    case E: return NG_K_E;
+    case R: return NG_K_R;
+    case T: return NG_K_T;
+    case Y: return NG_K_Y;
+    case U: return NG_K_U;
+    case I: return NG_K_I;
+    case O: return NG_K_O;
+    case P: return NG_K_P;
+    case A: return NG_K_A;
+    case S: return NG_K_S;
+    case D: return NG_K_D;
+    case F: return NG_K_F;
+    case G: return NG_K_G;
+    case H: return NG_K_H;
+    case J: return NG_K_J;
+    case K: return NG_K_K;
+    case L: return NG_K_L;
+    case SEMI: return NG_K_SEMI;
+    case Z: return NG_K_Z;
+    case X: return NG_K_X;
+    case C: return NG_K_C;
+    case V: return NG_K_V;
+    case B: return NG_K_B;
+    case N: return NG_K_N;
+    case M: return NG_K_M;
+    case COMMA: return NG_K_COMMA;
+    case DOT: return NG_K_DOT;
+    case SLASH: return NG_K_SLASH;
+    case SPACE: return NG_K_SPACE;
+    case SQT: return NG_K_SQT;
+    default: return NG_K_NONE;
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+
+#include <chord/chord_persist.h>
+#include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_settings.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define NG_SUBTREE "chord/ng"
+
+/* settings にはこの形で書く。出力の間隔は chord/tune/naginata の方なので 0 */
+struct ng_saved {
+    uint8_t os;
+    uint8_t tategaki;
+    struct naginata_timing timing;
+};
+
+static struct ng_saved stored;
+static struct chord_persist_item item = CHORD_PERSIST_ITEM_INIT(NG_SUBTREE, stored);
+
+/* settings から戻している間は書き戻さない */
+static bool loading;
+
+static void snapshot(struct ng_saved *out) {
+    out->os = naginata_get_os();
+    out->tategaki = naginata_get_tategaki();
+    out->timing = *naginata_get_timing();
+    out->timing.inter_key_gap_ms = 0;
+}
+
+void naginata_settings_changed(void) {
+    struct ng_saved now;
+
+    if (loading) {
+        return;
+    }
+    snapshot(&now);
+    chord_persist_set(&item, &now);
+}
+
+int naginata_settings_flush(void) { return chord_persist_flush(); }
+
+static int ng_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg) {
+    struct ng_saved in;
+
+    if (name[0] != '\0') {
+        return -ENOENT;
+    }
+    if (len != sizeof(in)) {
+        /* 形が変わった: devicetree の値のまま */
+        return 0;
+    }
+
+    ssize_t rc = read_cb(cb_arg, &in, sizeof(in));
+    if (rc < 0) {
+        return (int)rc;
+    }
+
+    loading = true;
+    in.timing.inter_key_gap_ms = naginata_get_timing()->inter_key_gap_ms;
+    naginata_set_os(in.os);
+    naginata_set_tategaki(in.tategaki);
+    naginata_update_timing(&in.timing);
+    loading = false;
+
+    snapshot(&in);
+    chord_persist_loaded(&item, &in);
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(naginata_settings, NG_SUBTREE, NULL, ng_settings_set, NULL, NULL);
+
+int naginata_settings_load(void) {
+    int err = settings_subsys_init();
+    if (err) {
+        LOG_WRN("naginata: settings init failed (%d)", err);
+        return err;
+    }
+    return settings_load_subtree(NG_SUBTREE);
+}
@@ -0,0 +1,148 @@
+/*
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/keycode_state_changed.h>
+#include <dt-bindings/zmk/keys.h>
+
+#include <chord/kana_out.h>
+#include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_keys.h>
+#include <zmk_naginata/naginata_shift.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+BUILD_ASSERT(NG_KEY_COUNT <= 32, "key sets (B_*) are uint32_t masks");
+
+struct plane_entry {
+    const char *kana;                /* かな（UTF-8） */
+    void (*func)(int64_t timestamp); /* kana の後に呼ぶ（NULL 可） */
+};
+
+/*
+ * 親指先行シフト面（README）: ng SPACE を先に押し下げている間のキー。
+ * 小書きのぁぃぅぇぉゃゅょゎヶヵ、押しにくい ー げ うぉ は元のかなのキーに、
+ * 外来音（同時押しでは 3 キー）は空いているキーに 1 打で置く。
+ * ここに無いキーは {SPACE, キー} の同時押しとして通常の判定へ回す。
+ * ng SQT は先行シフトではなく同時押し面（通常の判定で引く）。
+ */
+static const struct plane_entry plane[NG_KEY_COUNT] = {
+    [NG_K_J] = {"ぁ"}, [NG_K_K] = {"ぃ"}, [NG_K_L] = {"ぅ"},
+    [NG_K_O] = {"ぇ"}, [NG_K_N] = {"ぉ"},
+    [NG_K_H] = {"ゃ"}, [NG_K_P] = {"ゅ"}, [NG_K_I] = {"ょ"},
+    [NG_K_DOT] = {"ゎ"}, [NG_K_S] = {"ヶ"}, [NG_K_F] = {"ヵ"},
+    [NG_K_SEMI] = {"ー"}, [NG_K_D] = {"げ"}, [NG_K_U] = {"うぉ"},
+    /* 外来音 */
+    [NG_K_Q] = {"ゔ"}, [NG_K_W] = {"うぃ"}, [NG_K_E] = {"てぃ"},
+    [NG_K_R] = {"しぇ"}, [NG_K_T] = {"ちぇ"}, [NG_K_Y] = {"でゅ"},
+    [NG_K_A] = {"うぇ"}, [NG_K_G] = {"じぇ"}, [NG_K_C] = {"でぃ"},
+    [NG_K_Z] = {"ふぁ"}, [NG_K_X] = {"ふぃ"}, [NG_K_V] = {"ふぇ"},
+    [NG_K_B] = {"ふぉ"}, [NG_K_M] = {"とぅ"},
+};
+
+static struct {
+    uint32_t held;      /* 押下中のシフトキー（B_SHIFTS） */
+    uint32_t used;      /* held のうち、押している間に何か打ったもの */
+    uint32_t consumed;  /* シフト中に押して確定済みのキー（離上は無視） */
+    uint32_t shift_keycode;
+    naginata_shift_fallback_cb fallback;
+    struct naginata_shift_stats stats;
+} sh;
+
+void naginata_shift_init(naginata_shift_fallback_cb fallback) {
+    memset(&sh, 0, sizeof(sh));
+    sh.fallback = fallback;
+}
+
+bool naginata_shift_active(void) { return sh.held != 0; }
+
+/* kana_out_call() から、並んだ順番で plane[args[0]].func を呼ぶ */
+static void run_func(const uint32_t *args, uint8_t count, int64_t ts) {
+    ARG_UNUSED(count);
+    plane[args[0]].func(ts);
+}
+
+bool naginata_shift_press(uint32_t keycode, bool chord_pending, int64_t ts) {
+    uint8_t idx = naginata_key_index(keycode);
+    if (idx == NG_K_NONE) {
+        return false;
+    }
+    uint32_t bit = 1UL << idx;
+
+    if (bit & B_SHIFTS) {
+        if (chord_pending && !sh.held) {
+            /* 文字キーが先: 先行シフトではなく同時押しの一部 */
+            return false;
+        }
+        sh.held |= bit;
+        sh.used &= ~bit;
+        sh.shift_keycode = keycode;
+        return true;
+    }
+
+    if (!sh.held) {
+        return false;
+    }
+
+    sh.consumed |= bit;
+    sh.used |= sh.held;
+
+    const struct plane_entry *e = &plane[idx];
+    if (e->kana || e->func) {
+        if (e->kana) {
+            (void)kana_out_send_paced(e->kana, naginata_get_timing()->inter_key_gap_ms, ts);
+        }
+        if (e->func) {
+            /* func は kana_out を通さずに送るので、先に並んだかなの後ろで呼ぶ */
+            uint32_t arg = idx;
+            kana_out_call(run_func, &arg, 1, ts);
+        }
+        sh.stats.resolved++;
+        return true;
+    }
+
+    if (sh.fallback) {
+        uint32_t keys[2] = {sh.shift_keycode, keycode};
+        kana_out_call(sh.fallback, keys, 2, ts);
+    }
+    sh.stats.fallback++;
+    return true;
+}
+
+bool naginata_shift_release(uint32_t keycode, int64_t ts) {
+    uint8_t idx = naginata_key_index(keycode);
+    if (idx == NG_K_NONE) {
+        return false;
+    }
+    uint32_t bit = 1UL << idx;
+
+    if (sh.consumed & bit) {
+        sh.consumed &= ~bit;
+        return true;
+    }
+    if (!(sh.held & bit)) {
+        return false;
+    }
+
+    sh.held &= ~bit;
+    if (!(sh.used & bit)) {
+        /* 何も打たずに離した: シフトキー単打として通常判定へ */
+        if (sh.fallback) {
+            kana_out_call(sh.fallback, &keycode, 1, ts);
+        }
+        sh.stats.bare++;
+    }
+    sh.used &= ~bit;
+    return true;
+}
+
+void naginata_shift_get_stats(struct naginata_shift_stats *out) {
+    if (out) {
+        *out = sh.stats;
+    }
+}
@@ -0,0 +1,181 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Naginata の出力先 OS、縦書き、OS ごとの待ち時間を実行時に変える（CONFIG_ZMK_CHORD_TUNE）。
+ * 変えた値は CONFIG_ZMK_CHORD_PERSIST なら少し遅れて settings（chord/ng）に残る。
+ * 同時押し窓などは chord tune（chord_tune.c）の "naginata"。
+ */
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_settings.h>
+
+static const char *const os_names[NG_OS_COUNT] = {
+    [NG_WINDOWS] = "windows",
+    [NG_MACOS] = "macos",
+    [NG_LINUX] = "linux",
+    [NG_IOS] = "ios",
+};
+
+#if IS_ENABLED(CONFIG_ZMK_CHORD_PERSIST)
+
+/* 変更は naginata_func が naginata_settings に知らせるので、ここでは今すぐ書くだけ */
+static int tune_save(void) { return naginata_settings_flush(); }
+
+#else
+
+static int tune_save(void) { return -ENOTSUP; }
+
+#endif
+
+/* ---- shell: chord ng [os|tategaki|delay|save|reset] ----------------------- */
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+struct delay_field {
+    const char *name;
+    size_t offset; /* struct naginata_timing 内の uint16_t[NG_OS_COUNT] */
+};
+
+static const struct delay_field delay_fields[] = {
+    {"key", offsetof(struct naginata_timing, key_delay_ms)},
+    {"modifier", offsetof(struct naginata_timing, modifier_delay_ms)},
+    {"sequence", offsetof(struct naginata_timing, sequence_delay_ms)},
+    {"launcher", offsetof(struct naginata_timing, launcher_delay_ms)},
+};
+
+static inline uint16_t *field_of(struct naginata_timing *t, const struct delay_field *f) {
+    return (uint16_t *)((uint8_t *)t + f->offset);
+}
+
+static int os_index(const char *name) {
+    for (int i = 0; i < NG_OS_COUNT; i++) {
+        if (strcmp(name, os_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int cmd_ng(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    struct naginata_timing t = *naginata_get_timing();
+
+    shell_print(sh, "os        %s", os_names[naginata_get_os()]);
+    shell_print(sh, "tategaki  %s", naginata_get_tategaki() ? "on" : "off");
+    shell_print(sh, "%-9s %8s %8s %8s %8s", "delay ms", os_names[0], os_names[1], os_names[2],
+                os_names[3]);
+    for (size_t i = 0; i < ARRAY_SIZE(delay_fields); i++) {
+        const uint16_t *v = field_of(&t, &delay_fields[i]);
+        shell_print(sh, "%-9s %8u %8u %8u %8u", delay_fields[i].name, v[0], v[1], v[2], v[3]);
+    }
+    return 0;
+}
+
+static int cmd_os(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+
+    int os = os_index(argv[1]);
+    if (os < 0) {
+        shell_error(sh, "os is windows, macos, linux or ios");
+        return -EINVAL;
+    }
+    naginata_set_os((uint8_t)os);
+    return cmd_ng(sh, 1, argv);
+}
+
+static int cmd_tategaki(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+
+    if (strcmp(argv[1], "on") != 0 && strcmp(argv[1], "off") != 0) {
+        shell_error(sh, "tategaki on|off");
+        return -EINVAL;
+    }
+    naginata_set_tategaki(strcmp(argv[1], "on") == 0);
+    return cmd_ng(sh, 1, argv);
+}
+
+/* delay <kind> <ms> [os]（os を省くと今の OS） */
+static int cmd_delay(const struct shell *sh, size_t argc, char **argv) {
+    struct naginata_timing t = *naginata_get_timing();
+    const struct delay_field *f = NULL;
+    int os = naginata_get_os();
+    char *end;
+
+    for (size_t i = 0; i < ARRAY_SIZE(delay_fields); i++) {
+        if (strcmp(argv[1], delay_fields[i].name) == 0) {
+            f = &delay_fields[i];
+        }
+    }
+    if (!f) {
+        shell_error(sh, "kind is key, modifier, sequence or launcher");
+        return -EINVAL;
+    }
+
+    unsigned long ms = strtoul(argv[2], &end, 10);
+    if (end == argv[2] || *end != '\0' || ms > 2000) {
+        shell_error(sh, "bad value '%s' (0..2000 ms)", argv[2]);
+        return -EINVAL;
+    }
+    if (argc > 3 && (os = os_index(argv[3])) < 0) {
+        shell_error(sh, "os is windows, macos, linux or ios");
+        return -EINVAL;
+    }
+
+    field_of(&t, f)[os] = (uint16_t)ms;
+    naginata_update_timing(&t);
+    return cmd_ng(sh, 1, argv);
+}
+
+static int cmd_save(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    int err = tune_save();
+    if (err) {
+        shell_error(sh, "save failed (%d)", err);
+        return err;
+    }
+    shell_print(sh, "saved");
+    return 0;
+}
+
+/* 待ち時間を devicetree の値に戻す（OS と chord tune の gap はそのまま）。settings へは後で */
+static int cmd_reset(const struct shell *sh, size_t argc, char **argv) {
+    const uint16_t gap_ms = naginata_get_timing()->inter_key_gap_ms;
+    struct naginata_timing t;
+
+    naginata_update_timing(NULL);
+    t = *naginata_get_timing();
+    t.inter_key_gap_ms = gap_ms;
+    naginata_update_timing(&t);
+    return cmd_ng(sh, argc, argv);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(ng_cmds,
+                               SHELL_CMD_ARG(os, NULL, "os windows|macos|linux|ios", cmd_os, 2,
+                                             0),
+                               SHELL_CMD_ARG(tategaki, NULL, "tategaki on|off", cmd_tategaki, 2,
+                                             0),
+                               SHELL_CMD_ARG(delay, NULL,
+                                             "delay key|modifier|sequence|launcher <ms> [os]",
+                                             cmd_delay, 3, 1),
+                               SHELL_CMD_ARG(save, NULL, "write os and delays to settings now",
+                                             cmd_save, 1, 0),
+                               SHELL_CMD_ARG(reset, NULL, "delays back to devicetree values",
+                                             cmd_reset, 1, 0),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((chord), ng, &ng_cmds, "Naginata target OS, tategaki and per-OS delays", cmd_ng,
+                 1, 0);
+
+#endif
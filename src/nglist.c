@@ -1,11 +1,13 @@
 #include <zmk_naginata/nglist.h>
 
+BUILD_ASSERT(NG_LIST_SIZE >= 2, "compareList01 reads two elements");
+
 // 集合を初期化する関数
 void initializeList(NGList *list) { list->size = 0; }
 
 // 要素を集合に追加する関数
 bool addToList(NGList *list, uint32_t element) {
-    if (list->size >= LIST_SIZE) {
+    if (list->size >= NG_LIST_SIZE) {
         return false;
     }
 
@@ -15,11 +17,11 @@ bool addToList(NGList *list, uint32_t element) {
 }
 
 bool addToListAt(NGList *list, uint32_t element, int idx) {
-    if (list->size >= LIST_SIZE) {
+    if (list->size >= NG_LIST_SIZE) {
         return false;
     }
-    for (int i = idx; i < list->size; i++) {
-        list->elements[i + i] = list->elements[i];
+    for (int i = list->size; i > idx; i--) {
+        list->elements[i] = list->elements[i - 1];
     }
     // 集合に要素を追加
     list->elements[idx] = element;
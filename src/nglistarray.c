@@ -5,7 +5,7 @@ void initializeListArray(NGListArray *list) { list->size = 0; }
 
 // 要素を集合に追加する関数
 bool addToListArray(NGListArray *list, NGList *element) {
-    if (list->size >= LIST_SIZE) {
+    if (list->size >= NG_LIST_ARRAY_SIZE) {
         return false;
     }
 
@@ -15,11 +15,11 @@ bool addToListArray(NGListArray *list, NGList *element) {
 }
 
 bool addToListArrayAt(NGListArray *list, NGList *element, int idx) {
-    if (list->size >= LIST_SIZE) {
+    if (list->size >= NG_LIST_ARRAY_SIZE) {
         return false;
     }
-    for (int i = idx; i < list->size; i++) {
-        list->elements[i + i] = list->elements[i];
+    for (int i = list->size; i > idx; i--) {
+        list->elements[i] = list->elements[i - 1];
     }
     // 集合に要素を追加
     list->elements[idx] = *element;